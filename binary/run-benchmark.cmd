@@ -16,6 +16,7 @@ cd benchmark
 26-bench-rect-drawing --dont-output-csv-headers >> bench-approaches.csv 2>> bench-frames.csv
 26-bench-rect-drawing --dont-output-csv-headers >> bench-approaches.csv 2>> bench-frames.csv
 26-bench-rect-drawing --dont-output-csv-headers >> bench-approaches.csv 2>> bench-frames.csv
+26-bench-rect-drawing --warmup-frames=10 --stats-csv=bench-stats.csv  >  bench-warm-approaches.csv 2>  bench-warm-frames.csv
 26-bench-rect-drawing --disable-timer-queries                           >  bench-untimed-approaches.csv 2>  bench-untimed-frames.csv
 26-bench-rect-drawing --disable-timer-queries --dont-output-csv-headers >> bench-untimed-approaches.csv 2>> bench-untimed-frames.csv
 26-bench-rect-drawing --disable-timer-queries --dont-output-csv-headers >> bench-untimed-approaches.csv 2>> bench-untimed-frames.csv
@@ -0,0 +1,129 @@
+#!/usr/bin/ruby
+# Compares two benchmark result directories (e.g. results-lin-steven/ before and after a change) and reports which
+# approaches got slower or faster.
+#
+# Rows are matched by scenario and approach. The per-frame samples in bench-frames.csv of both directories are compared
+# with a Mann-Whitney U test (no assumptions about the distribution, frame times usually have a long tail). When a
+# directory has no bench-frames.csv the per-run sums from bench-approaches.csv are used as samples instead (one sample
+# per benchmark run, so only useful with several runs).
+#
+# A row counts as regression when the median got worse by more than the threshold and the difference is significant.
+# The exit code is 1 if there is at least one regression, so this can be used to fail a CI job.
+#
+# Usage: ruby compare-results.rb [--metric=frame_wt] [--threshold=5] [--alpha=0.05] base-dir new-dir
+
+metric, threshold_percent, alpha = "frame_wt", 5.0, 0.05
+dirs = []
+ARGV.each do |arg|
+	case arg
+	when /\A--metric=(.+)\z/    then metric = $1
+	when /\A--threshold=(.+)\z/ then threshold_percent = $1.to_f
+	when /\A--alpha=(.+)\z/     then alpha = $1.to_f
+	when /\A--/                 then abort "unknown option: #{arg}"
+	else dirs << arg
+	end
+end
+abort "usage: #{$0} [--metric=frame_wt] [--threshold=5] [--alpha=0.05] base-dir new-dir" unless dirs.size == 2
+
+
+# Reads the samples of one CSV file into a hash of [scenario, approach] => [values...]. Lines that aren't part of the
+# CSV data (e.g. OpenGL debug output that ended up in the stderr log) are skipped.
+def read_samples(filename, metric)
+	samples = Hash.new{|hash, key| hash[key] = []}
+	column_index = nil
+	File.foreach(filename) do |line|
+		values = line.split(",").map{|value| value.strip}
+		if values.first == "scenario"
+			column_index = values.index(metric) or abort "#{filename}: no column #{metric}"
+			next
+		end
+		next unless column_index and values.size > column_index and values[column_index] =~ /\A-?[\d.]+(us|ms)\z/
+		
+		# Per-frame values are in us, per-approach values in ms. Use ms everywhere.
+		value = values[column_index].to_f
+		value /= 1000.0 if values[column_index].end_with? "us"
+		samples[[values[0], values[1]]] << value
+	end
+	samples
+end
+
+def load_dir(dir, metric)
+	frames_file, approaches_file = File.join(dir, "bench-frames.csv"), File.join(dir, "bench-approaches.csv")
+	if File.exist? frames_file
+		[read_samples(frames_file, metric), "frames"]
+	elsif File.exist? approaches_file
+		[read_samples(approaches_file, metric), "runs"]
+	else
+		abort "#{dir}: neither bench-frames.csv nor bench-approaches.csv found"
+	end
+end
+
+def median(values)
+	sorted = values.sort
+	mid = sorted.size / 2
+	sorted.size.odd? ? sorted[mid] : (sorted[mid - 1] + sorted[mid]) / 2.0
+end
+
+# Two-sided Mann-Whitney U test with tie correction, p-value via the normal approximation (with continuity correction).
+def mann_whitney_p(a, b)
+	n1, n2 = a.size, b.size
+	return 1.0 if n1 == 0 or n2 == 0
+	
+	all = a.map{|v| [v, 0]} + b.map{|v| [v, 1]}
+	all.sort_by!{|value, group| value}
+	ranks = Array.new(all.size)
+	tie_term = 0.0
+	i = 0
+	while i < all.size
+		j = i
+		j += 1 while j + 1 < all.size and all[j + 1][0] == all[i][0]
+		tied = j - i + 1
+		(i..j).each{|k| ranks[k] = (i + j) / 2.0 + 1}
+		tie_term += tied ** 3 - tied
+		i = j + 1
+	end
+	
+	rank_sum_a = all.each_index.select{|k| all[k][1] == 0}.sum{|k| ranks[k]}
+	u = rank_sum_a - n1 * (n1 + 1) / 2.0
+	n = n1 + n2
+	mean = n1 * n2 / 2.0
+	variance = n1 * n2 / 12.0 * ((n + 1) - tie_term / (n * (n - 1)))
+	return 1.0 if variance <= 0
+	
+	z = ((u - mean).abs - 0.5) / Math.sqrt(variance)
+	z = 0.0 if z < 0
+	Math.erfc(z / Math.sqrt(2))
+end
+
+
+base_samples, base_kind = load_dir(dirs[0], metric)
+new_samples, new_kind = load_dir(dirs[1], metric)
+abort "can't compare per-frame samples with per-run samples, both directories need the same files" if base_kind != new_kind
+
+puts format("%-15s , %-25s , %8s , %8s , %12s , %12s , %8s , %8s , %s", "scenario", "approach", "n base", "n new",
+	"base #{metric}", "new #{metric}", "change", "p", "verdict")
+
+regressions = 0
+(base_samples.keys & new_samples.keys).each do |key|
+	base, new = base_samples[key], new_samples[key]
+	base_median, new_median = median(base), median(new)
+	change_percent = (base_median == 0) ? 0.0 : (new_median - base_median) / base_median * 100
+	p_value = mann_whitney_p(base, new)
+	
+	verdict = if p_value >= alpha or change_percent.abs <= threshold_percent
+		"same"
+	elsif change_percent > 0
+		regressions += 1
+		"REGRESSION"
+	else
+		"improvement"
+	end
+	
+	puts format("%-15s , %-25s , %8d , %8d , %10.3fms , %10.3fms , %+7.1f%% , %8.2g , %s", key[0], key[1], base.size, new.size,
+		base_median, new_median, change_percent, p_value, verdict)
+end
+
+(base_samples.keys - new_samples.keys).each{|scenario, approach| puts "#{scenario}, #{approach}: only in #{dirs[0]}"}
+(new_samples.keys - base_samples.keys).each{|scenario, approach| puts "#{scenario}, #{approach}: only in #{dirs[1]}"}
+
+exit(regressions > 0 ? 1 : 0)
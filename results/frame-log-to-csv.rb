@@ -0,0 +1,66 @@
+#!/usr/bin/ruby
+# Converts binary per-frame logs written via `26-bench-rect-drawing --frame-log=file` into the bench-frames.csv layout
+# the benchmark writes to stderr otherwise. When multiple files are given their frames are concatenated below one header
+# (like the appended runs in run-benchmark.sh).
+#
+# Usage: ruby frame-log-to-csv.rb bench-frames-1.bin [bench-frames-2.bin ...] > bench-frames.csv
+#
+# The file layout is described above report_log_record_t in 26-bench-rect-drawing.c.
+
+REPORT_LOG_APPROACH = 1
+REPORT_LOG_FRAME = 2
+# Version 1 logs have no fence delta and versions before 3 no upload bytes, their columns are 0 then
+DELTA_NAMES = {
+	1 => [:approach, :frame, :buffer, :upload, :clear, :draw, :pres],
+	2 => [:approach, :frame, :buffer, :upload, :clear, :draw, :pres, :fence],
+	3 => [:approach, :frame, :buffer, :upload, :clear, :draw, :pres, :fence]
+}
+
+abort "usage: #{$0} frame-log.bin [frame-log.bin ...]" if ARGV.empty?
+
+puts "scenario        , approach                  , frame ," +
+	"   frame_wt ,   frame_ct ,   frame_gt ,         dt ," +
+	"  buffer_wt ,  buffer_ct ,  buffer_gt ,  buffer_ge ," +
+	"  upload_wt ,  upload_ct ,  upload_gt ,  upload_ge ," +
+	"   clear_wt ,   clear_ct ,   clear_gt ,   clear_ge ," +
+	"    draw_wt ,    draw_ct ,    draw_gt ,    draw_ge ," +
+	"    pres_wt ,    pres_ct ,    pres_gt ,    pres_ge ," +
+	"   fence_wt ,   fence_ct , upload_bytes"
+
+ARGV.each do |filename|
+	File.open(filename, "rb") do |file|
+		magic, version, record_size = file.read(12).unpack("a4L<L<")
+		abort "#{filename}: not a frame log" unless magic == "26FL"
+		abort "#{filename}: unsupported version #{version}" unless DELTA_NAMES.key? version
+		delta_names = DELTA_NAMES[version]
+
+		scenario, approach = nil, nil
+		while record = file.read(record_size)
+			type, frame = record.unpack("L<L<")
+			case type
+			when REPORT_LOG_APPROACH
+				scenario, approach = record.unpack("@8Z32Z64")
+			when REPORT_LOG_FRAME
+				values = record.unpack("@8" + "q<q<Q<Q<" * delta_names.size + "q<" + (version >= 3 ? "Q<" : ""))
+				upload_bytes = (version >= 3) ? values.pop : 0
+				deltas = delta_names.each_with_index.map do |name, index|
+					wt, ct, gt, ge = values[index * 4, 4].map{|ns| ns / 1000.0}
+					[name, { wt: wt, ct: ct, gt: gt, ge: ge }]
+				end.to_h
+				deltas[:fence] ||= { wt: 0.0, ct: 0.0 }
+				dt = values.last / 1000.0
+
+				columns = [ format("%-15s , %-25s , %5u", scenario, approach, frame) ]
+				columns += [ deltas[:frame][:wt], deltas[:frame][:ct], deltas[:frame][:gt], dt ].map{|v| format("%8.3fus", v)}
+				[:buffer, :upload, :clear, :draw, :pres].each do |name|
+					columns += deltas[name].values_at(:wt, :ct, :gt, :ge).map{|v| format("%8.3fus", v)}
+				end
+				columns += deltas[:fence].values_at(:wt, :ct).map{|v| format("%8.3fus", v)}
+				columns << format("%12u", upload_bytes)
+				puts columns.join(" , ")
+			else
+				abort "#{filename}: unknown record type #{type}"
+			end
+		end
+	end
+end
@@ -0,0 +1,46 @@
+#!/usr/bin/ruby
+# Lists the gen buffers time of each approach per thread count from the scaling data written by
+# `26-bench-rect-drawing --gen-threads=1,2,4,8` (bench-sweep.csv). For each scenario, rect count and render size it
+# prints the median of every thread count and the speedup against the lowest thread count.
+#
+# Usage: ruby gen-scaling.rb [--phase=buffer] [--metric=wt] bench-sweep.csv
+
+phase, metric = "buffer", "wt"
+args = []
+ARGV.each do |arg|
+	case arg
+	when /\A--phase=(\w+)\z/   then phase = $1
+	when /\A--metric=(\w+)\z/  then metric = $1
+	when /\A--/                then abort "unknown option: #{arg}"
+	else args << arg
+	end
+end
+abort "usage: #{$0} [--phase=buffer] [--metric=wt] bench-sweep.csv" unless args.size == 1
+filename = args.first
+
+# times[[scenario, rects, width, height]][approach][threads] = median in us
+times = Hash.new{|hash, key| hash[key] = Hash.new{|h, k| h[k] = {} } }
+File.foreach(filename) do |line|
+	scenario, approach, rects, width, height, line_phase, line_metric, median, per_rect, per_mpx, threads = line.split(",").map(&:strip)
+	next if scenario == "scenario" or line_phase != phase or line_metric != metric
+	abort "#{filename}: no threads column, written by a benchmark without --gen-threads=" unless threads
+	times[[scenario, rects.to_i, width.to_i, height.to_i]][approach][threads.to_i] = median.to_f
+end
+abort "#{filename}: no #{phase} #{metric} data" if times.empty?
+
+times.each do |(scenario, rects, width, height), approaches|
+	thread_counts = approaches.values.flat_map(&:keys).uniq.sort
+	puts "#{scenario}, #{rects} rects, #{width}x#{height}, #{phase} #{metric} median per thread count (speedup against #{thread_counts.first} thread#{thread_counts.first == 1 ? "" : "s"}):"
+	puts format("  %-25s", "approach") + thread_counts.map{|threads| format(" %20s", "#{threads} thread#{threads == 1 ? "" : "s"}") }.join
+	approaches.each do |approach, medians|
+		base = medians[thread_counts.first]
+		columns = thread_counts.map do |threads|
+			median = medians[threads]
+			next format(" %20s", "-") unless median
+			speedup = (base and median > 0) ? format("%.2fx", base / median) : "-"
+			format(" %11.1fus %6s", median, speedup)
+		end
+		puts format("  %-25s", approach) + columns.join
+	end
+	puts
+end
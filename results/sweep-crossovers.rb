@@ -0,0 +1,71 @@
+#!/usr/bin/ruby
+# Finds the crossover points of two approaches in the scaling data written by `26-bench-rect-drawing --sweep-rects=...
+# --sweep-sizes=...` (bench-sweep.csv). For each scenario and render size it walks along the rect counts and reports
+# where the faster approach changes. The crossover rect count is interpolated on the log scale the sweep uses. Along
+# the render sizes (at the same rect count) it does the same with the megapixels. Files with several --gen-threads= counts
+# are compared at one thread count, the first one in the file unless --threads=N picks another.
+#
+# Usage: ruby sweep-crossovers.rb [--phase=frame] [--metric=wt] [--threads=N] bench-sweep.csv one_ssbo inst_div
+
+phase, metric, threads = "frame", "wt", nil
+args = []
+ARGV.each do |arg|
+	case arg
+	when /\A--phase=(\w+)\z/   then phase = $1
+	when /\A--metric=(\w+)\z/  then metric = $1
+	when /\A--threads=(\d+)\z/ then threads = $1.to_i
+	when /\A--/                then abort "unknown option: #{arg}"
+	else args << arg
+	end
+end
+abort "usage: #{$0} [--phase=frame] [--metric=wt] [--threads=N] bench-sweep.csv approach_a approach_b" unless args.size == 3
+filename, approach_a, approach_b = args
+
+# times[[scenario, width, height, rects]][approach] = median in us
+times = Hash.new{|hash, key| hash[key] = {} }
+File.foreach(filename) do |line|
+	scenario, approach, rects, width, height, line_phase, line_metric, median, per_rect, per_mpx, line_threads = line.split(",").map(&:strip)
+	next if scenario == "scenario" or line_phase != phase or line_metric != metric
+	# Older files have no threads column, the gen buffers phase always ran on one thread back then
+	line_threads = (line_threads || 1).to_i
+	threads ||= line_threads
+	next unless line_threads == threads
+	next unless [approach_a, approach_b].include? approach
+	times[[scenario, width.to_i, height.to_i, rects.to_i]][approach] = median.to_f
+end
+points = times.select{|key, medians| medians.size == 2 }
+abort "#{filename}: no points with both #{approach_a} and #{approach_b} for #{phase} #{metric}" if points.empty?
+
+def faster(medians, approach_a, approach_b)
+	(medians[approach_a] <= medians[approach_b]) ? approach_a : approach_b
+end
+
+# x values of a and b with the difference of the medians at them, the crossover is where the difference is 0
+def interpolate_log(x_a, diff_a, x_b, diff_b)
+	t = diff_a / (diff_a - diff_b)
+	Math.exp(Math.log(x_a) + t * (Math.log(x_b) - Math.log(x_a)))
+end
+
+def report_crossovers(label, series, approach_a, approach_b, unit)
+	series = series.sort_by(&:first)
+	series.each_cons(2) do |(x1, medians1), (x2, medians2)|
+		before, after = faster(medians1, approach_a, approach_b), faster(medians2, approach_a, approach_b)
+		next if before == after
+		diff1 = medians1[approach_a] - medians1[approach_b]
+		diff2 = medians2[approach_a] - medians2[approach_b]
+		crossover = interpolate_log(x1, diff1, x2, diff2)
+		puts format("%-15s %-12s %s overtakes %s between %g and %g %s (about %.4g)", label[0], label[1], after, before, x1, x2, unit, crossover)
+	end
+	fastest = series.map{|x, medians| faster(medians, approach_a, approach_b) }.uniq
+	puts format("%-15s %-12s %s is faster at all %d points", label[0], label[1], fastest.first, series.size) if fastest.size == 1
+end
+
+puts "#{phase} #{metric} of #{approach_a} vs. #{approach_b}:"
+points.group_by{|(scenario, width, height, rects), medians| [scenario, width, height] }.each do |(scenario, width, height), group|
+	series = group.map{|(s, w, h, rects), medians| [rects, medians] }
+	report_crossovers([scenario, "#{width}x#{height}"], series, approach_a, approach_b, "rects") if series.size > 1
+end
+points.group_by{|(scenario, width, height, rects), medians| [scenario, rects] }.each do |(scenario, rects), group|
+	series = group.map{|(s, width, height, r), medians| [width * height / 1_000_000.0, medians] }
+	report_crossovers([scenario, "#{rects} rects"], series, approach_a, approach_b, "megapixels") if series.size > 1
+end
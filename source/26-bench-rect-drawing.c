@@ -5,7 +5,36 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <time.h>
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#else
+#include <io.h>  // mkdir()
+#endif
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>  // SSE2 and AVX2 spans of the CPU rasterizer, SSE4.1 and AVX2 batch packers, streaming stores
+#define CPU_RASTER_X86 1
+#define GEN_SIMD_X86 1
+#define UPLOAD_STREAM_X86 1
+#endif
 
+#ifndef _WIN32
+// EGL has to be included before gl45.h. Otherwise the khrplatform.h copy in gl45.h (without KHRONOS_APIENTRY) is used.
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
 #define GLAD_GL_IMPLEMENTATION
 #include <gl45.h>
 #define GL45_HELPERS_IMPLEMENTATION
@@ -68,16 +97,240 @@ uint32_t rand_in(uint64_t* state, uint32_t min, uint32_t max) {
 	return min + (value % (max - min));
 }
 
-GLuint load_gl_texture(const char* filename) {
+/**
+ * Matches name against a shell style glob pattern. Only "*" (any number of characters) and "?" (one character) are
+ * supported. Written by hand since fnmatch() isn't available with MinGW.
+ */
+bool glob_match(const char* pattern, const char* name) {
+	for (; *pattern != '\0'; pattern++, name++) {
+		if (*pattern == '*') {
+			for (const char* rest = name; ; rest++) {
+				if ( glob_match(pattern + 1, rest) )
+					return true;
+				if (*rest == '\0')
+					return false;
+			}
+		} else if ( *name == '\0' || (*pattern != '?' && *pattern != *name) ) {
+			return false;
+		}
+	}
+	
+	return *name == '\0';
+}
+
+/**
+ * Checks name against a comma separated list of glob patterns (e.g. "one_ssbo*,inst_div"). An empty list matches
+ * everything.
+ */
+bool glob_list_match(const char* pattern_list, const char* name) {
+	if (pattern_list == NULL || pattern_list[0] == '\0')
+		return true;
+	
+	char* patterns = strdup(pattern_list);
+	bool matched = false;
+	for (char* pattern = strtok(patterns, ","); pattern != NULL && !matched; pattern = strtok(NULL, ","))
+		matched = glob_match(pattern, name);
+	free(patterns);
+	
+	return matched;
+}
+
+/**
+ * Maps a whole file into memory (copy on write) and returns the mapping or NULL on errors. Errors are printed with
+ * error_prefix in front.
+ */
+void* file_map(const char* filename, size_t* size, const char* error_prefix) {
+	void* mapping = NULL;
+	#ifdef _WIN32
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		fprintf(stderr, "%s: can't open %s\n", error_prefix, filename);
+		return NULL;
+	}
+	LARGE_INTEGER file_size;
+	GetFileSizeEx(file, &file_size);
+	HANDLE file_mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+	mapping = file_mapping ? MapViewOfFile(file_mapping, FILE_MAP_COPY, 0, 0, 0) : NULL;
+	if (file_mapping)
+		CloseHandle(file_mapping);
+	CloseHandle(file);
+	*size = file_size.QuadPart;
+	#else
+	FILE* f = fopen(filename, "rb");
+	if (f == NULL) {
+		fprintf(stderr, "%s: can't open %s: %s\n", error_prefix, filename, strerror(errno));
+		return NULL;
+	}
+	fseek(f, 0, SEEK_END);
+	*size = ftell(f);
+	// MAP_PRIVATE: users may modify the data (e.g. approaches the rects of a scene), that must not end up in the file
+	mapping = mmap(NULL, *size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(f), 0);
+	if (mapping == MAP_FAILED)
+		mapping = NULL;
+	fclose(f);
+	#endif
+	
+	if (mapping == NULL)
+		fprintf(stderr, "%s: failed to map %s into memory\n", error_prefix, filename);
+	return mapping;
+}
+
+void file_unmap(void* mapping, size_t size) {
+	#ifdef _WIN32
+	UnmapViewOfFile(mapping);
+	#else
+	munmap(mapping, size);
+	#endif
+}
+
+
+
+//
+// Texture loading
+//
+// The images are decoded on a pool of worker threads (texture_decoder_start()). main() starts it before the display is
+// opened, so decoding overlaps with the context creation. texture_decoder_upload() then copies each image into one pixel
+// buffer object as soon as it's decoded, and the textures are created from that buffer. Images are decoded in the order
+// they're given, so the largest one should come first.
+//
+
+#define TEXTURE_DECODER_MAX_IMAGES  16
+#define TEXTURE_DECODER_MAX_THREADS 64
+
+uint32_t texture_decoder_threads = 0;  // --texture-threads=N, 0 uses one thread per CPU
+
+typedef struct {
+	char     filename[256];
+	int      width, height;  // From stbi_info() before decoding, to size the pixel buffer object upfront
+	uint8_t* pixels;         // RGBA8, NULL if decoding failed
+	bool     done;
+	nsec_t   decode_ns;
+	size_t   pbo_offset;
+} texture_image_t;
+
+typedef struct {
+	texture_image_t images[TEXTURE_DECODER_MAX_IMAGES];
+	uint32_t        image_count, next_image;
+	pthread_t       threads[TEXTURE_DECODER_MAX_THREADS];
+	uint32_t        thread_count;
+	pthread_mutex_t mutex;
+	pthread_cond_t  image_done_cond;
+	GLuint          pbo;
+	nsec_t          start_ns, decoded_ns, wait_ns, upload_start_ns;
+} texture_decoder_t;
+
+void* texture_decoder_worker(void* arg) {
+	texture_decoder_t* decoder = arg;
+	
+	pthread_mutex_lock(&decoder->mutex);
+	while (decoder->next_image < decoder->image_count) {
+		texture_image_t* image = &decoder->images[decoder->next_image++];
+		pthread_mutex_unlock(&decoder->mutex);
+		
+		nsec_t start = time_now_ns();
+		int width = 0, height = 0, n = 0;
+		uint8_t* pixels = stbi_load(image->filename, &width, &height, &n, 4);
+		if (pixels && (width != image->width || height != image->height)) {
+			stbi_image_free(pixels);
+			pixels = NULL;
+		}
+		nsec_t end = time_now_ns();
+		
+		pthread_mutex_lock(&decoder->mutex);
+		image->pixels = pixels;
+		image->decode_ns = end - start;
+		image->done = true;
+		if (end > decoder->decoded_ns)
+			decoder->decoded_ns = end;
+		pthread_cond_broadcast(&decoder->image_done_cond);
+	}
+	pthread_mutex_unlock(&decoder->mutex);
+	
+	return NULL;
+}
+
+/**
+ * Starts decoding the images on the worker threads. Doesn't need an OpenGL context. Returns false if an image can't be
+ * read.
+ */
+bool texture_decoder_start(texture_decoder_t* decoder, uint32_t image_count, const char* filenames[image_count]) {
+	assert(image_count <= TEXTURE_DECODER_MAX_IMAGES);
+	*decoder = (texture_decoder_t){ .image_count = image_count, .start_ns = time_now_ns() };
+	for (uint32_t i = 0; i < image_count; i++) {
+		texture_image_t* image = &decoder->images[i];
+		snprintf(image->filename, sizeof(image->filename), "%s", filenames[i]);
+		int n = 0;
+		if ( !stbi_info(image->filename, &image->width, &image->height, &n) ) {
+			fprintf(stderr, "Texture loading: can't read %s\n", image->filename);
+			return false;
+		}
+	}
+	
+	decoder->thread_count = (texture_decoder_threads > 0) ? texture_decoder_threads : (uint32_t)SDL_GetCPUCount();
+	if (decoder->thread_count < 1)
+		decoder->thread_count = 1;
+	else if (decoder->thread_count > image_count)
+		decoder->thread_count = image_count;
+	
+	pthread_mutex_init(&decoder->mutex, NULL);
+	pthread_cond_init(&decoder->image_done_cond, NULL);
+	for (uint32_t i = 0; i < decoder->thread_count; i++)
+		pthread_create(&decoder->threads[i], NULL, texture_decoder_worker, decoder);
+	return true;
+}
+
+/**
+ * Waits for the images and copies each one into the pixel buffer object as soon as it's done. Returns false if an image
+ * couldn't be decoded.
+ */
+bool texture_decoder_upload(texture_decoder_t* decoder) {
+	size_t pbo_size = 0;
+	for (uint32_t i = 0; i < decoder->image_count; i++) {
+		decoder->images[i].pbo_offset = pbo_size;
+		pbo_size += (size_t)decoder->images[i].width * decoder->images[i].height * 4;
+	}
+	glCreateBuffers(1, &decoder->pbo);
+	glNamedBufferStorage(decoder->pbo, pbo_size, NULL, GL_MAP_WRITE_BIT);
+	uint8_t* pbo_ptr = glMapNamedBufferRange(decoder->pbo, 0, pbo_size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	
+	bool all_decoded = true;
+	decoder->upload_start_ns = time_now_ns();
+	for (uint32_t i = 0; i < decoder->image_count; i++) {
+		texture_image_t* image = &decoder->images[i];
+		nsec_t wait_start = time_now_ns();
+		pthread_mutex_lock(&decoder->mutex);
+		while (!image->done)
+			pthread_cond_wait(&decoder->image_done_cond, &decoder->mutex);
+		pthread_mutex_unlock(&decoder->mutex);
+		decoder->wait_ns += time_now_ns() - wait_start;
+		
+		if (image->pixels) {
+			memcpy(pbo_ptr + image->pbo_offset, image->pixels, (size_t)image->width * image->height * 4);
+			stbi_image_free(image->pixels);
+			image->pixels = NULL;
+		} else {
+			fprintf(stderr, "Texture loading: can't decode %s\n", image->filename);
+			all_decoded = false;
+		}
+	}
+	
+	glUnmapNamedBuffer(decoder->pbo);
+	return all_decoded;
+}
+
+/**
+ * Creates a 2D texture from an image after texture_decoder_upload(), with the given number of mipmap levels.
+ */
+GLuint texture_decoder_texture_2d(texture_decoder_t* decoder, uint32_t image_index, uint32_t levels) {
+	texture_image_t* image = &decoder->images[image_index];
 	GLuint texture = 0;
 	glCreateTextures(GL_TEXTURE_2D, 1, &texture);
-	
-	int width = 0, height = 0, n = 0;
-	uint8_t* pixel_data = stbi_load(filename, &width, &height, &n, 4);
-		glTextureStorage2D(texture, 4, GL_RGBA8, width, height);
-		glTextureSubImage2D(texture, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixel_data);
+	glTextureStorage2D(texture, levels, GL_RGBA8, image->width, image->height);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, decoder->pbo);
+		glTextureSubImage2D(texture, 0, 0, 0, image->width, image->height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)image->pbo_offset);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	if (levels > 1)
 		glGenerateTextureMipmap(texture);
-	stbi_image_free(pixel_data);
 	
 	glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -86,21 +339,26 @@ GLuint load_gl_texture(const char* filename) {
 	return texture;
 }
 
-GLuint load_gl_texture_array(uint32_t texture_width, uint32_t texture_height, uint32_t layer_count, const char* filename_format, uint32_t index_start, uint32_t index_end) {
-	assert(layer_count == index_end - index_start + 1);
+/**
+ * Creates a 2D array texture with one layer per image (starting at first_image) after texture_decoder_upload(). All
+ * images must have the same size. Returns 0 if they don't.
+ */
+GLuint texture_decoder_texture_array(texture_decoder_t* decoder, uint32_t first_image, uint32_t layer_count) {
+	texture_image_t* images = &decoder->images[first_image];
+	for (uint32_t i = 1; i < layer_count; i++) {
+		if (images[i].width != images[0].width || images[i].height != images[0].height) {
+			fprintf(stderr, "Texture loading: %s has a different size than %s\n", images[i].filename, images[0].filename);
+			return 0;
+		}
+	}
+	
 	GLuint texture_array = 0;
 	glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &texture_array);
-	glTextureStorage3D(texture_array, 1, GL_RGBA8, texture_width, texture_height, layer_count);
-	for (uint32_t i = index_start; i <= index_end; i++) {
-		int width = 0, height = 0, n = 0;
-		char filename[255];
-		snprintf(filename, sizeof(filename), filename_format, i);
-		uint8_t* pixel_data = stbi_load(filename, &width, &height, &n, 4);
-			assert((uint32_t)width == texture_width);
-			assert((uint32_t)height == texture_height);
-			glTextureSubImage3D(texture_array, 0, 0, 0, i - index_start, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel_data);
-		stbi_image_free(pixel_data);
-	}
+	glTextureStorage3D(texture_array, 1, GL_RGBA8, images[0].width, images[0].height, layer_count);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, decoder->pbo);
+	for (uint32_t i = 0; i < layer_count; i++)
+		glTextureSubImage3D(texture_array, 0, 0, 0, i, images[i].width, images[i].height, 1, GL_RGBA, GL_UNSIGNED_BYTE, (void*)images[i].pbo_offset);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 	
 	glTextureParameteri(texture_array, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTextureParameteri(texture_array, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -108,6 +366,524 @@ GLuint load_gl_texture_array(uint32_t texture_width, uint32_t texture_height, ui
 	return texture_array;
 }
 
+/**
+ * Stops the worker threads and prints the timings of the phases: Decoding (from texture_decoder_start() until the last
+ * image was done and the decode time of all images summed up), how long the main thread waited for images and the
+ * upload (everything else after texture_decoder_upload() started, including the GPU work).
+ */
+void texture_decoder_finish(texture_decoder_t* decoder) {
+	for (uint32_t i = 0; i < decoder->thread_count; i++)
+		pthread_join(decoder->threads[i], NULL);
+	pthread_cond_destroy(&decoder->image_done_cond);
+	pthread_mutex_destroy(&decoder->mutex);
+	glDeleteBuffers(1, &decoder->pbo);
+	
+	glFinish();
+	nsec_t end = time_now_ns(), decode_sum_ns = 0;
+	for (uint32_t i = 0; i < decoder->image_count; i++) {
+		decode_sum_ns += decoder->images[i].decode_ns;
+		stbi_image_free(decoder->images[i].pixels);
+	}
+	fprintf(stderr, "Textures: %u images decoded on %u threads in %.1lfms (%.1lfms summed), waited %.1lfms for them, upload %.1lfms\n",
+		decoder->image_count, decoder->thread_count, (decoder->decoded_ns - decoder->start_ns) / 1000000.0, decode_sum_ns / 1000000.0,
+		decoder->wait_ns / 1000000.0, (end - decoder->upload_start_ns - decoder->wait_ns) / 1000000.0
+	);
+}
+
+
+
+//
+// Texture bundles
+//
+// --texture-bundle=file loads the textures from a bundle with the decoded texels of all mipmap levels instead of
+// decoding the PNG and JPEG files and generating the mipmaps. The bundle is mapped into memory and the levels are
+// uploaded right from the mapping. --write-texture-bundle=file creates a bundle from the image files. It reads the
+// levels back from OpenGL, so a bundle contains exactly the texels the normal loading produces.
+//
+// Layout of version 1, native byte order:
+//
+//     offset  size
+//          0     4  magic "26TB"
+//          4     4  uint32_t version, 1
+//          8     4  uint32_t texture count
+//         12     4  reserved, 0
+//         16     -  texture_bundle_entry_t (112 bytes) for each texture
+//          -     -  texel data of each texture at a multiple of 64 bytes. GL_RGBA8, level after level and within a
+//                   level layer after layer.
+//
+
+#define TEXTURE_BUNDLE_VERSION 1
+typedef struct {
+	char     magic[4];
+	uint32_t version, texture_count, reserved;
+} texture_bundle_header_t;
+
+typedef struct {
+	char     name[72];  // Filename the texture is normally loaded from, e.g. "icons/%02d.png" for the texture array
+	uint32_t target;    // GL_TEXTURE_2D or GL_TEXTURE_2D_ARRAY
+	uint32_t width, height, layers, levels;
+	uint32_t reserved;
+	uint64_t offset, size;  // Texel data of all levels, offset from the start of the file
+} texture_bundle_entry_t;
+
+_Static_assert(sizeof(texture_bundle_header_t) == 16 && sizeof(texture_bundle_entry_t) == 112, "texture bundle structs don't match the file layout");
+
+typedef struct {
+	texture_bundle_entry_t* entries;
+	uint32_t texture_count;
+	void*    mapping;
+	size_t   mapping_size;
+} texture_bundle_t;
+
+uint64_t texture_bundle_texel_size(uint32_t width, uint32_t height, uint32_t layers, uint32_t levels) {
+	uint64_t size = 0;
+	for (uint32_t level = 0; level < levels; level++)
+		size += (uint64_t)((width >> level) ? width >> level : 1) * ((height >> level) ? height >> level : 1) * layers * 4;
+	return size;
+}
+
+void texture_bundle_close(texture_bundle_t* bundle) {
+	if (bundle->mapping)
+		file_unmap(bundle->mapping, bundle->mapping_size);
+	*bundle = (texture_bundle_t){ 0 };
+}
+
+bool texture_bundle_open(texture_bundle_t* bundle, const char* filename) {
+	*bundle = (texture_bundle_t){ 0 };
+	bundle->mapping = file_map(filename, &bundle->mapping_size, "Texture bundle");
+	if (bundle->mapping == NULL)
+		return false;
+	
+	const char* error = NULL;
+	texture_bundle_header_t* header = bundle->mapping;
+	if (bundle->mapping_size < sizeof(texture_bundle_header_t) || memcmp(header->magic, "26TB", 4) != 0)
+		error = "not a texture bundle";
+	else if (header->version != TEXTURE_BUNDLE_VERSION)
+		error = "unsupported version";
+	else if (sizeof(texture_bundle_header_t) + (uint64_t)header->texture_count * sizeof(texture_bundle_entry_t) > bundle->mapping_size)
+		error = "file is truncated";
+	texture_bundle_entry_t* entries = (texture_bundle_entry_t*)(header + 1);
+	for (uint32_t i = 0; error == NULL && i < header->texture_count; i++) {
+		texture_bundle_entry_t* entry = &entries[i];
+		if ( (entry->target != GL_TEXTURE_2D && entry->target != GL_TEXTURE_2D_ARRAY) || entry->levels == 0 || entry->layers == 0 || entry->name[sizeof(entry->name) - 1] != '\0' )
+			error = "invalid texture entry";
+		else if ( entry->size != texture_bundle_texel_size(entry->width, entry->height, entry->layers, entry->levels) || entry->offset % 64 != 0 )
+			error = "texel data size doesn't match the texture";
+		else if (entry->offset + entry->size > bundle->mapping_size)
+			error = "file is truncated";
+	}
+	if (error) {
+		fprintf(stderr, "Texture bundle: %s: %s\n", filename, error);
+		texture_bundle_close(bundle);
+		return false;
+	}
+	
+	bundle->entries = entries;
+	bundle->texture_count = header->texture_count;
+	return true;
+}
+
+/**
+ * Creates the texture stored under name in the bundle with the same parameters as load_gl_texture() or
+ * load_gl_texture_array(). Returns 0 if the bundle has no such texture.
+ */
+GLuint texture_bundle_load(texture_bundle_t* bundle, const char* name) {
+	texture_bundle_entry_t* entry = NULL;
+	for (uint32_t i = 0; i < bundle->texture_count && entry == NULL; i++) {
+		if ( strcmp(bundle->entries[i].name, name) == 0 )
+			entry = &bundle->entries[i];
+	}
+	if (entry == NULL) {
+		fprintf(stderr, "Texture bundle: no texture %s in the bundle\n", name);
+		return 0;
+	}
+	
+	GLuint texture = 0;
+	glCreateTextures(entry->target, 1, &texture);
+	if (entry->target == GL_TEXTURE_2D_ARRAY)
+		glTextureStorage3D(texture, entry->levels, GL_RGBA8, entry->width, entry->height, entry->layers);
+	else
+		glTextureStorage2D(texture, entry->levels, GL_RGBA8, entry->width, entry->height);
+	
+	const uint8_t* texels = (const uint8_t*)bundle->mapping + entry->offset;
+	for (uint32_t level = 0; level < entry->levels; level++) {
+		uint32_t width = (entry->width >> level) ? entry->width >> level : 1, height = (entry->height >> level) ? entry->height >> level : 1;
+		if (entry->target == GL_TEXTURE_2D_ARRAY)
+			glTextureSubImage3D(texture, level, 0, 0, 0, width, height, entry->layers, GL_RGBA, GL_UNSIGNED_BYTE, texels);
+		else
+			glTextureSubImage2D(texture, level, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, texels);
+		texels += (size_t)width * height * entry->layers * 4;
+	}
+	
+	glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	if (entry->levels > 1)
+		glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	
+	return texture;
+}
+
+/**
+ * Writes the GL_RGBA8 textures (2D or 2D array) with all their levels into a bundle. names are the names they're
+ * loaded with later on.
+ */
+bool texture_bundle_write(const char* filename, uint32_t texture_count, const char* names[texture_count], GLuint textures[texture_count]) {
+	FILE* f = fopen(filename, "wb");
+	if (f == NULL) {
+		fprintf(stderr, "Texture bundle: can't write %s: %s\n", filename, strerror(errno));
+		return false;
+	}
+	
+	texture_bundle_header_t header = (texture_bundle_header_t){ .magic = "26TB", .version = TEXTURE_BUNDLE_VERSION, .texture_count = texture_count };
+	texture_bundle_entry_t entries[texture_count];
+	uint64_t offset = sizeof(header) + sizeof(entries);
+	for (uint32_t i = 0; i < texture_count; i++) {
+		GLint target = 0, width = 0, height = 0, layers = 0, levels = 0;
+		glGetTextureParameteriv(textures[i], GL_TEXTURE_TARGET, &target);
+		glGetTextureParameteriv(textures[i], GL_TEXTURE_IMMUTABLE_LEVELS, &levels);
+		glGetTextureLevelParameteriv(textures[i], 0, GL_TEXTURE_WIDTH, &width);
+		glGetTextureLevelParameteriv(textures[i], 0, GL_TEXTURE_HEIGHT, &height);
+		glGetTextureLevelParameteriv(textures[i], 0, GL_TEXTURE_DEPTH, &layers);
+		
+		offset = (offset + 63) / 64 * 64;
+		entries[i] = (texture_bundle_entry_t){ .target = target, .width = width, .height = height, .layers = layers, .levels = levels, .offset = offset };
+		snprintf(entries[i].name, sizeof(entries[i].name), "%s", names[i]);
+		entries[i].size = texture_bundle_texel_size(width, height, layers, levels);
+		offset += entries[i].size;
+	}
+	
+	bool written = fwrite(&header, sizeof(header), 1, f) == 1 && fwrite(entries, sizeof(entries), 1, f) == 1;
+	for (uint32_t i = 0; i < texture_count && written; i++) {
+		uint8_t* texels = malloc(entries[i].size);
+		uint8_t* level_texels = texels;
+		for (uint32_t level = 0; level < entries[i].levels; level++) {
+			uint32_t width = (entries[i].width >> level) ? entries[i].width >> level : 1, height = (entries[i].height >> level) ? entries[i].height >> level : 1;
+			size_t level_size = (size_t)width * height * entries[i].layers * 4;
+			glGetTextureImage(textures[i], level, GL_RGBA, GL_UNSIGNED_BYTE, level_size, level_texels);
+			level_texels += level_size;
+		}
+		
+		written = fseek(f, entries[i].offset, SEEK_SET) == 0 && fwrite(texels, entries[i].size, 1, f) == 1;
+		free(texels);
+	}
+	written = (fclose(f) == 0) && written;
+	
+	if (!written)
+		fprintf(stderr, "Texture bundle: failed to write %s\n", filename);
+	return written;
+}
+
+
+
+//
+// Display backends
+//
+// The SDL backend renders into the default framebuffer of a window and presents a frame via SDL_GL_SwapWindow().
+// The EGL backend is meant for servers without a display (e.g. Mesa llvmpipe on a build farm). It creates an OpenGL
+// 4.5 core context without a window and renders into an offscreen FBO. There is nothing to swap there, so presenting a
+// frame inserts a fence and waits for the fence of an older frame. That keeps the same number of frames in flight a
+// swap chain would.
+// With offscreen set the SDL backend also renders into an offscreen FBO (the window stays empty). The verification mode
+// uses that to read back exactly what an approach rendered.
+//
+
+typedef enum { DISPLAY_SDL = 0, DISPLAY_EGL } display_backend_t;
+#define DISPLAY_FRAMES_IN_FLIGHT 2
+
+typedef struct {
+	display_backend_t backend;
+	int width, height;
+	
+	SDL_Window*   sdl_window;
+	SDL_GLContext sdl_gl_ctx;
+	
+	#ifndef _WIN32
+	EGLDisplay egl_display;
+	EGLSurface egl_pbuffer;
+	EGLContext egl_ctx;
+	#endif
+	GLuint   offscreen_fbo, offscreen_color_rb;  // 0 when rendering into the window
+	GLenum   offscreen_format;
+	GLuint   msaa_fbo, msaa_color_rb;            // Only with msaa_samples > 0, resolved into the offscreen FBO
+	uint32_t msaa_samples;
+	GLsync   present_fences[DISPLAY_FRAMES_IN_FLIGHT];
+	uint32_t present_fence_index;
+} display_t;
+
+#ifndef _WIN32
+bool display_open_egl_context(display_t* display) {
+	bool has_extension(const char* extensions, const char* name) {
+		size_t name_len = strlen(name);
+		for (const char* match = strstr(extensions, name); match != NULL; match = strstr(match + name_len, name)) {
+			if ( (match == extensions || match[-1] == ' ') && (match[name_len] == ' ' || match[name_len] == '\0') )
+				return true;
+		}
+		return false;
+	}
+	
+	// Prefer Mesas surfaceless platform, it doesn't need any window system at all. Otherwise fall back to the default display.
+	const char* client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+	display->egl_display = EGL_NO_DISPLAY;
+	if (client_extensions && has_extension(client_extensions, "EGL_MESA_platform_surfaceless") && has_extension(client_extensions, "EGL_EXT_platform_base")) {
+		PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+		display->egl_display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+	}
+	if (display->egl_display == EGL_NO_DISPLAY)
+		display->egl_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	
+	EGLint major = 0, minor = 0;
+	if ( display->egl_display == EGL_NO_DISPLAY || !eglInitialize(display->egl_display, &major, &minor) ) {
+		fprintf(stderr, "EGL: failed to initialize display (error 0x%04x)\n", eglGetError());
+		return false;
+	}
+	if ( !eglBindAPI(EGL_OPENGL_API) ) {
+		fprintf(stderr, "EGL: desktop OpenGL not supported (error 0x%04x)\n", eglGetError());
+		return false;
+	}
+	
+	// Without EGL_KHR_no_config_context and EGL_KHR_surfaceless_context we need a config and a tiny pbuffer to make the
+	// context current. We never render into the pbuffer, everything goes into the offscreen FBO.
+	const char* display_extensions = eglQueryString(display->egl_display, EGL_EXTENSIONS);
+	bool use_surfaceless = has_extension(display_extensions, "EGL_KHR_no_config_context") && has_extension(display_extensions, "EGL_KHR_surfaceless_context");
+	EGLConfig config = EGL_NO_CONFIG_KHR;
+	display->egl_pbuffer = EGL_NO_SURFACE;
+	if (!use_surfaceless) {
+		EGLint config_count = 0;
+		EGLint config_attribs[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+		if ( !eglChooseConfig(display->egl_display, config_attribs, &config, 1, &config_count) || config_count < 1 ) {
+			fprintf(stderr, "EGL: no pbuffer config with OpenGL support found (error 0x%04x)\n", eglGetError());
+			return false;
+		}
+		display->egl_pbuffer = eglCreatePbufferSurface(display->egl_display, config, (EGLint[]){ EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE });
+	}
+	
+	display->egl_ctx = eglCreateContext(display->egl_display, config, EGL_NO_CONTEXT, (EGLint[]){
+		EGL_CONTEXT_MAJOR_VERSION, 4,
+		EGL_CONTEXT_MINOR_VERSION, 5,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	});
+	if ( display->egl_ctx == EGL_NO_CONTEXT || !eglMakeCurrent(display->egl_display, display->egl_pbuffer, display->egl_pbuffer, display->egl_ctx) ) {
+		fprintf(stderr, "EGL: failed to create OpenGL 4.5 core context (error 0x%04x)\n", eglGetError());
+		return false;
+	}
+	
+	fprintf(stderr, "EGL %d.%d, %s\n", major, minor, use_surfaceless ? "surfaceless" : "pbuffer");
+	gladLoadGL((GLADloadfunc)eglGetProcAddress);
+	return true;
+}
+#endif
+
+// Color formats of the offscreen framebuffer (--offscreen-format=)
+const struct { const char* name; GLenum format; } display_offscreen_formats[] = {
+	{ "rgba8",         GL_RGBA8         },
+	{ "srgb8_alpha8",  GL_SRGB8_ALPHA8  },
+	{ "rgba16f",       GL_RGBA16F       },
+	{ "rgb10_a2",      GL_RGB10_A2      },
+};
+
+/**
+ * Returns the format with the given name (e.g. "rgba16f") or 0 if there is none.
+ */
+GLenum display_parse_offscreen_format(const char* name) {
+	for (size_t i = 0; i < sizeof(display_offscreen_formats) / sizeof(display_offscreen_formats[0]); i++) {
+		if ( strcmp(display_offscreen_formats[i].name, name) == 0 )
+			return display_offscreen_formats[i].format;
+	}
+	return 0;
+}
+
+const char* display_offscreen_format_name(GLenum format) {
+	for (size_t i = 0; i < sizeof(display_offscreen_formats) / sizeof(display_offscreen_formats[0]); i++) {
+		if (display_offscreen_formats[i].format == format)
+			return display_offscreen_formats[i].name;
+	}
+	return "unknown";
+}
+
+bool display_allocate_offscreen_storage(display_t* display) {
+	GLint max_size = 0, max_samples = 0;
+	glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &max_size);
+	glGetIntegerv(GL_MAX_SAMPLES, &max_samples);
+	if (display->width > max_size || display->height > max_size) {
+		fprintf(stderr, "Offscreen framebuffer of %dx%d is larger than the max. renderbuffer size of %d\n", display->width, display->height, max_size);
+		return false;
+	}
+	if (display->msaa_samples > (uint32_t)max_samples) {
+		fprintf(stderr, "%ux MSAA not supported, max. %d samples\n", display->msaa_samples, max_samples);
+		return false;
+	}
+	
+	glNamedRenderbufferStorage(display->offscreen_color_rb, display->offscreen_format, display->width, display->height);
+	if (display->msaa_samples)
+		glNamedRenderbufferStorageMultisample(display->msaa_color_rb, display->msaa_samples, display->offscreen_format, display->width, display->height);
+	if ( glCheckNamedFramebufferStatus(display->offscreen_fbo, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE || (display->msaa_samples && glCheckNamedFramebufferStatus(display->msaa_fbo, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) ) {
+		fprintf(stderr, "Offscreen framebuffer of %dx%d %s incomplete\n", display->width, display->height, display_offscreen_format_name(display->offscreen_format));
+		return false;
+	}
+	glViewport(0, 0, display->width, display->height);  // There might be no surface that would have set the initial viewport
+	return true;
+}
+
+bool display_create_offscreen_fbo(display_t* display) {
+	// Everything is rendered into the offscreen FBO. It stays bound as draw and read framebuffer the whole time so the
+	// benchmarks don't need to know about it.
+	glCreateRenderbuffers(1, &display->offscreen_color_rb);
+	glCreateFramebuffers(1, &display->offscreen_fbo);
+	glNamedFramebufferRenderbuffer(display->offscreen_fbo, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, display->offscreen_color_rb);
+	// With MSAA the benchmarks draw into the multisampled FBO and display_present() resolves it into the offscreen FBO.
+	// Reading (captures, verification) still happens from the offscreen FBO.
+	if (display->msaa_samples) {
+		glCreateRenderbuffers(1, &display->msaa_color_rb);
+		glCreateFramebuffers(1, &display->msaa_fbo);
+		glNamedFramebufferRenderbuffer(display->msaa_fbo, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, display->msaa_color_rb);
+	}
+	if ( !display_allocate_offscreen_storage(display) )
+		return false;
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, display->msaa_samples ? display->msaa_fbo : display->offscreen_fbo);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, display->offscreen_fbo);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	
+	// Blending happens in linear space and the result is encoded when written, like with an sRGB swapchain. The images
+	// are therefore brighter than the ones of the other formats.
+	if (display->offscreen_format == GL_SRGB8_ALPHA8)
+		glEnable(GL_FRAMEBUFFER_SRGB);
+	
+	if (display->msaa_samples)
+		fprintf(stderr, "Offscreen framebuffer %dx%d %s with %ux MSAA\n", display->width, display->height, display_offscreen_format_name(display->offscreen_format), display->msaa_samples);
+	else
+		fprintf(stderr, "Offscreen framebuffer %dx%d %s\n", display->width, display->height, display_offscreen_format_name(display->offscreen_format));
+	return true;
+}
+
+/**
+ * Opens a window (SDL) or just an OpenGL context (EGL). With an offscreen_format everything is rendered into an
+ * offscreen framebuffer of that format and size instead of the window. Without one the SDL backend renders into the
+ * window and the EGL backend uses GL_RGBA8. msaa_samples > 0 renders into a multisampled framebuffer (offscreen only).
+ */
+bool display_open(display_t* display, display_backend_t backend, int width, int height, GLenum offscreen_format, uint32_t msaa_samples) {
+	*display = (display_t){ .backend = backend, .width = width, .height = height, .offscreen_format = offscreen_format ? offscreen_format : GL_RGBA8, .msaa_samples = msaa_samples };
+	
+	if (backend == DISPLAY_SDL) {
+		SDL_Init(SDL_INIT_VIDEO);
+		atexit(SDL_Quit);
+		
+		// Offscreen framebuffers can be larger than the screen, the window isn't used then anyway
+		int window_width = offscreen_format ? ((width < 1600) ? width : 1600) : width;
+		int window_height = offscreen_format ? ((height < 1000) ? height : 1000) : height;
+		display->sdl_window = SDL_CreateWindow("Rectangle rendering micro-benchmark", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, window_width, window_height, SDL_WINDOW_OPENGL);
+		
+		// Init OpenGL context (with vsync disabled)
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 5);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+		display->sdl_gl_ctx = SDL_GL_CreateContext(display->sdl_window);
+		SDL_GL_SetSwapInterval(0);
+		
+		gladLoadGL((GLADloadfunc)SDL_GL_GetProcAddress); // Expects a function that returns a function pointer, but SDL_GL_GetProcAddress() just returns a void pointer. Hence the cast.
+		return offscreen_format ? display_create_offscreen_fbo(display) : true;
+	}
+	
+	#ifdef _WIN32
+	fprintf(stderr, "The EGL backend is not supported on Windows\n");
+	return false;
+	#else
+	if ( !display_open_egl_context(display) )
+		return false;
+	
+	return display_create_offscreen_fbo(display);
+	#endif
+}
+
+void display_size(display_t* display, int* width, int* height) {
+	if (display->backend == DISPLAY_SDL && display->offscreen_fbo == 0) {
+		SDL_GetWindowSize(display->sdl_window, width, height);
+	} else {
+		*width  = display->width;
+		*height = display->height;
+	}
+}
+
+/**
+ * Changes the size of the offscreen framebuffer (the window stays as it is). Used by the --sweep-sizes= runs, only
+ * works when rendering offscreen.
+ */
+bool display_resize(display_t* display, int width, int height) {
+	if (display->offscreen_fbo == 0)
+		return false;
+	
+	display->width = width;
+	display->height = height;
+	return display_allocate_offscreen_storage(display);
+}
+
+void display_present(display_t* display) {
+	// The resolve is part of presenting a frame, like with a multisampled window
+	if (display->msaa_samples)
+		glBlitNamedFramebuffer(display->msaa_fbo, display->offscreen_fbo, 0, 0, display->width, display->height, 0, 0, display->width, display->height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	
+	if (display->backend == DISPLAY_SDL) {
+		SDL_GL_SwapWindow(display->sdl_window);
+	} else {
+		// Wait until the GPU finished the frame DISPLAY_FRAMES_IN_FLIGHT frames ago and then reuse its fence slot
+		GLsync* fence = &display->present_fences[display->present_fence_index];
+		if (*fence) {
+			glClientWaitSync(*fence, GL_SYNC_FLUSH_COMMANDS_BIT, UINT64_MAX);
+			glDeleteSync(*fence);
+		}
+		*fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		glFlush();
+		display->present_fence_index = (display->present_fence_index + 1) % DISPLAY_FRAMES_IN_FLIGHT;
+	}
+}
+
+/**
+ * Returns the buffer that contains the last presented frame. GL_FRONT for a window, for the offscreen FBO the
+ * color attachment since there is no front or back buffer.
+ */
+GLenum display_presented_buffer(display_t* display) {
+	return (display->offscreen_fbo == 0) ? GL_FRONT : GL_COLOR_ATTACHMENT0;
+}
+
+/**
+ * Returns the framebuffer object that contains the presented frames. 0 (the default framebuffer) for a window. With MSAA
+ * that's the framebuffer with the resolved frames, the benchmarks draw into the multisampled one.
+ */
+GLuint display_framebuffer(display_t* display) {
+	return display->offscreen_fbo;
+}
+
+void display_close(display_t* display) {
+	if (display->offscreen_fbo) {
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glDeleteFramebuffers(1, &display->offscreen_fbo);
+		glDeleteRenderbuffers(1, &display->offscreen_color_rb);
+	}
+	if (display->msaa_fbo) {
+		glDeleteFramebuffers(1, &display->msaa_fbo);
+		glDeleteRenderbuffers(1, &display->msaa_color_rb);
+	}
+	
+	if (display->backend == DISPLAY_SDL) {
+		SDL_GL_DeleteContext(display->sdl_gl_ctx);
+		SDL_DestroyWindow(display->sdl_window);
+		return;
+	}
+	
+	#ifndef _WIN32
+	for (uint32_t i = 0; i < DISPLAY_FRAMES_IN_FLIGHT; i++) {
+		if (display->present_fences[i])
+			glDeleteSync(display->present_fences[i]);
+	}
+	
+	eglMakeCurrent(display->egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	eglDestroyContext(display->egl_display, display->egl_ctx);
+	if (display->egl_pbuffer != EGL_NO_SURFACE)
+		eglDestroySurface(display->egl_display, display->egl_pbuffer);
+	eglTerminate(display->egl_display);
+	#endif
+}
+
 
 
 //
@@ -128,37 +904,72 @@ typedef struct {
 	uint32_t random;
 } rect_t;
 
+/**
+ * Sorted list of index ranges [begin, end) that don't overlap, e.g. the rects that changed in a frame. See
+ * dirty_spans_add().
+ */
+typedef struct { uint32_t begin, end; } dirty_span_t;
+typedef struct {
+	dirty_span_t* spans;
+	uint32_t count, capacity;
+} dirty_spans_t;
+
+/**
+ * Options of --animate=, see animation_next_frame(). Rates are per frame, fractions accumulate over the frames (e.g. an
+ * edit rate of 0.25 is one edit every 4th frame).
+ */
+typedef struct {
+	uint64_t seed;          // 1, the same seed always gives the same frames
+	float scroll_speed;     // Pixels the rects in the active range move each frame, the direction changes every 120 frames
+	float edit_rate;        // Glyph runs removed or inserted each frame
+	float color_rate;       // Fraction of the rects in the active range that get a new color each frame
+	float locality;         // Fraction of the rects (one consecutive range) that changes, 0 or 1 means the whole scene
+} animation_opts_t;
+
+typedef struct {
+	animation_opts_t opts;
+	rect_t* original_rects;  // Every approach starts with these rects
+	uint32_t original_count;
+	rect_t* rects;           // The approaches get this copy as args->rects_ptr
+	rectf_t* glyphs;         // Texture coords of the glyphs in the scene, inserted glyph runs use them
+	uint32_t glyph_count;
+	uint64_t state;
+	uint32_t frame_index, range_start, range_length;
+	float scroll_credit, edit_credit, color_credit;
+	dirty_spans_t changes;   // Rects changed by the last animation_next_frame()
+} animation_t;
+
 typedef struct {
 	uint32_t rects_count;
 	rect_t* rects_ptr;
 	uint32_t frame_count;
-	SDL_Window* window;
+	display_t* display;
 	GLuint glyph_texture, image_texture, texture_array;
+	animation_t* animation;  // NULL for static scenes
 } scenario_args_t;
 
+typedef enum { GENERATE_SIZES_UNIFORM = 0, GENERATE_SIZES_LOG_UNIFORM } generate_size_distribution_t;
+
+/**
+ * Options of generate_rects_random(). Zero values select the defaults mentioned in the comments, so
+ * (generate_rects_opts_t){ } gives 1000 plain rects.
+ */
 typedef struct {
+	uint32_t rects_count;                 // 1000
+	uint64_t seed;                        // 1, the same seed always gives the same rects
+	uint32_t area_width, area_height;     // 1600x1000, the rects are placed within that area
 	bool transparent_bg_color;
+	// Fractions of the rects (0..1) that are glyphs, textured (half image, half texture array), have a border or
+	// rounded corners. Glyphs are drawn in runs on top of the rect before them.
+	float glyph_ratio, texture_ratio, border_ratio, rounded_ratio;
+	// Width and height of the other rects are drawn independently from min_size to max_size (10 to 400)
+	generate_size_distribution_t size_distribution;
+	uint32_t min_size, max_size;
+	float overlap_depth;                  // When > 0 the rect sizes are scaled so each pixel is covered by that many rects on average
+	float clustering;                     // Fraction of the rects placed around cluster_count (8) points instead of everywhere
+	uint32_t cluster_count;
 } generate_rects_opts_t;
 
-void generate_rects_random(uint32_t new_rects_count, uint32_t* rects_count, rect_t** rects_ptr, generate_rects_opts_t opts) {
-	*rects_count = new_rects_count;
-	*rects_ptr = realloc(*rects_ptr, new_rects_count * sizeof((*rects_ptr)[0]));
-	
-	uint64_t state = 1;
-	for (uint32_t i = 0; i < *rects_count; i++) {
-		bool use_border = false, use_rounded_conrners = false, use_texture = false, use_texture_array = false;
-		
-		float x = rand_in(&state, 0, 900), y = rand_in(&state, 0, 600);
-		rect_t rect = (rect_t){
-			.pos = rectl( rand_in(&state, 0, 900), rand_in(&state, 0, 600), rand_in(&state, 10, 400), rand_in(&state, 10, 400) ),
-			.background_color = (color_t){ rand_in(&state, 0, 255), rand_in(&state, 0, 255), rand_in(&state, 0, 255), opts.transparent_bg_color ? rand_in(&state, 64, 255) : 255 },
-			.has_border = false
-		};
-		
-		(*rects_ptr)[i] = rect;
-	}
-}
-
 void generate_rects_sublime_sample(uint32_t* rects_count, rect_t** rects_ptr) {
 	// texture_index 0 is the glyph atlas
 	// texture_index 1 is the large image
@@ -195,14 +1006,600 @@ void generate_rects_mediaplayer_sample(uint32_t* rects_count, rect_t** rects_ptr
 	memcpy(*rects_ptr, dumped_rects, sizeof(dumped_rects));
 }
 
-void scenario_dump_stats(const char* name, scenario_args_t* args) {
-	uint64_t total_area = 0;
-	for (uint32_t i = 0; i < args->rects_count; i++)
-		total_area += rectl_width(args->rects_ptr[i].pos) * rectl_height(args->rects_ptr[i].pos);
+/**
+ * Synthetic scenes for scaling studies, see generate_rects_opts_t for the knobs. The glyphs are real glyphs of the atlas
+ * (taken from the sublime sample), textured rects use parts of the image or one of the icons in the texture array.
+ */
+void generate_rects_random(uint32_t* rects_count, rect_t** rects_ptr, generate_rects_opts_t opts) {
+	uint32_t count        = opts.rects_count   ? opts.rects_count   : 1000;
+	uint64_t state        = opts.seed          ? opts.seed          : 1;
+	int64_t area_width    = opts.area_width    ? opts.area_width    : 1600;
+	int64_t area_height   = opts.area_height   ? opts.area_height   : 1000;
+	uint32_t min_size     = opts.min_size      ? opts.min_size      : 10;
+	uint32_t max_size     = opts.max_size      ? opts.max_size      : 400;
+	uint32_t cluster_count = opts.cluster_count ? opts.cluster_count : 8;
+	if (max_size < min_size)
+		max_size = min_size;
+	
+	float rand_float() {
+		return rand_in(&state, 0, 1 << 24) / (float)(1 << 24);
+	}
+	color_t rand_color(uint8_t alpha) {
+		return (color_t){ rand_in(&state, 0, 256), rand_in(&state, 0, 256), rand_in(&state, 0, 256), alpha };
+	}
+	int64_t rand_size() {
+		if (opts.size_distribution == GENERATE_SIZES_LOG_UNIFORM)
+			return expf( logf(min_size) + rand_float() * (logf(max_size) - logf(min_size)) ) + 0.5f;
+		return min_size + rand_float() * (max_size - min_size) + 0.5f;
+	}
 	
-	fprintf(stdout, "scenario %s: %u rects, %.1lfpx avg area\n", name, args->rects_count, total_area / (double)args->rects_count);
-}
-
+	// Glyphs of the sublime sample (texture coordinates in the atlas), each one only once
+	uint32_t sample_count = 0, glyph_count = 0;
+	rect_t* samples = NULL;
+	generate_rects_sublime_sample(&sample_count, &samples);
+	rectf_t* glyphs = malloc(sample_count * sizeof(glyphs[0]));
+	for (uint32_t i = 0; i < sample_count; i++) {
+		if (!samples[i].has_glyph)
+			continue;
+		bool known = false;
+		for (uint32_t j = 0; j < glyph_count && !known; j++)
+			known = (memcmp(&glyphs[j], &samples[i].texture_coords, sizeof(rectf_t)) == 0);
+		if (!known)
+			glyphs[glyph_count++] = samples[i].texture_coords;
+	}
+	free(samples);
+	
+	// First the sizes and features of all rects that aren't glyphs. Needed upfront to scale them to the overlap depth.
+	uint32_t glyph_total = count * fminf(fmaxf(opts.glyph_ratio, 0), 1) + 0.5f;
+	uint32_t other_count = count - glyph_total;
+	rect_t* others = malloc(other_count * sizeof(others[0]));
+	double other_area = 0;
+	for (uint32_t i = 0; i < other_count; i++) {
+		rect_t rect = (rect_t){
+			.pos = rectl(0, 0, rand_size(), rand_size()),
+			.background_color = rand_color(opts.transparent_bg_color ? rand_in(&state, 64, 256) : 255)
+		};
+		if (rand_float() < opts.texture_ratio) {
+			rect.has_texture = true;
+			if (rand_in(&state, 0, 2) == 0) {
+				// Part of the image, scaled by up to 2 in each direction (the first 1280x1024 texels like in the mediaplayer sample)
+				float tex_width = fminf(rectl_width(rect.pos) * (0.5f + rand_float() * 1.5f), 1280), tex_height = fminf(rectl_height(rect.pos) * (0.5f + rand_float() * 1.5f), 1024);
+				rect.texture_index = 1;
+				rect.texture_coords = rectf(rand_float() * (1280 - tex_width), rand_float() * (1024 - tex_height), tex_width, tex_height);
+			} else {
+				rect.has_texture_array = true;
+				rect.texture_index = 12;
+				rect.texture_array_index = rand_in(&state, 0, 10);
+				rect.texture_coords = rectf(0, 0, 48, 48);
+			}
+		}
+		if (rand_float() < opts.border_ratio) {
+			rect.has_border = true;
+			rect.border_width = rand_in(&state, 1, 4);
+			rect.border_color = rand_color(255);
+		}
+		if (rand_float() < opts.rounded_ratio) {
+			rect.has_rounded_corners = true;
+			rect.corner_radius = rand_in(&state, 2, 17);
+		}
+		others[i] = rect;
+		other_area += rectl_width(rect.pos) * rectl_height(rect.pos);
+	}
+	
+	if (opts.overlap_depth > 0 && other_area > 0) {
+		float scale = sqrtf(opts.overlap_depth * area_width * area_height / other_area);
+		for (uint32_t i = 0; i < other_count; i++) {
+			int64_t width  = rectl_width(others[i].pos)  * scale + 0.5f, height = rectl_height(others[i].pos) * scale + 0.5f;
+			others[i].pos = rectl(0, 0, (width < 1) ? 1 : (width > area_width) ? area_width : width, (height < 1) ? 1 : (height > area_height) ? area_height : height);
+		}
+	}
+	// Rounded corners can't be larger than half the rect
+	for (uint32_t i = 0; i < other_count; i++) {
+		int64_t max_radius = ( (rectl_width(others[i].pos) < rectl_height(others[i].pos)) ? rectl_width(others[i].pos) : rectl_height(others[i].pos) ) / 2 - others[i].border_width;
+		if (others[i].corner_radius > max_radius)
+			others[i].corner_radius = (max_radius > 0) ? max_radius : 0;
+	}
+	
+	// Place a rect either uniformly in the area or around a cluster center (roughly normal distributed)
+	vecl_t cluster_centers[cluster_count];
+	for (uint32_t i = 0; i < cluster_count; i++)
+		cluster_centers[i] = vecl(rand_in(&state, 0, area_width), rand_in(&state, 0, area_height));
+	vecl_t place(int64_t width, int64_t height) {
+		int64_t x = 0, y = 0;
+		if (rand_float() < opts.clustering) {
+			vecl_t center = cluster_centers[rand_in(&state, 0, cluster_count)];
+			float spread_x = area_width / 8.0f, spread_y = area_height / 8.0f;
+			x = center.x + (rand_float() + rand_float() + rand_float() - 1.5f) * spread_x - width / 2;
+			y = center.y + (rand_float() + rand_float() + rand_float() - 1.5f) * spread_y - height / 2;
+		} else {
+			x = rand_float() * (area_width - width);
+			y = rand_float() * (area_height - height);
+		}
+		x = (x < 0) ? 0 : (x > area_width - width)   ? area_width - width   : x;
+		y = (y < 0) ? 0 : (y > area_height - height) ? area_height - height : y;
+		return vecl(x, y);
+	}
+	
+	*rects_count = count;
+	*rects_ptr = realloc(*rects_ptr, count * sizeof((*rects_ptr)[0]));
+	uint32_t rects_index = 0;
+	
+	// Glyphs are written as text into the box (line by line, wrapping at the right edge)
+	void emit_glyph_run(uint32_t run_length, rectl_t box) {
+		const int64_t line_height = 16;
+		color_t text_color = rand_color(255);
+		int64_t pen_x = box.l + 4, line_top = box.t + 4;
+		for (uint32_t i = 0; i < run_length; i++) {
+			rectf_t glyph = glyphs[rand_in(&state, 0, glyph_count)];
+			int64_t width = rectf_width(glyph), height = rectf_height(glyph);
+			if (pen_x + width > box.r - 4 && pen_x > box.l + 4) {
+				pen_x = box.l + 4;
+				line_top += line_height;
+			}
+			(*rects_ptr)[rects_index++] = (rect_t){
+				.pos = rectl(pen_x, line_top + ((height < line_height) ? line_height - height : 0), width, height),
+				.background_color = text_color,
+				.has_texture = true, .has_glyph = true, .texture_index = 0, .texture_coords = glyph
+			};
+			pen_x += width + 1;
+		}
+	}
+	
+	uint32_t glyphs_emitted = 0;
+	if (other_count == 0 && glyph_count > 0) {
+		while (glyphs_emitted < glyph_total) {
+			uint32_t run_length = rand_in(&state, 4, 41);
+			run_length = (run_length > glyph_total - glyphs_emitted) ? glyph_total - glyphs_emitted : run_length;
+			vecl_t pos = place(400, 64);
+			emit_glyph_run(run_length, rectl(pos.x, pos.y, 400, 64));
+			glyphs_emitted += run_length;
+		}
+	}
+	for (uint32_t i = 0; i < other_count; i++) {
+		rect_t rect = others[i];
+		vecl_t pos = place(rectl_width(rect.pos), rectl_height(rect.pos));
+		rect.pos = rectl(pos.x, pos.y, rectl_width(rect.pos), rectl_height(rect.pos));
+		(*rects_ptr)[rects_index++] = rect;
+		
+		// Spread the glyphs evenly over the other rects
+		uint32_t glyphs_due = (uint64_t)glyph_total * (i + 1) / other_count;
+		if (glyph_count > 0 && glyphs_due > glyphs_emitted) {
+			emit_glyph_run(glyphs_due - glyphs_emitted, rect.pos);
+			glyphs_emitted = glyphs_due;
+		}
+	}
+	// Without glyphs in the atlas the rest stays plain rects
+	while (rects_index < count)
+		(*rects_ptr)[rects_index++] = (rect_t){ .pos = rectl(0, 0, min_size, min_size), .background_color = rand_color(255) };
+	
+	free(others);
+	free(glyphs);
+}
+
+/**
+ * Parses a --synthetic= option like "name=text,count=100000,glyphs=0.8,sizes=log:8-200" into opts and the scenario name.
+ * Keys: name, count, seed, transparent (0 or 1), glyphs, textures, borders, rounded (ratios), sizes (uniform:min-max or
+ * log:min-max with 0 < min <= max), overlap, clustering and clusters. Returns false on errors.
+ */
+bool generate_rects_parse_opts(const char* spec, generate_rects_opts_t* opts, char** name) {
+	char* spec_copy = strdup(spec);
+	bool valid = true;
+	for (char* option = strtok(spec_copy, ","); option != NULL && valid; option = strtok(NULL, ",")) {
+		char* value = strchr(option, '=');
+		if (value == NULL) {
+			valid = false;
+			break;
+		}
+		*value++ = '\0';
+		
+		char distribution[16] = "";
+		if      ( strcmp(option, "name")        == 0 ) { free(*name); *name = strdup(value); }
+		else if ( strcmp(option, "count")       == 0 ) opts->rects_count = strtoul(value, NULL, 10);
+		else if ( strcmp(option, "seed")        == 0 ) opts->seed = strtoull(value, NULL, 10);
+		else if ( strcmp(option, "transparent") == 0 ) opts->transparent_bg_color = (strtoul(value, NULL, 10) != 0);
+		else if ( strcmp(option, "glyphs")      == 0 ) opts->glyph_ratio = strtof(value, NULL);
+		else if ( strcmp(option, "textures")    == 0 ) opts->texture_ratio = strtof(value, NULL);
+		else if ( strcmp(option, "borders")     == 0 ) opts->border_ratio = strtof(value, NULL);
+		else if ( strcmp(option, "rounded")     == 0 ) opts->rounded_ratio = strtof(value, NULL);
+		else if ( strcmp(option, "overlap")     == 0 ) opts->overlap_depth = strtof(value, NULL);
+		else if ( strcmp(option, "clustering")  == 0 ) opts->clustering = strtof(value, NULL);
+		else if ( strcmp(option, "clusters")    == 0 ) opts->cluster_count = strtoul(value, NULL, 10);
+		else if ( strcmp(option, "sizes")       == 0 && sscanf(value, "%15[a-z]:%u-%u", distribution, &opts->min_size, &opts->max_size) == 3 ) {
+			if      ( strcmp(distribution, "uniform") == 0 ) opts->size_distribution = GENERATE_SIZES_UNIFORM;
+			else if ( strcmp(distribution, "log")     == 0 ) opts->size_distribution = GENERATE_SIZES_LOG_UNIFORM;
+			else valid = false;
+			// The log distribution needs a positive range (a negative min wraps around and ends up above max)
+			if ( opts->size_distribution == GENERATE_SIZES_LOG_UNIFORM && (opts->min_size == 0 || opts->max_size < opts->min_size) )
+				valid = false;
+		}
+		else valid = false;
+	}
+	free(spec_copy);
+	return valid;
+}
+
+/**
+ * Fills rects_ptr with copies of the scene until it has rects_count rects (the last copy is cut short). Used for the
+ * --sweep-rects= runs of scenes that can't be generated with an arbitrary rect count. The copies are tiled over the
+ * area, once it's full further copies are drawn on top of the previous ones (shifted a few pixels).
+ */
+void generate_rects_replicated(uint32_t rects_count, rect_t** rects_ptr, const rect_t* scene_rects, uint32_t scene_count, int64_t area_width, int64_t area_height) {
+	*rects_ptr = realloc(*rects_ptr, rects_count * sizeof((*rects_ptr)[0]));
+	if (scene_count == 0)
+		return;
+	
+	int64_t scene_width = 1, scene_height = 1;
+	for (uint32_t i = 0; i < scene_count; i++) {
+		scene_width  = (scene_rects[i].pos.r > scene_width)  ? scene_rects[i].pos.r : scene_width;
+		scene_height = (scene_rects[i].pos.b > scene_height) ? scene_rects[i].pos.b : scene_height;
+	}
+	int64_t columns = (area_width  / scene_width  > 1) ? area_width  / scene_width  : 1;
+	int64_t rows    = (area_height / scene_height > 1) ? area_height / scene_height : 1;
+	
+	for (uint32_t i = 0; i < rects_count; i++) {
+		uint32_t copy = i / scene_count;
+		int64_t tile = copy % (columns * rows), layer = copy / (columns * rows);
+		int64_t offset_x = (tile % columns) * scene_width  + (layer * 4) % 32;
+		int64_t offset_y = (tile / columns) * scene_height + (layer * 4) % 32;
+		
+		rect_t rect = scene_rects[i % scene_count];
+		rect.pos = (rectl_t){ rect.pos.l + offset_x, rect.pos.t + offset_y, rect.pos.r + offset_x, rect.pos.b + offset_y };
+		(*rects_ptr)[i] = rect;
+	}
+}
+
+void scenario_dump_stats(const char* name, scenario_args_t* args) {
+	uint64_t total_area = 0;
+	uint32_t glyphs = 0, textured = 0, borders = 0, rounded = 0;
+	for (uint32_t i = 0; i < args->rects_count; i++) {
+		rect_t* rect = &args->rects_ptr[i];
+		total_area += rectl_width(rect->pos) * rectl_height(rect->pos);
+		glyphs   += rect->has_glyph;
+		textured += (rect->has_texture || rect->has_texture_array) && !rect->has_glyph;
+		borders  += rect->has_border;
+		rounded  += rect->has_rounded_corners;
+	}
+	
+	int width = 0, height = 0;
+	display_size(args->display, &width, &height);
+	fprintf(stdout, "scenario %s: %u rects, %.1lfpx avg area, %.2lf avg overlap depth, %u glyphs, %u textured, %u borders, %u rounded\n",
+		name, args->rects_count, total_area / (double)args->rects_count, total_area / ((double)width * height), glyphs, textured, borders, rounded);
+}
+
+//
+// Animated scenarios
+//
+// With --animate= the bench functions call animation_next_frame() before each frame and it changes the rects like a UI
+// would between frames: a consecutive range of rects scrolls, glyph runs are removed or new ones are typed in (both
+// move all rects after them in the array) and some rects change their color (hover highlights, blinking cursors). The
+// gen_buffers and upload phases of the approaches then have to deal with that churn. Changing the rects isn't part of
+// the measured frame time.
+//
+// Before each approach main() calls animation_reset() so all approaches start with the same rects and random state and
+// render the same frames (the verification still works). The rect count never grows beyond the count of the scene
+// since the approaches size their buffers before the frame loop.
+//
+// animation_next_frame() also records which rects it changed. The *_dirty approaches get them via animation_changes()
+// and only pack and upload those rects.
+//
+
+// Clean rects between two spans that are merged into one anyway. Packing and uploading a few rects more is cheaper
+// than another glNamedBufferSubData() or memcpy() call.
+#define DIRTY_SPANS_MAX_GAP 16
+
+/**
+ * Adds the range [begin, end) and merges it with the spans it overlaps or is at most DIRTY_SPANS_MAX_GAP away from.
+ */
+void dirty_spans_add(dirty_spans_t* list, uint32_t begin, uint32_t end) {
+	if (begin >= end)
+		return;
+	
+	// First span that ends close enough to begin (their ends are sorted as well since they don't overlap)
+	uint32_t first = 0, last = list->count;
+	while (first < last) {
+		uint32_t middle = first + (last - first) / 2;
+		if ((uint64_t)list->spans[middle].end + DIRTY_SPANS_MAX_GAP < begin)
+			first = middle + 1;
+		else
+			last = middle;
+	}
+	// All spans from first to last (exclusive) are merged with the new one
+	last = first;
+	while (last < list->count && list->spans[last].begin <= (uint64_t)end + DIRTY_SPANS_MAX_GAP)
+		last++;
+	
+	if (last > first) {
+		begin = (list->spans[first].begin < begin) ? list->spans[first].begin : begin;
+		end = (list->spans[last - 1].end > end) ? list->spans[last - 1].end : end;
+		memmove(&list->spans[first + 1], &list->spans[last], (list->count - last) * sizeof(list->spans[0]));
+		list->count -= last - first - 1;
+	} else {
+		if (list->count == list->capacity) {
+			list->capacity = (list->capacity == 0) ? 64 : list->capacity * 2;
+			list->spans = realloc(list->spans, list->capacity * sizeof(list->spans[0]));
+		}
+		memmove(&list->spans[first + 1], &list->spans[first], (list->count - first) * sizeof(list->spans[0]));
+		list->count++;
+	}
+	list->spans[first] = (dirty_span_t){ begin, end };
+}
+
+void dirty_spans_merge(dirty_spans_t* list, const dirty_spans_t* other) {
+	for (uint32_t i = 0; i < other->count; i++)
+		dirty_spans_add(list, other->spans[i].begin, other->spans[i].end);
+}
+
+void dirty_spans_clear(dirty_spans_t* list) {
+	list->count = 0;
+}
+
+void dirty_spans_destroy(dirty_spans_t* list) {
+	free(list->spans);
+	*list = (dirty_spans_t){ 0 };
+}
+
+
+/**
+ * Parses a --animate= option like "scroll=2,edits=0.5,colors=0.01,locality=0.1,seed=3" into opts. Returns false on
+ * errors.
+ */
+bool animation_parse_opts(const char* spec, animation_opts_t* opts) {
+	char* spec_copy = strdup(spec);
+	bool valid = true;
+	for (char* option = strtok(spec_copy, ","); option != NULL && valid; option = strtok(NULL, ",")) {
+		char* value = strchr(option, '=');
+		if (value == NULL) {
+			valid = false;
+			break;
+		}
+		*value++ = '\0';
+		
+		if      ( strcmp(option, "seed")     == 0 ) opts->seed = strtoull(value, NULL, 10);
+		else if ( strcmp(option, "scroll")   == 0 ) opts->scroll_speed = strtof(value, NULL);
+		else if ( strcmp(option, "edits")    == 0 ) opts->edit_rate = strtof(value, NULL);
+		else if ( strcmp(option, "colors")   == 0 ) opts->color_rate = strtof(value, NULL);
+		else if ( strcmp(option, "locality") == 0 ) opts->locality = strtof(value, NULL);
+		else valid = false;
+	}
+	free(spec_copy);
+	return valid;
+}
+
+void animation_init(animation_t* animation, const animation_opts_t* opts, const rect_t* rects, uint32_t rects_count) {
+	*animation = (animation_t){ .opts = *opts, .original_count = rects_count };
+	animation->original_rects = malloc(rects_count * sizeof(rects[0]));
+	animation->rects = malloc(rects_count * sizeof(rects[0]));
+	memcpy(animation->original_rects, rects, rects_count * sizeof(rects[0]));
+	
+	// Each glyph of the scene only once (up to 1024 of them, enough variety for new text)
+	const uint32_t max_glyphs = 1024;
+	animation->glyphs = malloc(max_glyphs * sizeof(animation->glyphs[0]));
+	for (uint32_t i = 0; i < rects_count && animation->glyph_count < max_glyphs; i++) {
+		if (!rects[i].has_glyph)
+			continue;
+		bool known = false;
+		for (uint32_t j = 0; j < animation->glyph_count && !known; j++)
+			known = (memcmp(&animation->glyphs[j], &rects[i].texture_coords, sizeof(rectf_t)) == 0);
+		if (!known)
+			animation->glyphs[animation->glyph_count++] = rects[i].texture_coords;
+	}
+	
+	float locality = (animation->opts.locality > 0 && animation->opts.locality < 1) ? animation->opts.locality : 1;
+	animation->range_length = rects_count * locality + 0.5f;
+	if (animation->range_length < 1)
+		animation->range_length = 1;
+}
+
+void animation_destroy(animation_t* animation) {
+	free(animation->original_rects);
+	free(animation->rects);
+	free(animation->glyphs);
+	dirty_spans_destroy(&animation->changes);
+	*animation = (animation_t){ 0 };
+}
+
+void animation_reset(animation_t* animation, scenario_args_t* args) {
+	memcpy(animation->rects, animation->original_rects, animation->original_count * sizeof(animation->rects[0]));
+	args->rects_ptr = animation->rects;
+	args->rects_count = animation->original_count;
+	
+	animation->state = animation->opts.seed ? animation->opts.seed : 1;
+	animation->frame_index = 0;
+	animation->scroll_credit = animation->edit_credit = animation->color_credit = 0;
+	dirty_spans_clear(&animation->changes);
+	animation->range_start = (animation->original_count > animation->range_length) ? rand_in(&animation->state, 0, animation->original_count - animation->range_length + 1) : 0;
+}
+
+void animation_next_frame(scenario_args_t* args) {
+	animation_t* animation = args->animation;
+	if (animation == NULL)
+		return;
+	
+	rect_t* rects = args->rects_ptr;
+	dirty_spans_clear(&animation->changes);
+	uint32_t range_start = (animation->range_start < args->rects_count) ? animation->range_start : 0;
+	uint32_t range_end = (range_start + animation->range_length < args->rects_count) ? range_start + animation->range_length : args->rects_count;
+	
+	// Scroll the range, a few frames down, then a few frames up
+	animation->scroll_credit += animation->opts.scroll_speed;
+	int64_t scroll = animation->scroll_credit;
+	animation->scroll_credit -= scroll;
+	if ((animation->frame_index / 120) % 2 == 1)
+		scroll = -scroll;
+	if (scroll != 0) {
+		for (uint32_t i = range_start; i < range_end; i++) {
+			rects[i].pos.t += scroll;
+			rects[i].pos.b += scroll;
+		}
+		dirty_spans_add(&animation->changes, range_start, range_end);
+	}
+	
+	// Remove a glyph run or type a new one in the line below it. Either way all following rects move in the array.
+	animation->edit_credit += animation->opts.edit_rate;
+	for (; animation->edit_credit >= 1 && range_end > range_start; animation->edit_credit -= 1) {
+		uint32_t run_start = range_start + rand_in(&animation->state, 0, range_end - range_start);
+		while (run_start < range_end && !rects[run_start].has_glyph)
+			run_start++;
+		if (run_start == range_end)
+			continue;
+		// The run is the glyphs of the same line around it (vertically overlapping ones), but only within the range
+		rectl_t line = rects[run_start].pos;
+		bool on_line(const rect_t* rect) {
+			return rect->has_glyph && rect->pos.t < line.b && rect->pos.b > line.t;
+		}
+		while (run_start > range_start && on_line(&rects[run_start - 1]))
+			run_start--;
+		uint32_t run_end = run_start;
+		int64_t line_bottom = line.b;
+		while (run_end < range_end && on_line(&rects[run_end])) {
+			line_bottom = (rects[run_end].pos.b > line_bottom) ? rects[run_end].pos.b : line_bottom;
+			run_end++;
+		}
+		
+		uint32_t free_rects = animation->original_count - args->rects_count;
+		if (free_rects == 0 || rand_in(&animation->state, 0, 2) == 0) {
+			memmove(&rects[run_start], &rects[run_end], (args->rects_count - run_end) * sizeof(rects[0]));
+			args->rects_count -= run_end - run_start;
+		} else {
+			uint32_t run_length = rand_in(&animation->state, 1, ((free_rects < 40) ? free_rects : 40) + 1);
+			memmove(&rects[run_end + run_length], &rects[run_end], (args->rects_count - run_end) * sizeof(rects[0]));
+			args->rects_count += run_length;
+			
+			const int64_t line_height = 16;
+			int64_t pen_x = rects[run_start].pos.l;
+			for (uint32_t i = run_end; i < run_end + run_length; i++) {
+				rectf_t glyph = animation->glyphs[rand_in(&animation->state, 0, animation->glyph_count)];
+				int64_t width = rectf_width(glyph), height = rectf_height(glyph);
+				rects[i] = rects[run_start];
+				rects[i].pos = rectl(pen_x, line_bottom + line_height - height, width, height);
+				rects[i].texture_coords = glyph;
+				pen_x += width + 1;
+			}
+		}
+		dirty_spans_add(&animation->changes, run_start, args->rects_count);
+		// Removals can shrink the rects below the range, the loop condition then stops the edits
+		range_end = (range_end < args->rects_count) ? range_end : args->rects_count;
+		range_start = (range_start < range_end) ? range_start : range_end;
+	}
+	
+	// New colors for a few rects, the alpha stays the same
+	if (range_end > range_start)
+		animation->color_credit += animation->opts.color_rate * (range_end - range_start);
+	for (; animation->color_credit >= 1 && range_end > range_start; animation->color_credit -= 1) {
+		uint32_t index = range_start + rand_in(&animation->state, 0, range_end - range_start);
+		rect_t* rect = &rects[index];
+		rect->background_color = (color_t){ rand_in(&animation->state, 0, 256), rand_in(&animation->state, 0, 256), rand_in(&animation->state, 0, 256), rect->background_color.a };
+		dirty_spans_add(&animation->changes, index, index + 1);
+	}
+	
+	animation->frame_index++;
+}
+
+/**
+ * Sets changes to the rects that changed since the previous frame of an approach. In the first frame (frame_index 0)
+ * that's all of them. Static scenes don't change after that.
+ */
+void animation_changes(scenario_args_t* args, uint32_t frame_index, dirty_spans_t* changes) {
+	dirty_spans_clear(changes);
+	if (frame_index == 0) {
+		dirty_spans_add(changes, 0, args->rects_count);
+	} else if (args->animation) {
+		// Spans recorded before an edit removed rects can reach beyond the current rect count
+		for (uint32_t i = 0; i < args->animation->changes.count; i++) {
+			dirty_span_t span = args->animation->changes.spans[i];
+			dirty_spans_add(changes, span.begin, (span.end < args->rects_count) ? span.end : args->rects_count);
+		}
+	}
+}
+
+/**
+ * Scene files (--scene=file) contain the rects of a scenario so new workloads don't need a recompile. They're mapped
+ * into memory and the rects are used right from the mapping (copy on write), nothing is parsed or copied.
+ * source/26-rects-to-scene.rb converts the dumps in 26-rects.c (or new ones in that format) into scene files.
+ *
+ * Layout of version 1, all values little endian:
+ *
+ *     offset  size
+ *          0     4  magic "26SC"
+ *          4     4  uint32_t version, 1
+ *          8     4  uint32_t header size, offset of the first rect (multiple of 8, 64 for now)
+ *         12     4  uint32_t rect size, 88
+ *         16     4  uint32_t rect count
+ *         20     8  uint32_t width and height of the window the rects were recorded in, 0 if unknown
+ *         28    36  reserved, 0
+ *
+ * Each rect has the in-memory layout of rect_t on x86-64 Linux and Windows (checked by the static asserts below):
+ *
+ *          0    32  int64_t pos l, t, r, b
+ *         32     4  uint8_t background_color r, g, b, a
+ *         36     5  uint8_t has_border, has_rounded_corners, has_texture, has_texture_array, has_glyph (0 or 1)
+ *         41     3  padding
+ *         44     4  float border_width
+ *         48     4  uint8_t border_color r, g, b, a
+ *         52     4  uint32_t corner_radius
+ *         56     4  uint32_t texture_index
+ *         60     4  uint32_t texture_array_index
+ *         64    16  float texture_coords l, t, r, b
+ *         80     4  uint32_t random
+ *         84     4  padding
+ */
+#define SCENE_VERSION 1
+typedef struct {
+	char     magic[4];
+	uint32_t version, header_size, rect_size, rect_count;
+	uint32_t recorded_width, recorded_height;
+	uint8_t  reserved[36];
+} scene_file_header_t;
+
+_Static_assert(sizeof(scene_file_header_t) == 64, "scene_file_header_t doesn't match the scene file layout");
+_Static_assert(sizeof(rect_t) == 88 && offsetof(rect_t, background_color) == 32 && offsetof(rect_t, has_border) == 36 &&
+	offsetof(rect_t, border_width) == 44 && offsetof(rect_t, texture_coords) == 64 && offsetof(rect_t, random) == 80,
+	"rect_t doesn't match the scene file layout");
+
+typedef struct {
+	rect_t*  rects;
+	uint32_t rects_count;
+	uint32_t recorded_width, recorded_height;
+	void*    mapping;
+	size_t   mapping_size;
+} scene_t;
+
+void scene_close(scene_t* scene) {
+	if (scene->mapping)
+		file_unmap(scene->mapping, scene->mapping_size);
+	*scene = (scene_t){ 0 };
+}
+
+bool scene_open(scene_t* scene, const char* filename) {
+	*scene = (scene_t){ 0 };
+	
+	scene->mapping = file_map(filename, &scene->mapping_size, "Scene");
+	if (scene->mapping == NULL)
+		return false;
+	
+	const char* error = NULL;
+	scene_file_header_t* header = scene->mapping;
+	if (scene->mapping_size < sizeof(scene_file_header_t) || memcmp(header->magic, "26SC", 4) != 0)
+		error = "not a scene file";
+	else if (header->version != SCENE_VERSION)
+		error = "unsupported version";
+	else if (header->rect_size != sizeof(rect_t) || header->header_size < sizeof(scene_file_header_t) || header->header_size % 8 != 0)
+		error = "unsupported header or rect size";
+	else if (header->header_size + (uint64_t)header->rect_count * header->rect_size > scene->mapping_size)
+		error = "file is truncated";
+	if (error) {
+		fprintf(stderr, "Scene: %s: %s\n", filename, error);
+		scene_close(scene);
+		return false;
+	}
+	
+	scene->rects = (rect_t*)((uint8_t*)scene->mapping + header->header_size);
+	scene->rects_count = header->rect_count;
+	scene->recorded_width = header->recorded_width;
+	scene->recorded_height = header->recorded_height;
+	return true;
+}
+
 
 
 //
@@ -211,30 +1608,100 @@ void scenario_dump_stats(const char* name, scenario_args_t* args) {
 // The reporting works with checkpoints and deltas (differences between various checkpoints).
 // The deltas also contain the OpenGL elapsed time query objects since the output from OpenGL already is a time delta.
 //
+// The query objects of the per-frame checkpoints and deltas exist once per frame in flight (a ring of query sets).
+// Their results are read a few frames later, as soon as GL_QUERY_RESULT_AVAILABLE says they're done. Only when a query
+// set is about to be reused and still not done we have to wait for it. So the GPU timers no longer serialize the CPU
+// and GPU each frame. The per-frame output and the GPU values in the sums lag behind by those few frames.
+//
 
 const char* report_current_scenario;
 const char* report_current_approach;
 
+#define REPORT_MAX_QUERY_LATENCY 8
+
+// CPU performance counters (Linux perf_event_open(), only with --perf-csv=file). They count the main thread only: not
+// the --gen-threads= workers of the gen buffers phase and not the threads of the OpenGL driver. When the kernel
+// multiplexes the counters with other events the counts are scaled up to the whole time, like perf stat does.
+typedef enum { RP_INSTRUCTIONS = 0, RP_CYCLES, RP_CACHE_MISSES, RP_BRANCH_MISSES, RP_CONTEXT_SWITCHES, RP_PAGE_FAULTS, RP_COUNT } report_perf_counter_index_t;
+
+// All times are in ns
 typedef struct {
-	usec_t   walltime, cpu_time;
-	GLuint   gpu_timestamp_id;
+	nsec_t   walltime, cpu_time;
+	GLuint   gpu_timestamp_ids[REPORT_MAX_QUERY_LATENCY];  // The approach checkpoints only use the first one
 	uint64_t gpu_timestamp_ns;
+	uint64_t perf_counters[RP_COUNT];
+	uint64_t perf_time_enabled, perf_time_running;
 } report_checkpoint_t;
 typedef struct {
-	usec_t   walltime, cpu_time;
-	GLuint   gpu_elapsed_timer_id;
+	nsec_t   walltime, cpu_time;
+	GLuint   gpu_elapsed_timer_ids[REPORT_MAX_QUERY_LATENCY];
 	uint64_t gpu_timestamp_ns, gpu_elapsed_time_ns;
+	uint64_t perf_counters[RP_COUNT];
+	bool     perf_missed;  // The counters weren't scheduled at all during the delta, so there's nothing to scale
 	
-	usec_t   accu_walltime, accu_cpu_time;
+	nsec_t   accu_walltime, accu_cpu_time;
 	uint64_t accu_gpu_timestamp_ns, accu_gpu_elapsed_time_ns;
+	uint64_t accu_perf_counters[RP_COUNT];
+	bool     accu_perf_missed;
 } report_delta_t;
 
 typedef enum { RC_APPROACH_START = 0, RC_FRAME_START, RC_GEN_BUFFERS_DONE, RC_UPLOAD_DONE, RC_CLEAR_DONE, RC_DRAW_DONE, RC_FRAME_END, RC_APPROACH_END } report_checkpoint_index_t;
-typedef enum { RD_NONE = -1, RD_APPROACH = 0, RD_FRAME, RD_GEN_BUFFERS, RD_UPLOAD, RD_CLEAR, RD_DRAW, RD_PRESENT } report_delta_index_t;
+// RD_FENCE_WAIT isn't between two checkpoints. It's the time spent in glClientWaitSync() for upload buffers during a
+// frame (see report_fence_wait_start() and report_fence_wait_done()), without GPU timers or perf counters.
+typedef enum { RD_NONE = -1, RD_APPROACH = 0, RD_FRAME, RD_GEN_BUFFERS, RD_UPLOAD, RD_CLEAR, RD_DRAW, RD_PRESENT, RD_FENCE_WAIT } report_delta_index_t;
 
 report_checkpoint_t report_checkpoints[8];
-report_delta_t      report_deltas[7];
-usec_t report_last_frame_start_walltime, report_accu_dt_us;
+report_delta_t      report_deltas[8];
+nsec_t              report_fence_wait_start_walltime, report_fence_wait_start_cpu_time;
+nsec_t report_last_frame_start_walltime, report_accu_dt_ns;
+// Bytes the approach passed to buffer (or texture) uploads in the current frame and summed up over the measured frames,
+// see report_upload_bytes()
+uint64_t report_frame_upload_bytes, report_accu_upload_bytes;
+
+// Deltas of every measured (non warm-up) frame of the current approach, used to calculate the statistics at the end
+typedef struct {
+	struct {
+		nsec_t   walltime, cpu_time;
+		uint64_t gpu_timestamp_ns, gpu_elapsed_time_ns;
+	} deltas[8];
+	nsec_t dt;
+	uint64_t upload_bytes;
+} report_frame_sample_t;
+
+report_frame_sample_t* report_frame_samples;
+uint32_t               report_frame_samples_capacity;
+
+// Binary per-frame log (--frame-log=file). Instead of a fprintf() in the middle of the measured frames the records go
+// into a preallocated single producer single consumer ring. A writer thread drains it into the file, so the
+// measurement loop itself does no formatting and no I/O. results/frame-log-to-csv.rb converts the file into the
+// bench-frames.csv layout.
+//
+// File layout (native byte order, little endian on all platforms we run on): "26FL" magic, uint32_t version,
+// uint32_t record size, then records. Each record starts with uint32_t type and frame. For REPORT_LOG_APPROACH
+// records the 0-terminated scenario name (32 bytes) and approach name (64 bytes) follow. For REPORT_LOG_FRAME records
+// a report_frame_sample_t follows (8 times int64_t walltime, cpu_time and uint64_t gpu_timestamp_ns,
+// gpu_elapsed_time_ns in report_delta_index_t order, then int64_t dt, all in ns, and uint64_t upload_bytes).
+#define REPORT_LOG_VERSION   3  // Version 1 had no RD_FENCE_WAIT delta, version 2 no upload_bytes
+#define REPORT_LOG_RING_SIZE 4096  // Records, has to be a power of two
+typedef enum { REPORT_LOG_APPROACH = 1, REPORT_LOG_FRAME = 2 } report_log_record_type_t;
+typedef struct {
+	uint32_t type, frame;
+	union {
+		struct { char scenario[32], approach[64]; } names;
+		report_frame_sample_t sample;
+	} data;
+} report_log_record_t;
+
+report_log_record_t* report_log_ring;
+uint32_t             report_log_write_index, report_log_read_index;  // Only accessed via __atomic builtins
+bool                 report_log_stop;
+uint32_t             report_log_full_waits;
+pthread_t            report_log_thread;
+
+// Query set used by the current frame and the frame that still waits for the results of each query set. That's the
+// number of the frame within report_frame_samples (1 based), 0 if nothing is pending.
+uint32_t report_query_set;
+uint32_t report_query_set_pending_frame[REPORT_MAX_QUERY_LATENCY];
 
 uint32_t report_counter;
 uint32_t reported_frame_count;
@@ -244,19 +1711,188 @@ uint32_t report_prev_checkpoint_index;
 bool reporting_output_csv_headers = true;
 bool reporting_capture_last_frames = false;
 bool reporting_query_timers = true;
+bool reporting_use_tsc = false;  // Read the walltime via RDTSC instead of clock_gettime(), set only when calibrated
+uint32_t reporting_query_latency = 4;  // Number of query sets, 1 waits for the timers at the end of each frame
 bool reporting_output_per_frame_data = true;
+GLenum reporting_capture_buffer = GL_FRONT;
+FILE* reporting_frame_log_file = NULL;
+FILE* reporting_perf_file = NULL;
+
+// All counters are in one perf event group so one read() at each checkpoint gets all of them. Counters the kernel
+// doesn't allow us to open (perf_event_paranoid, no PMU in a VM, Windows) are left out and reported as "n/a".
+int      report_perf_fds[RP_COUNT];
+int      report_perf_group_fd = -1;
+uint32_t report_perf_group_size;
+uint32_t report_perf_group_index[RP_COUNT];
+bool     report_perf_available[RP_COUNT];
+uint32_t reporting_warmup_frames = 0;
+FILE* reporting_stats_file = NULL;
+FILE* reporting_sweep_file = NULL;
+FILE* reporting_programs_file = NULL;
+
+// Shader programs loaded since the last report_approach_start(). They're loaded during the setup of an approach, so
+// their times are written with the name of the approach that starts next.
+typedef struct {
+	uint64_t    key;
+	const char* cache;  // "off", "miss" or "hit"
+	nsec_t      compile_ns, link_ns, binary_ns;
+} report_program_t;
+report_program_t* report_programs;
+uint32_t report_programs_count, report_programs_capacity;
+// Totals of the whole run for the summary at the end
+uint32_t report_programs_total, report_programs_cache_hits;
+nsec_t   report_programs_compile_ns, report_programs_link_ns, report_programs_binary_ns;
+
+// Sweep point (--sweep-rects=, --sweep-sizes= and --gen-threads=) the following approaches run at, see report_sweep_point()
+uint32_t report_sweep_rects_count;
+int      report_sweep_width, report_sweep_height;
+uint32_t report_sweep_gen_threads;
+
+void report_perf_setup() {
+	for (uint32_t i = 0; i < RP_COUNT; i++) {
+		report_perf_fds[i] = -1;
+		report_perf_available[i] = false;
+	}
+	report_perf_group_fd = -1;
+	report_perf_group_size = 0;
+	
+#ifdef __linux__
+	const struct { uint32_t type; uint64_t config; const char* name; } events[RP_COUNT] = {
+		[RP_INSTRUCTIONS]     = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS,     "instructions"     },
+		[RP_CYCLES]           = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES,       "cycles"           },
+		[RP_CACHE_MISSES]     = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES,     "cache misses"     },
+		[RP_BRANCH_MISSES]    = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES,    "branch misses"    },
+		[RP_CONTEXT_SWITCHES] = { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, "context switches" },
+		[RP_PAGE_FAULTS]      = { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS,      "page faults"      },
+	};
+	for (uint32_t i = 0; i < RP_COUNT; i++) {
+		struct perf_event_attr attr = (struct perf_event_attr){
+			.type = events[i].type, .size = sizeof(attr), .config = events[i].config,
+			.disabled = (report_perf_group_fd == -1), .exclude_hv = 1,
+			.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING
+		};
+		// Try to include the time spent in the kernel first (e.g. in the driver), with perf_event_paranoid >= 2 we're
+		// only allowed to count user space.
+		int fd = syscall(SYS_perf_event_open, &attr, 0, -1, report_perf_group_fd, 0);
+		if (fd == -1) {
+			attr.exclude_kernel = 1;
+			fd = syscall(SYS_perf_event_open, &attr, 0, -1, report_perf_group_fd, 0);
+		}
+		if (fd == -1) {
+			fprintf(stderr, "Can't count %s via perf_event_open(), reporting n/a: %s\n", events[i].name, strerror(errno));
+			continue;
+		}
+		
+		if (report_perf_group_fd == -1)
+			report_perf_group_fd = fd;
+		report_perf_fds[i] = fd;
+		report_perf_group_index[i] = report_perf_group_size++;
+		report_perf_available[i] = true;
+	}
+	
+	if (report_perf_group_fd != -1) {
+		ioctl(report_perf_group_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(report_perf_group_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+#else
+	fprintf(stderr, "CPU performance counters are only supported on Linux, reporting n/a\n");
+#endif
+}
+
+void report_perf_cleanup() {
+	for (uint32_t i = 0; i < RP_COUNT; i++) {
+		if (report_perf_fds[i] != -1)
+			close(report_perf_fds[i]);
+		report_perf_fds[i] = -1;
+	}
+	report_perf_group_fd = -1;
+}
+
+void report_perf_read(report_checkpoint_t* checkpoint) {
+	if (report_perf_group_fd == -1)
+		return;
+	
+	// PERF_FORMAT_GROUP layout: number of counters, the time the group was enabled and the time it actually ran (less
+	// when multiplexed), followed by the value of each counter in the order they were opened
+	uint64_t buffer[3 + RP_COUNT];
+	if ( read(report_perf_group_fd, buffer, sizeof(buffer)) < (ssize_t)((3 + report_perf_group_size) * sizeof(uint64_t)) )
+		return;
+	checkpoint->perf_time_enabled = buffer[1];
+	checkpoint->perf_time_running = buffer[2];
+	for (uint32_t i = 0; i < RP_COUNT; i++) {
+		if (report_perf_available[i])
+			checkpoint->perf_counters[i] = buffer[3 + report_perf_group_index[i]];
+	}
+}
+
+void* report_log_writer_thread(void* arg) {
+	while (true) {
+		uint32_t read_index = __atomic_load_n(&report_log_read_index, __ATOMIC_RELAXED);
+		uint32_t write_index = __atomic_load_n(&report_log_write_index, __ATOMIC_ACQUIRE);
+		if (read_index == write_index) {
+			// Check the write index again after we saw the stop flag, the last records might have arrived in between
+			if ( __atomic_load_n(&report_log_stop, __ATOMIC_ACQUIRE) && read_index == __atomic_load_n(&report_log_write_index, __ATOMIC_ACQUIRE) )
+				break;
+			usleep(1000);
+			continue;
+		}
+		
+		// Write everything up to the end of the ring in one go, the rest in the next iteration
+		uint32_t first = read_index % REPORT_LOG_RING_SIZE;
+		uint32_t count = write_index - read_index;
+		if (first + count > REPORT_LOG_RING_SIZE)
+			count = REPORT_LOG_RING_SIZE - first;
+		fwrite(&report_log_ring[first], sizeof(report_log_ring[0]), count, reporting_frame_log_file);
+		__atomic_store_n(&report_log_read_index, read_index + count, __ATOMIC_RELEASE);
+	}
+	
+	fflush(reporting_frame_log_file);
+	return NULL;
+}
+
+void report_log_push(const report_log_record_t* record) {
+	uint32_t write_index = __atomic_load_n(&report_log_write_index, __ATOMIC_RELAXED);
+	// Only happens when the writer thread can't keep up. Counted so we know when the results are affected by it.
+	while (write_index - __atomic_load_n(&report_log_read_index, __ATOMIC_ACQUIRE) >= REPORT_LOG_RING_SIZE) {
+		report_log_full_waits++;
+		sched_yield();
+	}
+	
+	report_log_ring[write_index % REPORT_LOG_RING_SIZE] = *record;
+	__atomic_store_n(&report_log_write_index, write_index + 1, __ATOMIC_RELEASE);
+}
 
 void reporting_setup() {
 	report_counter = 0;
 	
 	// Setup OpenGL timers
 	for (uint32_t i = 0; i < sizeof(report_checkpoints) / sizeof(report_checkpoints[0]); i++)
-		glCreateQueries(GL_TIMESTAMP, 1, &report_checkpoints[i].gpu_timestamp_id);
+		glCreateQueries(GL_TIMESTAMP, REPORT_MAX_QUERY_LATENCY, report_checkpoints[i].gpu_timestamp_ids);
 	for (uint32_t i = 0; i < sizeof(report_deltas) / sizeof(report_deltas[0]); i++)
-		glCreateQueries(GL_TIME_ELAPSED, 1, &report_deltas[i].gpu_elapsed_timer_id);
+		glCreateQueries(GL_TIME_ELAPSED, REPORT_MAX_QUERY_LATENCY, report_deltas[i].gpu_elapsed_timer_ids);
+	
+	// Start the writer thread of the binary per-frame log
+	if (reporting_frame_log_file) {
+		report_log_ring = malloc(REPORT_LOG_RING_SIZE * sizeof(report_log_ring[0]));
+		report_log_write_index = 0;
+		report_log_read_index = 0;
+		report_log_stop = false;
+		report_log_full_waits = 0;
+		
+		fwrite("26FL", 4, 1, reporting_frame_log_file);
+		fwrite(&(uint32_t){ REPORT_LOG_VERSION }, sizeof(uint32_t), 1, reporting_frame_log_file);
+		fwrite(&(uint32_t){ sizeof(report_log_record_t) }, sizeof(uint32_t), 1, reporting_frame_log_file);
+		pthread_create(&report_log_thread, NULL, report_log_writer_thread, NULL);
+	}
+	
+	if (reporting_perf_file) {
+		report_perf_setup();
+		if (reporting_output_csv_headers)
+			fprintf(reporting_perf_file, "scenario        , approach                  , phase    ,   instructions ,         cycles ,   cache_misses ,  branch_misses ,   ctx_switches ,    page_faults\n");
+	}
 	
 	// Per-frame log header (per-frame data send to stderr)
-	if (reporting_output_per_frame_data && reporting_output_csv_headers) {
+	if (reporting_output_per_frame_data && reporting_output_csv_headers && !reporting_frame_log_file) {
 		fprintf(stderr,
 			"scenario        , approach                  , frame ,"
 			"   frame_wt ,   frame_ct ,   frame_gt ,         dt ,"
@@ -264,7 +1900,8 @@ void reporting_setup() {
 			"  upload_wt ,  upload_ct ,  upload_gt ,  upload_ge ,"
 			"   clear_wt ,   clear_ct ,   clear_gt ,   clear_ge ,"
 			"    draw_wt ,    draw_ct ,    draw_gt ,    draw_ge ,"
-			"    pres_wt ,    pres_ct ,    pres_gt ,    pres_ge\n"
+			"    pres_wt ,    pres_ct ,    pres_gt ,    pres_ge ,"
+			"   fence_wt ,   fence_ct , upload_bytes\n"
 		);
 	}
 	
@@ -272,22 +1909,74 @@ void reporting_setup() {
 	if (reporting_output_csv_headers) {
 		fprintf(stdout,
 			"scenario        , approach                  ,"
-			" approach_wt, approach_ct, approach_gt,"
-			"   frame_wt ,   frame_ct ,   frame_gt ,         dt ,"
-			"  buffer_wt ,  buffer_ct ,  buffer_gt ,  buffer_ge ,"
-			"  upload_wt ,  upload_ct ,  upload_gt ,  upload_ge ,"
-			"   clear_wt ,   clear_ct ,   clear_gt ,   clear_ge ,"
-			"    draw_wt ,    draw_ct ,    draw_gt ,    draw_ge ,"
-			"    pres_wt ,    pres_ct ,    pres_gt ,    pres_ge\n"
+			"   approach_wt ,   approach_ct ,   approach_gt ,"
+			"      frame_wt ,      frame_ct ,      frame_gt ,            dt ,"
+			"     buffer_wt ,     buffer_ct ,     buffer_gt ,     buffer_ge ,"
+			"     upload_wt ,     upload_ct ,     upload_gt ,     upload_ge ,"
+			"      clear_wt ,      clear_ct ,      clear_gt ,      clear_ge ,"
+			"       draw_wt ,       draw_ct ,       draw_gt ,       draw_ge ,"
+			"       pres_wt ,       pres_ct ,       pres_gt ,       pres_ge ,"
+			"      fence_wt ,      fence_ct ,   upload_bytes\n"
+		);
+	}
+	
+	// Header of the per-approach statistics (only written when a stats file was given)
+	if (reporting_stats_file && reporting_output_csv_headers) {
+		fprintf(reporting_stats_file,
+			"scenario        , approach                  , phase  , metric , frames ,"
+			"           min ,        median ,           p95 ,           p99 ,           max ,"
+			"  median_ci_lo ,  median_ci_hi\n"
+		);
+	}
+	
+	// Header of the scaling data (only written when a sweep file was given)
+	if (reporting_sweep_file && reporting_output_csv_headers) {
+		fprintf(reporting_sweep_file,
+			"scenario        , approach                  ,      rects ,  width , height , phase  , metric ,"
+			"        median ,      per_rect ,       per_mpx , threads\n"
+		);
+	}
+	
+	// Header of the shader program load times (only written when a program file was given)
+	if (reporting_programs_file && reporting_output_csv_headers) {
+		fprintf(reporting_programs_file,
+			"scenario        , approach                  , program          , cache ,"
+			"       compile ,          link ,   binary_load ,         total\n"
 		);
 	}
 }
 
 void reporting_cleanup() {
+	if (report_programs_total > 0) {
+		fprintf(stderr, "Shader programs: %u loaded, %u from the program cache, %.1lfms compile, %.1lfms link, %.1lfms binary load\n",
+			report_programs_total, report_programs_cache_hits,
+			report_programs_compile_ns / 1000000.0, report_programs_link_ns / 1000000.0, report_programs_binary_ns / 1000000.0
+		);
+	}
+	free(report_programs);
+	report_programs = NULL;
+	report_programs_count = report_programs_capacity = 0;
+	
 	for (uint32_t i = 0; i < sizeof(report_checkpoints) / sizeof(report_checkpoints[0]); i++)
-		glDeleteQueries(1, &report_checkpoints[i].gpu_timestamp_id);
+		glDeleteQueries(REPORT_MAX_QUERY_LATENCY, report_checkpoints[i].gpu_timestamp_ids);
 	for (uint32_t i = 0; i < sizeof(report_deltas) / sizeof(report_deltas[0]); i++)
-		glDeleteQueries(1, &report_deltas[i].gpu_elapsed_timer_id);
+		glDeleteQueries(REPORT_MAX_QUERY_LATENCY, report_deltas[i].gpu_elapsed_timer_ids);
+	
+	free(report_frame_samples);
+	report_frame_samples = NULL;
+	report_frame_samples_capacity = 0;
+	
+	if (reporting_perf_file)
+		report_perf_cleanup();
+	
+	if (reporting_frame_log_file) {
+		__atomic_store_n(&report_log_stop, true, __ATOMIC_RELEASE);
+		pthread_join(report_log_thread, NULL);
+		free(report_log_ring);
+		report_log_ring = NULL;
+		if (report_log_full_waits > 0)
+			fprintf(stderr, "Frame log ring was full %u times, the writer thread couldn't keep up\n", report_log_full_waits);
+	}
 }
 
 
@@ -296,6 +1985,10 @@ void report_reset_checkpoints_and_deltas() {
 		report_checkpoints[i].walltime         = 0;
 		report_checkpoints[i].cpu_time         = 0;
 		report_checkpoints[i].gpu_timestamp_ns = 0;
+		for (uint32_t j = 0; j < RP_COUNT; j++)
+			report_checkpoints[i].perf_counters[j] = 0;
+		report_checkpoints[i].perf_time_enabled = 0;
+		report_checkpoints[i].perf_time_running = 0;
 	}
 	for (uint32_t i = 0; i < sizeof(report_deltas) / sizeof(report_deltas[0]); i++) {
 		report_deltas[i].walltime                 = 0;
@@ -306,9 +1999,19 @@ void report_reset_checkpoints_and_deltas() {
 		report_deltas[i].accu_cpu_time            = 0;
 		report_deltas[i].accu_gpu_timestamp_ns    = 0;
 		report_deltas[i].accu_gpu_elapsed_time_ns = 0;
+		for (uint32_t j = 0; j < RP_COUNT; j++) {
+			report_deltas[i].perf_counters[j]      = 0;
+			report_deltas[i].accu_perf_counters[j] = 0;
+		}
+		report_deltas[i].perf_missed      = false;
+		report_deltas[i].accu_perf_missed = false;
 	}
 }
 
+nsec_t report_walltime_now() {
+	return reporting_use_tsc ? time_tsc_now_ns() : time_now_ns();
+}
+
 void report_trigger_checkpoint_and_elapsed_timer(report_checkpoint_index_t checkpoint, report_delta_index_t delta_with_gpu_elapsed_timer) {
 	// Make sure we don't accidentially skip a checkpoint
 	assert(checkpoint == report_prev_checkpoint_index + 1);
@@ -319,48 +2022,203 @@ void report_trigger_checkpoint_and_elapsed_timer(report_checkpoint_index_t check
 		report_elapsed_timer_running = false;
 	}
 	
-	glQueryCounter(report_checkpoints[checkpoint].gpu_timestamp_id, GL_TIMESTAMP);
-	report_checkpoints[checkpoint].walltime = time_now();
-	report_checkpoints[checkpoint].cpu_time = time_process_cpu_time();
+	uint32_t query_set = (checkpoint == RC_APPROACH_START || checkpoint == RC_APPROACH_END) ? 0 : report_query_set;
+	glQueryCounter(report_checkpoints[checkpoint].gpu_timestamp_ids[query_set], GL_TIMESTAMP);
+	report_checkpoints[checkpoint].walltime = report_walltime_now();
+	report_checkpoints[checkpoint].cpu_time = time_process_cpu_time_ns();
+	report_perf_read(&report_checkpoints[checkpoint]);
 	
 	if (delta_with_gpu_elapsed_timer != RD_NONE) {
-		glBeginQuery(GL_TIME_ELAPSED, report_deltas[delta_with_gpu_elapsed_timer].gpu_elapsed_timer_id);
+		glBeginQuery(GL_TIME_ELAPSED, report_deltas[delta_with_gpu_elapsed_timer].gpu_elapsed_timer_ids[report_query_set]);
 		report_elapsed_timer_running = true;
 	}
 }
 
-void report_query_checkpoints_and_delta_elapsed_timers() {
-	for (uint32_t i = 0; i < sizeof(report_checkpoints) / sizeof(report_checkpoints[0]); i++)
-		glGetQueryObjectui64v(report_checkpoints[i].gpu_timestamp_id, GL_QUERY_RESULT, &report_checkpoints[i].gpu_timestamp_ns);
-	for (uint32_t i = 0; i < sizeof(report_deltas) / sizeof(report_deltas[0]); i++)
-		glGetQueryObjectui64v(report_deltas[i].gpu_elapsed_timer_id, GL_QUERY_RESULT, &report_deltas[i].gpu_elapsed_time_ns);
+void report_update_delta(report_delta_index_t delta, report_checkpoint_index_t from, report_checkpoint_index_t to) {
+	report_deltas[delta].walltime = report_checkpoints[to].walltime - report_checkpoints[from].walltime;
+	report_deltas[delta].cpu_time = report_checkpoints[to].cpu_time - report_checkpoints[from].cpu_time;
+	
+	report_deltas[delta].accu_walltime += report_deltas[delta].walltime;
+	report_deltas[delta].accu_cpu_time += report_deltas[delta].cpu_time;
+	
+	// Scale the counts up to the whole time when the counters only ran for part of the delta (multiplexed)
+	uint64_t perf_enabled = report_checkpoints[to].perf_time_enabled - report_checkpoints[from].perf_time_enabled;
+	uint64_t perf_running = report_checkpoints[to].perf_time_running - report_checkpoints[from].perf_time_running;
+	report_deltas[delta].perf_missed = (perf_running == 0 && perf_enabled > 0);
+	report_deltas[delta].accu_perf_missed = report_deltas[delta].accu_perf_missed || report_deltas[delta].perf_missed;
+	for (uint32_t i = 0; i < RP_COUNT; i++) {
+		uint64_t count = report_checkpoints[to].perf_counters[i] - report_checkpoints[from].perf_counters[i];
+		if (perf_running > 0 && perf_running < perf_enabled)
+			count = (double)count * perf_enabled / perf_running + 0.5;
+		report_deltas[delta].perf_counters[i] = count;
+		report_deltas[delta].accu_perf_counters[i] += count;
+	}
 }
 
-void report_update_delta(report_delta_index_t delta, report_checkpoint_index_t from, report_checkpoint_index_t to) {
-	report_deltas[delta].walltime         = report_checkpoints[to].walltime         - report_checkpoints[from].walltime;
-	report_deltas[delta].cpu_time         = report_checkpoints[to].cpu_time         - report_checkpoints[from].cpu_time;
-	report_deltas[delta].gpu_timestamp_ns = report_checkpoints[to].gpu_timestamp_ns - report_checkpoints[from].gpu_timestamp_ns;
-	// accu_gpu_elapsed_time_ns is already a delta between glBeginQuery() and glEndQuery() calls. No need to calculate anything.
+void report_output_frame(uint32_t frame) {
+	if (!reporting_output_per_frame_data)
+		return;
+	
+	report_frame_sample_t* sample = &report_frame_samples[frame - 1];
+	if (reporting_frame_log_file) {
+		report_log_push(&(report_log_record_t){ .type = REPORT_LOG_FRAME, .frame = frame, .data.sample = *sample });
+		return;
+	}
+	
+	// Per-frame log header (duplicated here for reference)
+	//fprintf(stderr,
+	//	"scenario        , approach                  , frame ,"
+	//	"   frame_wt ,   frame_ct ,   frame_gt ,         dt ,"
+	//	"  buffer_wt ,  buffer_ct ,  buffer_gt ,  buffer_ge ,"
+	//	"  upload_wt ,  upload_ct ,  upload_gt ,  upload_ge ,"
+	//	"   clear_wt ,   clear_ct ,   clear_gt ,   clear_ge ,"
+	//	"    draw_wt ,    draw_ct ,    draw_gt ,    draw_ge ,"
+	//	"    pres_wt ,    pres_ct ,    pres_gt ,    pres_ge ,"
+	//	"   fence_wt ,   fence_ct , upload_bytes\n"
+	//);
+	fprintf(stderr,
+		"%-15s , %-25s , %5u ,"
+		" %8.3lfus , %8.3lfus , %8.3lfus , %8.3lfus ,"
+		" %8.3lfus , %8.3lfus , %8.3lfus , %8.3lfus ,"
+		" %8.3lfus , %8.3lfus , %8.3lfus , %8.3lfus ,"
+		" %8.3lfus , %8.3lfus , %8.3lfus , %8.3lfus ,"
+		" %8.3lfus , %8.3lfus , %8.3lfus , %8.3lfus ,"
+		" %8.3lfus , %8.3lfus , %8.3lfus , %8.3lfus ,"
+		" %8.3lfus , %8.3lfus , %12"PRIu64"\n",
+		report_current_scenario, report_current_approach, frame,
+		sample->deltas[RD_FRAME      ].walltime / 1000.0, sample->deltas[RD_FRAME      ].cpu_time / 1000.0, sample->deltas[RD_FRAME      ].gpu_timestamp_ns / 1000.0, sample->dt / 1000.0,
+		sample->deltas[RD_GEN_BUFFERS].walltime / 1000.0, sample->deltas[RD_GEN_BUFFERS].cpu_time / 1000.0, sample->deltas[RD_GEN_BUFFERS].gpu_timestamp_ns / 1000.0, sample->deltas[RD_GEN_BUFFERS].gpu_elapsed_time_ns / 1000.0,
+		sample->deltas[RD_UPLOAD     ].walltime / 1000.0, sample->deltas[RD_UPLOAD     ].cpu_time / 1000.0, sample->deltas[RD_UPLOAD     ].gpu_timestamp_ns / 1000.0, sample->deltas[RD_UPLOAD     ].gpu_elapsed_time_ns / 1000.0,
+		sample->deltas[RD_CLEAR      ].walltime / 1000.0, sample->deltas[RD_CLEAR      ].cpu_time / 1000.0, sample->deltas[RD_CLEAR      ].gpu_timestamp_ns / 1000.0, sample->deltas[RD_CLEAR      ].gpu_elapsed_time_ns / 1000.0,
+		sample->deltas[RD_DRAW       ].walltime / 1000.0, sample->deltas[RD_DRAW       ].cpu_time / 1000.0, sample->deltas[RD_DRAW       ].gpu_timestamp_ns / 1000.0, sample->deltas[RD_DRAW       ].gpu_elapsed_time_ns / 1000.0,
+		sample->deltas[RD_PRESENT    ].walltime / 1000.0, sample->deltas[RD_PRESENT    ].cpu_time / 1000.0, sample->deltas[RD_PRESENT    ].gpu_timestamp_ns / 1000.0, sample->deltas[RD_PRESENT    ].gpu_elapsed_time_ns / 1000.0,
+		sample->deltas[RD_FENCE_WAIT ].walltime / 1000.0, sample->deltas[RD_FENCE_WAIT ].cpu_time / 1000.0, sample->upload_bytes
+	);
+}
+
+/**
+ * Reads the GPU timers of a query set into the sample of the frame that used it. Without wait it only does so if the
+ * results are already available and returns false otherwise.
+ */
+bool report_resolve_query_set(uint32_t query_set, bool wait) {
+	uint32_t frame = report_query_set_pending_frame[query_set];
+	if (frame == 0)
+		return true;
+	
+	// The frame end timestamp is the last query of a frame. Once it's done the others are done as well.
+	if (!wait) {
+		GLuint available = GL_FALSE;
+		glGetQueryObjectuiv(report_checkpoints[RC_FRAME_END].gpu_timestamp_ids[query_set], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			return false;
+	}
+	
+	uint64_t timestamps_ns[RC_FRAME_END + 1] = { 0 };
+	for (report_checkpoint_index_t c = RC_FRAME_START; c <= RC_FRAME_END; c++)
+		glGetQueryObjectui64v(report_checkpoints[c].gpu_timestamp_ids[query_set], GL_QUERY_RESULT, &timestamps_ns[c]);
+	
+	const struct { report_checkpoint_index_t from, to; bool has_elapsed_timer; } delta_checkpoints[] = {
+		[RD_FRAME]       = { RC_FRAME_START,      RC_FRAME_END,        false },
+		[RD_GEN_BUFFERS] = { RC_FRAME_START,      RC_GEN_BUFFERS_DONE, false },
+		[RD_UPLOAD]      = { RC_GEN_BUFFERS_DONE, RC_UPLOAD_DONE,      true  },
+		[RD_CLEAR]       = { RC_UPLOAD_DONE,      RC_CLEAR_DONE,       true  },
+		[RD_DRAW]        = { RC_CLEAR_DONE,       RC_DRAW_DONE,        true  },
+		[RD_PRESENT]     = { RC_DRAW_DONE,        RC_FRAME_END,        true  },
+	};
+	report_frame_sample_t* sample = &report_frame_samples[frame - 1];
+	for (report_delta_index_t d = RD_FRAME; d <= RD_PRESENT; d++) {
+		sample->deltas[d].gpu_timestamp_ns = timestamps_ns[delta_checkpoints[d].to] - timestamps_ns[delta_checkpoints[d].from];
+		if (delta_checkpoints[d].has_elapsed_timer)
+			glGetQueryObjectui64v(report_deltas[d].gpu_elapsed_timer_ids[query_set], GL_QUERY_RESULT, &sample->deltas[d].gpu_elapsed_time_ns);
+		
+		report_deltas[d].accu_gpu_timestamp_ns    += sample->deltas[d].gpu_timestamp_ns;
+		report_deltas[d].accu_gpu_elapsed_time_ns += sample->deltas[d].gpu_elapsed_time_ns;
+	}
 	
-	report_deltas[delta].accu_walltime            += report_deltas[delta].walltime;
-	report_deltas[delta].accu_cpu_time            += report_deltas[delta].cpu_time;
-	report_deltas[delta].accu_gpu_timestamp_ns    += report_deltas[delta].gpu_timestamp_ns;
-	report_deltas[delta].accu_gpu_elapsed_time_ns += report_deltas[delta].gpu_elapsed_time_ns;
+	report_query_set_pending_frame[query_set] = 0;
+	report_output_frame(frame);
+	return true;
+}
+
+/**
+ * Reads all query sets that are done, oldest first (so the per-frame output stays in order). The query set the next
+ * frame is going to use is waited for if necessary. With wait_for_all we wait for everything (end of an approach).
+ */
+void report_resolve_query_sets(bool wait_for_all) {
+	for (uint32_t i = 0; i < reporting_query_latency; i++) {
+		uint32_t query_set = (report_query_set + i) % reporting_query_latency;
+		if ( !report_resolve_query_set(query_set, wait_for_all || i == 0) )
+			break;
+	}
 }
 
 void report_scenario(const char* scenario_name) {
 	report_current_scenario = scenario_name;
 }
 
+/**
+ * Sets the rect count, render size and gen buffers thread count of the following approaches for the sweep CSV. Called
+ * by main() for each combination of --sweep-rects=, --sweep-sizes= and --gen-threads= (or just once without sweeps).
+ */
+void report_sweep_point(uint32_t rects_count, int width, int height, uint32_t gen_threads) {
+	report_sweep_rects_count = rects_count;
+	report_sweep_width = width;
+	report_sweep_height = height;
+	report_sweep_gen_threads = gen_threads;
+}
+
+/**
+ * Called by load_shader_program_separable() for each program. cache is "off" without --program-cache=, "miss" when it
+ * was compiled (and stored in the cache) or "hit" when it was loaded from a program binary.
+ */
+void report_program_loaded(uint64_t key, const char* cache, nsec_t compile_ns, nsec_t link_ns, nsec_t binary_ns) {
+	if (report_programs_count == report_programs_capacity) {
+		report_programs_capacity = (report_programs_capacity > 0) ? report_programs_capacity * 2 : 8;
+		report_programs = realloc(report_programs, report_programs_capacity * sizeof(report_programs[0]));
+	}
+	report_programs[report_programs_count++] = (report_program_t){ key, cache, compile_ns, link_ns, binary_ns };
+	
+	report_programs_total++;
+	report_programs_cache_hits += (strcmp(cache, "hit") == 0);
+	report_programs_compile_ns += compile_ns;
+	report_programs_link_ns += link_ns;
+	report_programs_binary_ns += binary_ns;
+}
+
 void report_approach_start(const char* approach_name) {
 	report_current_approach = approach_name;
 	
+	if (reporting_programs_file) {
+		for (uint32_t i = 0; i < report_programs_count; i++) {
+			report_program_t* program = &report_programs[i];
+			fprintf(reporting_programs_file,
+				"%-15s , %-25s , %016" PRIx64 " , %-5s , %11.3lfms , %11.3lfms , %11.3lfms , %11.3lfms\n",
+				report_current_scenario, report_current_approach, program->key, program->cache,
+				program->compile_ns / 1000000.0, program->link_ns / 1000000.0, program->binary_ns / 1000000.0,
+				(program->compile_ns + program->link_ns + program->binary_ns) / 1000000.0
+			);
+		}
+	}
+	report_programs_count = 0;
+	
+	if (reporting_frame_log_file && reporting_output_per_frame_data) {
+		report_log_record_t record = (report_log_record_t){ .type = REPORT_LOG_APPROACH };
+		snprintf(record.data.names.scenario, sizeof(record.data.names.scenario), "%s", report_current_scenario);
+		snprintf(record.data.names.approach, sizeof(record.data.names.approach), "%s", report_current_approach);
+		report_log_push(&record);
+	}
+	
 	report_counter += 1;
 	reported_frame_count = 0;
 	
 	report_reset_checkpoints_and_deltas();
-	report_last_frame_start_walltime = time_now();
-	report_accu_dt_us = 0;
+	report_last_frame_start_walltime = report_walltime_now();
+	report_accu_dt_ns = 0;
+	report_accu_upload_bytes = 0;
+	
+	report_query_set = 0;
+	for (uint32_t i = 0; i < REPORT_MAX_QUERY_LATENCY; i++)
+		report_query_set_pending_frame[i] = 0;
 	
 	report_elapsed_timer_running = false;
 	report_prev_checkpoint_index = RC_APPROACH_START - 1;
@@ -370,6 +2228,31 @@ void report_approach_start(const char* approach_name) {
 void report_frame_start() {
 	report_prev_checkpoint_index = RC_FRAME_START - 1;
 	report_trigger_checkpoint_and_elapsed_timer(RC_FRAME_START, RD_NONE);
+	report_deltas[RD_FENCE_WAIT].walltime = 0;
+	report_deltas[RD_FENCE_WAIT].cpu_time = 0;
+	report_frame_upload_bytes = 0;
+}
+
+/**
+ * Put around waits for fences within a frame (e.g. for the slot of an upload ring). The times of all waits in a frame
+ * are summed up in the RD_FENCE_WAIT delta. That time is also part of the phase the wait happens in.
+ */
+void report_fence_wait_start() {
+	report_fence_wait_start_walltime = report_walltime_now();
+	report_fence_wait_start_cpu_time = time_process_cpu_time_ns();
+}
+
+void report_fence_wait_done() {
+	report_deltas[RD_FENCE_WAIT].walltime += report_walltime_now() - report_fence_wait_start_walltime;
+	report_deltas[RD_FENCE_WAIT].cpu_time += time_process_cpu_time_ns() - report_fence_wait_start_cpu_time;
+}
+
+/**
+ * Call with the size of each buffer (or texture) upload of a frame. Together they show how much data a frame moves to
+ * the GPU, e.g. all rects for a full upload or only the changed ones with an *_dirty approach.
+ */
+void report_upload_bytes(uint64_t bytes) {
+	report_frame_upload_bytes += bytes;
 }
 
 void report_gen_buffers_done() {
@@ -380,110 +2263,1969 @@ void report_upload_done() {
 	report_trigger_checkpoint_and_elapsed_timer(RC_UPLOAD_DONE, RD_CLEAR);
 }
 
-void report_clear_done() {
-	report_trigger_checkpoint_and_elapsed_timer(RC_CLEAR_DONE, RD_DRAW);
-}
+void report_clear_done() {
+	report_trigger_checkpoint_and_elapsed_timer(RC_CLEAR_DONE, RD_DRAW);
+}
+
+void report_draw_done() {
+	report_trigger_checkpoint_and_elapsed_timer(RC_DRAW_DONE, RD_PRESENT);
+}
+
+void report_frame_end() {
+	report_trigger_checkpoint_and_elapsed_timer(RC_FRAME_END, RD_NONE);
+	
+	// Measurements done, from here do the per frame data processing.
+	reported_frame_count++;
+	
+	report_update_delta(RD_FRAME,       RC_FRAME_START,      RC_FRAME_END);
+	report_update_delta(RD_GEN_BUFFERS, RC_FRAME_START,      RC_GEN_BUFFERS_DONE);
+	report_update_delta(RD_UPLOAD,      RC_GEN_BUFFERS_DONE, RC_UPLOAD_DONE);
+	report_update_delta(RD_CLEAR,       RC_UPLOAD_DONE,      RC_CLEAR_DONE);
+	report_update_delta(RD_DRAW,        RC_CLEAR_DONE,       RC_DRAW_DONE);
+	report_update_delta(RD_PRESENT,     RC_DRAW_DONE,        RC_FRAME_END);
+	report_deltas[RD_FENCE_WAIT].accu_walltime += report_deltas[RD_FENCE_WAIT].walltime;
+	report_deltas[RD_FENCE_WAIT].accu_cpu_time += report_deltas[RD_FENCE_WAIT].cpu_time;
+	report_accu_upload_bytes += report_frame_upload_bytes;
+	
+	nsec_t frame_dt_ns = report_checkpoints[RC_FRAME_START].walltime - report_last_frame_start_walltime;
+	report_accu_dt_ns += frame_dt_ns;
+	report_last_frame_start_walltime = report_checkpoints[RC_FRAME_START].walltime;
+	
+	// Warm-up frames are rendered as usual but don't show up in the results. At the end of the last warm-up frame we throw
+	// away everything accumulated so far and restart the approach checkpoint. That way the approach deltas only cover the
+	// measured frames. Their query sets are never read (nothing pending), they're simply reused.
+	if (reported_frame_count <= reporting_warmup_frames) {
+		if (reported_frame_count == reporting_warmup_frames) {
+			for (uint32_t i = 0; i < sizeof(report_deltas) / sizeof(report_deltas[0]); i++) {
+				report_deltas[i].accu_walltime            = 0;
+				report_deltas[i].accu_cpu_time            = 0;
+				report_deltas[i].accu_gpu_timestamp_ns    = 0;
+				report_deltas[i].accu_gpu_elapsed_time_ns = 0;
+				for (uint32_t j = 0; j < RP_COUNT; j++)
+					report_deltas[i].accu_perf_counters[j] = 0;
+				report_deltas[i].accu_perf_missed = false;
+			}
+			report_accu_dt_ns = 0;
+			report_accu_upload_bytes = 0;
+			
+			glQueryCounter(report_checkpoints[RC_APPROACH_START].gpu_timestamp_ids[0], GL_TIMESTAMP);
+			report_checkpoints[RC_APPROACH_START].walltime = report_walltime_now();
+			report_checkpoints[RC_APPROACH_START].cpu_time = time_process_cpu_time_ns();
+			report_perf_read(&report_checkpoints[RC_APPROACH_START]);
+		}
+		report_query_set = (report_query_set + 1) % reporting_query_latency;
+		return;
+	}
+	uint32_t measured_frame_count = reported_frame_count - reporting_warmup_frames;
+	
+	// Keep the deltas of each frame for the statistics in report_approach_end(). The GPU values are filled in later when
+	// the query set of the frame is resolved.
+	if (measured_frame_count > report_frame_samples_capacity) {
+		report_frame_samples_capacity = (report_frame_samples_capacity == 0) ? 256 : report_frame_samples_capacity * 2;
+		report_frame_samples = realloc(report_frame_samples, report_frame_samples_capacity * sizeof(report_frame_samples[0]));
+	}
+	report_frame_sample_t* sample = &report_frame_samples[measured_frame_count - 1];
+	for (uint32_t i = 0; i < sizeof(report_deltas) / sizeof(report_deltas[0]); i++) {
+		sample->deltas[i].walltime            = report_deltas[i].walltime;
+		sample->deltas[i].cpu_time            = report_deltas[i].cpu_time;
+		sample->deltas[i].gpu_timestamp_ns    = 0;
+		sample->deltas[i].gpu_elapsed_time_ns = 0;
+	}
+	sample->dt = frame_dt_ns;
+	sample->upload_bytes = report_frame_upload_bytes;
+	
+	// Set reporting_query_timers to false to get rid of the timer queries completely
+	if (reporting_query_timers) {
+		report_query_set_pending_frame[report_query_set] = measured_frame_count;
+		report_query_set = (report_query_set + 1) % reporting_query_latency;
+		report_resolve_query_sets(false);
+	} else {
+		report_output_frame(measured_frame_count);
+	}
+}
+
+/**
+ * Statistics over the per-frame deltas of an approach. Percentiles use the nearest rank method so each one is an
+ * actually measured value. The confidence interval is a 95% percentile bootstrap interval of the median.
+ */
+typedef struct {
+	double min, median, p95, p99, max;
+	double median_ci_low, median_ci_high;
+} report_stats_t;
+
+#define REPORT_BOOTSTRAP_RESAMPLES 1000
+
+int compare_doubles(const void* a, const void* b) {
+	double x = *(const double*)a, y = *(const double*)b;
+	return (x > y) - (x < y);
+}
+
+uint32_t nearest_rank_index(uint32_t count, double percentile) {
+	uint32_t rank = (uint32_t)ceil(percentile * count);
+	return (rank == 0) ? 0 : rank - 1;
+}
+
+// Partially sorts values so that values[n] is the element that would be there in a sorted array (Hoare's selection)
+double quickselect(double* values, uint32_t count, uint32_t n) {
+	uint32_t left = 0, right = count - 1;
+	while (left < right) {
+		double pivot = values[left + (right - left) / 2];
+		uint32_t i = left, j = right;
+		while (i <= j) {
+			while (values[i] < pivot) i++;
+			while (values[j] > pivot) j--;
+			if (i <= j) {
+				double temp = values[i]; values[i] = values[j]; values[j] = temp;
+				i++;
+				if (j == 0) break;
+				j--;
+			}
+		}
+		if (n <= j)      right = j;
+		else if (n >= i) left = i;
+		else             break;
+	}
+	return values[n];
+}
+
+report_stats_t report_calc_stats(double* values, uint32_t count) {
+	report_stats_t stats = (report_stats_t){ 0 };
+	if (count == 0)
+		return stats;
+	
+	double* resampled = malloc(count * sizeof(resampled[0]));
+	double medians[REPORT_BOOTSTRAP_RESAMPLES];
+	uint64_t rand_state = 1;  // Fixed seed so the intervals are reproducible
+	for (uint32_t i = 0; i < REPORT_BOOTSTRAP_RESAMPLES; i++) {
+		for (uint32_t j = 0; j < count; j++)
+			resampled[j] = values[rand_in(&rand_state, 0, count)];
+		medians[i] = quickselect(resampled, count, nearest_rank_index(count, 0.5));
+	}
+	free(resampled);
+	qsort(medians, REPORT_BOOTSTRAP_RESAMPLES, sizeof(medians[0]), compare_doubles);
+	
+	qsort(values, count, sizeof(values[0]), compare_doubles);
+	stats.min            = values[0];
+	stats.median         = values[nearest_rank_index(count, 0.50)];
+	stats.p95            = values[nearest_rank_index(count, 0.95)];
+	stats.p99            = values[nearest_rank_index(count, 0.99)];
+	stats.max            = values[count - 1];
+	stats.median_ci_low  = medians[nearest_rank_index(REPORT_BOOTSTRAP_RESAMPLES, 0.025)];
+	stats.median_ci_high = medians[nearest_rank_index(REPORT_BOOTSTRAP_RESAMPLES, 0.975)];
+	
+	return stats;
+}
+
+void report_write_stats() {
+	uint32_t count = (reported_frame_count > reporting_warmup_frames) ? reported_frame_count - reporting_warmup_frames : 0;
+	if (count == 0)
+		return;
+	double* values = malloc(count * sizeof(values[0]));
+	
+	// Times are in us, the upload bytes in bytes
+	void write_stats(const char* phase, const char* metric) {
+		report_stats_t stats = report_calc_stats(values, count);
+		const char* unit = (strcmp(metric, "bytes") == 0) ? "B " : "us";
+		fprintf(reporting_stats_file,
+			"%-15s , %-25s , %-6s , %-6s , %6u ,"
+			" %11.3lf%s , %11.3lf%s , %11.3lf%s , %11.3lf%s , %11.3lf%s ,"
+			" %11.3lf%s , %11.3lf%s\n",
+			report_current_scenario, report_current_approach, phase, metric, count,
+			stats.min, unit, stats.median, unit, stats.p95, unit, stats.p99, unit, stats.max, unit,
+			stats.median_ci_low, unit, stats.median_ci_high, unit
+		);
+	}
+	
+	// Same names as the column prefixes in the other CSV files
+	const char* phase_names[] = {
+		[RD_FRAME] = "frame", [RD_GEN_BUFFERS] = "buffer", [RD_UPLOAD] = "upload", [RD_CLEAR] = "clear", [RD_DRAW] = "draw", [RD_PRESENT] = "pres"
+	};
+	for (report_delta_index_t d = RD_FRAME; d <= RD_PRESENT; d++) {
+		for (uint32_t i = 0; i < count; i++)
+			values[i] = report_frame_samples[i].deltas[d].walltime / 1000.0;
+		write_stats(phase_names[d], "wt");
+		
+		for (uint32_t i = 0; i < count; i++)
+			values[i] = report_frame_samples[i].deltas[d].cpu_time / 1000.0;
+		write_stats(phase_names[d], "ct");
+		
+		if (reporting_query_timers) {
+			for (uint32_t i = 0; i < count; i++)
+				values[i] = report_frame_samples[i].deltas[d].gpu_timestamp_ns / 1000.0;
+			write_stats(phase_names[d], "gt");
+			
+			// There is no elapsed timer around the whole frame
+			if (d != RD_FRAME) {
+				for (uint32_t i = 0; i < count; i++)
+					values[i] = report_frame_samples[i].deltas[d].gpu_elapsed_time_ns / 1000.0;
+				write_stats(phase_names[d], "ge");
+			}
+		}
+		
+		if (d == RD_FRAME) {
+			for (uint32_t i = 0; i < count; i++)
+				values[i] = report_frame_samples[i].dt / 1000.0;
+			write_stats(phase_names[d], "dt");
+		}
+	}
+	
+	// The fence waits only have CPU side times
+	for (uint32_t i = 0; i < count; i++)
+		values[i] = report_frame_samples[i].deltas[RD_FENCE_WAIT].walltime / 1000.0;
+	write_stats("fence", "wt");
+	for (uint32_t i = 0; i < count; i++)
+		values[i] = report_frame_samples[i].deltas[RD_FENCE_WAIT].cpu_time / 1000.0;
+	write_stats("fence", "ct");
+	
+	for (uint32_t i = 0; i < count; i++)
+		values[i] = report_frame_samples[i].upload_bytes;
+	write_stats("upload", "bytes");
+	
+	free(values);
+}
+
+/**
+ * Writes the median time of each phase and that time per rect and per megapixel of the render target. Those are the
+ * y-values of the scaling curves, a flat per_rect curve means the phase scales linearly with the rect count.
+ */
+void report_write_sweep() {
+	uint32_t count = (reported_frame_count > reporting_warmup_frames) ? reported_frame_count - reporting_warmup_frames : 0;
+	if (count == 0)
+		return;
+	double* values = malloc(count * sizeof(values[0]));
+	double megapixels = report_sweep_width * (double)report_sweep_height / 1000000.0;
+	
+	// Times are in us and per rect in ns, the upload bytes stay bytes in all three columns
+	void write_median(const char* phase, const char* metric) {
+		double median = quickselect(values, count, nearest_rank_index(count, 0.5));
+		bool bytes = (strcmp(metric, "bytes") == 0);
+		double per_rect = (report_sweep_rects_count > 0) ? median * (bytes ? 1.0 : 1000.0) / report_sweep_rects_count : 0.0;
+		fprintf(reporting_sweep_file,
+			"%-15s , %-25s , %10u , %6d , %6d , %-6s , %-6s ,"
+			" %11.3lf%s , %11.3lf%s , %11.3lf%s , %7u\n",
+			report_current_scenario, report_current_approach, report_sweep_rects_count, report_sweep_width, report_sweep_height, phase, metric,
+			median, bytes ? "B " : "us", per_rect, bytes ? "B " : "ns", median / megapixels, bytes ? "B " : "us", report_sweep_gen_threads
+		);
+	}
+	
+	// Walltime of each phase and the GPU time (elapsed timers, for the whole frame the timestamp delta)
+	const char* phase_names[] = {
+		[RD_FRAME] = "frame", [RD_GEN_BUFFERS] = "buffer", [RD_UPLOAD] = "upload", [RD_CLEAR] = "clear", [RD_DRAW] = "draw", [RD_PRESENT] = "pres"
+	};
+	for (report_delta_index_t d = RD_FRAME; d <= RD_PRESENT; d++) {
+		for (uint32_t i = 0; i < count; i++)
+			values[i] = report_frame_samples[i].deltas[d].walltime / 1000.0;
+		write_median(phase_names[d], "wt");
+		
+		if (reporting_query_timers) {
+			for (uint32_t i = 0; i < count; i++)
+				values[i] = ((d == RD_FRAME) ? report_frame_samples[i].deltas[d].gpu_timestamp_ns : report_frame_samples[i].deltas[d].gpu_elapsed_time_ns) / 1000.0;
+			write_median(phase_names[d], (d == RD_FRAME) ? "gt" : "ge");
+		}
+	}
+	for (uint32_t i = 0; i < count; i++)
+		values[i] = report_frame_samples[i].deltas[RD_FENCE_WAIT].walltime / 1000.0;
+	write_median("fence", "wt");
+	for (uint32_t i = 0; i < count; i++)
+		values[i] = report_frame_samples[i].upload_bytes;
+	write_median("upload", "bytes");
+	
+	fflush(reporting_sweep_file);
+	free(values);
+}
+
+void report_write_perf_counters() {
+	// Sums over all measured frames, like in the per-approach CSV. The approach phase covers all of them.
+	const char* phase_names[] = {
+		[RD_APPROACH] = "approach", [RD_FRAME] = "frame", [RD_GEN_BUFFERS] = "buffer", [RD_UPLOAD] = "upload",
+		[RD_CLEAR] = "clear", [RD_DRAW] = "draw", [RD_PRESENT] = "pres"
+	};
+	for (report_delta_index_t d = RD_APPROACH; d <= RD_PRESENT; d++) {
+		uint64_t* counters = (d == RD_APPROACH) ? report_deltas[d].perf_counters : report_deltas[d].accu_perf_counters;
+		bool missed = (d == RD_APPROACH) ? report_deltas[d].perf_missed : report_deltas[d].accu_perf_missed;
+		fprintf(reporting_perf_file, "%-15s , %-25s , %-8s", report_current_scenario, report_current_approach, phase_names[d]);
+		for (uint32_t i = 0; i < RP_COUNT; i++) {
+			if (report_perf_available[i] && !missed)
+				fprintf(reporting_perf_file, " , %14"PRIu64, counters[i]);
+			else
+				fprintf(reporting_perf_file, " , %14s", "n/a");
+		}
+		fprintf(reporting_perf_file, "\n");
+	}
+}
+
+void report_approach_end() {
+	report_trigger_checkpoint_and_elapsed_timer(RC_APPROACH_END, RD_NONE);
+	report_update_delta(RD_APPROACH, RC_APPROACH_START, RC_APPROACH_END);
+	
+	// Collect the timers of the last frames that are still in flight
+	if (reporting_query_timers) {
+		report_resolve_query_sets(true);
+		glGetQueryObjectui64v(report_checkpoints[RC_APPROACH_START].gpu_timestamp_ids[0], GL_QUERY_RESULT, &report_checkpoints[RC_APPROACH_START].gpu_timestamp_ns);
+		glGetQueryObjectui64v(report_checkpoints[RC_APPROACH_END].gpu_timestamp_ids[0], GL_QUERY_RESULT, &report_checkpoints[RC_APPROACH_END].gpu_timestamp_ns);
+		report_deltas[RD_APPROACH].gpu_timestamp_ns = report_checkpoints[RC_APPROACH_END].gpu_timestamp_ns - report_checkpoints[RC_APPROACH_START].gpu_timestamp_ns;
+	}
+	
+	// Output per-approach log (header duplicated here for reference)
+	//fprintf(stdout,
+	//	"scenario        , approach                  ,"
+	//	"   approach_wt ,   approach_ct ,   approach_gt ,"
+	//	"      frame_wt ,      frame_ct ,      frame_gt ,            dt ,"
+	//	"     buffer_wt ,     buffer_ct ,     buffer_gt ,     buffer_ge ,"
+	//	"     upload_wt ,     upload_ct ,     upload_gt ,     upload_ge ,"
+	//	"      clear_wt ,      clear_ct ,      clear_gt ,      clear_ge ,"
+	//	"       draw_wt ,       draw_ct ,       draw_gt ,       draw_ge ,"
+	//	"       pres_wt ,       pres_ct ,       pres_gt ,       pres_ge ,"
+	//	"      fence_wt ,      fence_ct ,   upload_bytes\n"
+	//);
+	fprintf(stdout,
+		"%-15s , %-25s ,"
+		" %11.6lfms , %11.6lfms , %11.6lfms ,"
+		" %11.6lfms , %11.6lfms , %11.6lfms , %11.6lfms ,"
+		" %11.6lfms , %11.6lfms , %11.6lfms , %11.6lfms ,"
+		" %11.6lfms , %11.6lfms , %11.6lfms , %11.6lfms ,"
+		" %11.6lfms , %11.6lfms , %11.6lfms , %11.6lfms ,"
+		" %11.6lfms , %11.6lfms , %11.6lfms , %11.6lfms ,"
+		" %11.6lfms , %11.6lfms , %11.6lfms , %11.6lfms ,"
+		" %11.6lfms , %11.6lfms , %14"PRIu64"\n",
+		report_current_scenario, report_current_approach,
+		report_deltas[RD_APPROACH   ].walltime      / 1000000.0, report_deltas[RD_APPROACH   ].cpu_time      / 1000000.0, report_deltas[RD_APPROACH   ].gpu_timestamp_ns      / 1000000.0,
+		report_deltas[RD_FRAME      ].accu_walltime / 1000000.0, report_deltas[RD_FRAME      ].accu_cpu_time / 1000000.0, report_deltas[RD_FRAME      ].accu_gpu_timestamp_ns / 1000000.0, report_accu_dt_ns / 1000000.0,
+		report_deltas[RD_GEN_BUFFERS].accu_walltime / 1000000.0, report_deltas[RD_GEN_BUFFERS].accu_cpu_time / 1000000.0, report_deltas[RD_GEN_BUFFERS].accu_gpu_timestamp_ns / 1000000.0, report_deltas[RD_GEN_BUFFERS].accu_gpu_elapsed_time_ns / 1000000.0,
+		report_deltas[RD_UPLOAD     ].accu_walltime / 1000000.0, report_deltas[RD_UPLOAD     ].accu_cpu_time / 1000000.0, report_deltas[RD_UPLOAD     ].accu_gpu_timestamp_ns / 1000000.0, report_deltas[RD_UPLOAD     ].accu_gpu_elapsed_time_ns / 1000000.0,
+		report_deltas[RD_CLEAR      ].accu_walltime / 1000000.0, report_deltas[RD_CLEAR      ].accu_cpu_time / 1000000.0, report_deltas[RD_CLEAR      ].accu_gpu_timestamp_ns / 1000000.0, report_deltas[RD_CLEAR      ].accu_gpu_elapsed_time_ns / 1000000.0,
+		report_deltas[RD_DRAW       ].accu_walltime / 1000000.0, report_deltas[RD_DRAW       ].accu_cpu_time / 1000000.0, report_deltas[RD_DRAW       ].accu_gpu_timestamp_ns / 1000000.0, report_deltas[RD_DRAW       ].accu_gpu_elapsed_time_ns / 1000000.0,
+		report_deltas[RD_PRESENT    ].accu_walltime / 1000000.0, report_deltas[RD_PRESENT    ].accu_cpu_time / 1000000.0, report_deltas[RD_PRESENT    ].accu_gpu_timestamp_ns / 1000000.0, report_deltas[RD_PRESENT    ].accu_gpu_elapsed_time_ns / 1000000.0,
+		report_deltas[RD_FENCE_WAIT ].accu_walltime / 1000000.0, report_deltas[RD_FENCE_WAIT ].accu_cpu_time / 1000000.0, report_accu_upload_bytes
+	);
+	
+	if (reporting_stats_file)
+		report_write_stats();
+	if (reporting_sweep_file)
+		report_write_sweep();
+	if (reporting_perf_file)
+		report_write_perf_counters();
+	
+	// Dump a screenshot of the benchmark
+	if (reporting_capture_last_frames) {
+		char filename[255];
+		snprintf(filename, sizeof(filename), "26-%02u-%s-%s.ppm", report_counter, report_current_scenario, report_current_approach);
+		save_default_framebuffer_as_ppm(filename, reporting_capture_buffer);
+	}
+}
+
+
+
+//
+// Verification of the rendered images
+//
+// With --verify=approach or --verify-golden=dir main() renders into an offscreen FBO and reads the last frame of each
+// approach back after it's done. That image is compared against the image of the reference approach in the same
+// scenario (it runs first) or against the golden image dir/<scenario>.ppm. --write-golden=dir stores the image of the
+// first approach that runs in a scenario as golden image, e.g. with --approach=cpu_raster.
+//
+// For each approach a line with the max error of a channel, the PSNR over all RGB channels and the number of pixels
+// that differ at all goes into --verify-csv=file (bench-verify.csv by default). When the PSNR is below
+// --verify-min-psnr=dB the approach counts as mismatch and the exit code becomes 2.
+//
+// Images are RGB with 8 bits per channel and the top row first, the same as the PPM files.
+//
+
+const char* verify_reference_approach = NULL;  // --verify=approach
+const char* verify_golden_dir         = NULL;  // --verify-golden=dir
+const char* verify_write_golden_dir   = NULL;  // --write-golden=dir
+double      verify_min_psnr           = 40;    // --verify-min-psnr=dB
+FILE*       verify_file               = NULL;
+uint32_t    verify_mismatches         = 0;
+
+typedef struct {
+	uint32_t max_error;
+	double psnr;  // INFINITY for identical images
+	uint64_t differing_pixels;
+} verify_result_t;
+
+uint8_t* verify_read_framebuffer(display_t* display, int width, int height) {
+	size_t row_size = width * 3, image_size = row_size * height;
+	uint8_t* rows = malloc(image_size);
+	uint8_t* image = malloc(image_size);
+	
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, display_framebuffer(display));
+	glReadBuffer(display_presented_buffer(display));
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadnPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, image_size, rows);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	
+	// OpenGL images are bottom to top
+	for (int y = 0; y < height; y++)
+		memcpy(image + y * row_size, rows + (height - 1 - y) * row_size, row_size);
+	free(rows);
+	
+	return image;
+}
+
+uint8_t* verify_load_ppm(const char* filename, int width, int height) {
+	FILE* f = fopen(filename, "rb");
+	if (f == NULL) {
+		fprintf(stderr, "Verify: can't open %s: %s\n", filename, strerror(errno));
+		return NULL;
+	}
+	
+	int file_width = 0, file_height = 0, max_value = 0;
+	if ( fscanf(f, "P6 %d %d %d", &file_width, &file_height, &max_value) != 3 || fgetc(f) == EOF || max_value != 255 ) {
+		fprintf(stderr, "Verify: %s is no binary PPM with 8 bits per channel\n", filename);
+		fclose(f);
+		return NULL;
+	}
+	if (file_width != width || file_height != height) {
+		fprintf(stderr, "Verify: %s is %dx%d but the rendered images are %dx%d\n", filename, file_width, file_height, width, height);
+		fclose(f);
+		return NULL;
+	}
+	
+	size_t image_size = (size_t)width * height * 3;
+	uint8_t* image = malloc(image_size);
+	if (fread(image, 1, image_size, f) != image_size) {
+		fprintf(stderr, "Verify: %s is truncated\n", filename);
+		free(image);
+		image = NULL;
+	}
+	
+	fclose(f);
+	return image;
+}
+
+bool verify_write_ppm(const char* filename, const uint8_t* image, int width, int height) {
+	FILE* f = fopen(filename, "wb");
+	if (f == NULL) {
+		fprintf(stderr, "Verify: can't write %s: %s\n", filename, strerror(errno));
+		return false;
+	}
+	
+	fprintf(f, "P6 %d %d 255\n", width, height);
+	fwrite(image, 1, (size_t)width * height * 3, f);
+	fclose(f);
+	return true;
+}
+
+verify_result_t verify_compare(const uint8_t* image, const uint8_t* reference, int width, int height) {
+	verify_result_t result = { 0 };
+	uint64_t squared_error_sum = 0;
+	
+	for (size_t i = 0; i < (size_t)width * height; i++) {
+		bool pixel_differs = false;
+		for (size_t c = 0; c < 3; c++) {
+			int error = abs((int)image[i * 3 + c] - (int)reference[i * 3 + c]);
+			if ((uint32_t)error > result.max_error)
+				result.max_error = error;
+			squared_error_sum += error * error;
+			pixel_differs |= (error != 0);
+		}
+		result.differing_pixels += pixel_differs;
+	}
+	
+	double mean_squared_error = squared_error_sum / ((double)width * height * 3);
+	result.psnr = (mean_squared_error == 0) ? INFINITY : 10 * log10(255.0 * 255.0 / mean_squared_error);
+	return result;
+}
+
+void verify_write_result(const char* scenario, const char* approach, const char* reference, verify_result_t result, int width, int height) {
+	bool mismatch = (result.psnr < verify_min_psnr);
+	if (mismatch)
+		verify_mismatches++;
+	
+	fprintf(verify_file, "%-15s , %-25s , %-25s , %9u , %8.2lfdB , %16" PRIu64 " , %9.4lf%% , %s\n",
+		scenario, approach, reference, result.max_error, result.psnr, result.differing_pixels,
+		result.differing_pixels * 100.0 / ((double)width * height), mismatch ? "MISMATCH" : "ok"
+	);
+	fflush(verify_file);
+}
+
+void verify_write_header() {
+	if (reporting_output_csv_headers)
+		fprintf(verify_file, "scenario        , approach                  , reference                 , max_error ,       psnr , differing_pixels ,  differing , verdict\n");
+}
+
+
+
+//
+// CPU reference rasterizer
+//
+// Draws a list of rect_t into an RGBA8 image in main memory and gives the same results as the one_ssbo shaders: solid
+// colors, glyphs from the atlas, textures and texture arrays, borders and rounded corners via sdAxisAlignedRect() and
+// GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA blending in rect order. It runs as its own approach ("cpu_raster") and its image
+// is the reference other approaches can be compared against.
+//
+// The image is split into tiles. All threads (the main thread and cpu_raster_threads - 1 workers) take tiles from an
+// atomic counter and draw every rect overlapping their tile in the original order, so no pixel is ever touched by two
+// threads. The rects are binned per tile row at the start of each frame so a tile only looks at the rects of its row.
+// Solid fills and unscaled glyphs (the bulk of the pixels in the UI scenarios) are drawn with SSE2 or AVX2 spans
+// selected at runtime. Everything else goes through a float version of the fragment shader.
+//
+// Textures are read back from OpenGL including their mipmaps, so the sampling sees the same texels as the GPU. Filters
+// and the level of detail follow the GL rules but with float precision. GPUs use less bits for the filter weights, so
+// expect differences of one or two in an 8 bit channel for scaled textures. With GL_NEAREST a pixel center can also
+// land exactly on a texel edge (e.g. 48 texels on 35 pixels) and the GPU might pick the texel on the other side.
+//
+
+#define CPU_RASTER_TILE_SIZE     64
+#define CPU_RASTER_MAX_TEXTURES  16
+#define CPU_RASTER_MAX_LEVELS    16
+#define CPU_RASTER_MAX_THREADS   64
+
+uint32_t    cpu_raster_threads = 0;       // --cpu-raster-threads=N, 0 uses one thread per CPU
+const char* cpu_raster_simd    = "auto";  // --cpu-raster-simd=auto|avx2|sse2|scalar
+
+typedef struct {
+	uint32_t level_count, layer_count;
+	uint32_t widths[CPU_RASTER_MAX_LEVELS], heights[CPU_RASTER_MAX_LEVELS];
+	uint8_t* levels[CPU_RASTER_MAX_LEVELS];  // RGBA8, one layer after another, texel row 0 (t = 0) first
+	GLenum   min_filter, mag_filter;
+} cpu_texture_t;
+
+typedef struct { float r, g, b, a; } cpu_color_t;
+
+typedef struct {
+	uint32_t width, height;
+	uint8_t* pixels;  // RGBA8, top row first (unlike OpenGL)
+	cpu_texture_t textures[CPU_RASTER_MAX_TEXTURES];  // Index is the texture unit the shaders use for texture_index
+	
+	// State of the current frame
+	const rect_t* rects;
+	uint32_t rects_count;
+	color_t clear_color;
+	uint32_t tiles_x, tiles_y, next_tile;
+	uint32_t* tile_row_offsets;  // tiles_y + 1 entries, rects of tile row y are tile_row_rects[offsets[y]..offsets[y+1]]
+	uint32_t* tile_row_rects;
+	size_t tile_row_rects_capacity;
+	
+	// Worker threads, woken up by incrementing frame_generation
+	uint32_t thread_count;
+	pthread_t threads[CPU_RASTER_MAX_THREADS];
+	pthread_mutex_t mutex;
+	pthread_cond_t work_cond, done_cond;
+	uint32_t frame_generation, workers_busy;
+	bool quit;
+} cpu_raster_t;
+
+
+/**
+ * Reads all mipmap levels of an immutable 2D texture or 2D texture array back from OpenGL.
+ */
+cpu_texture_t cpu_texture_from_gl(GLuint texture) {
+	cpu_texture_t tex = { 0 };
+	GLint level_count = 0, min_filter = 0, mag_filter = 0;
+	glGetTextureParameteriv(texture, GL_TEXTURE_IMMUTABLE_LEVELS, &level_count);
+	glGetTextureParameteriv(texture, GL_TEXTURE_MIN_FILTER, &min_filter);
+	glGetTextureParameteriv(texture, GL_TEXTURE_MAG_FILTER, &mag_filter);
+	tex.level_count = (level_count < 1) ? 1 : (level_count > CPU_RASTER_MAX_LEVELS) ? CPU_RASTER_MAX_LEVELS : level_count;
+	tex.min_filter = min_filter;
+	tex.mag_filter = mag_filter;
+	
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	for (uint32_t level = 0; level < tex.level_count; level++) {
+		GLint width = 0, height = 0, depth = 0;
+		glGetTextureLevelParameteriv(texture, level, GL_TEXTURE_WIDTH,  &width);
+		glGetTextureLevelParameteriv(texture, level, GL_TEXTURE_HEIGHT, &height);
+		glGetTextureLevelParameteriv(texture, level, GL_TEXTURE_DEPTH,  &depth);
+		tex.widths[level] = width;
+		tex.heights[level] = height;
+		tex.layer_count = depth;
+		
+		size_t size = (size_t)width * height * depth * 4;
+		tex.levels[level] = malloc(size);
+		glGetTextureImage(texture, level, GL_RGBA, GL_UNSIGNED_BYTE, size, tex.levels[level]);
+	}
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	
+	return tex;
+}
+
+void cpu_texture_destroy(cpu_texture_t* tex) {
+	for (uint32_t level = 0; level < tex->level_count; level++)
+		free(tex->levels[level]);
+	*tex = (cpu_texture_t){ 0 };
+}
+
+static inline cpu_color_t cpu_texture_fetch(const cpu_texture_t* tex, uint32_t level, uint32_t layer, int64_t x, int64_t y) {
+	int64_t width = tex->widths[level], height = tex->heights[level];
+	// GL_CLAMP_TO_EDGE
+	x = (x < 0) ? 0 : (x >= width)  ? width  - 1 : x;
+	y = (y < 0) ? 0 : (y >= height) ? height - 1 : y;
+	const uint8_t* texel = tex->levels[level] + (((layer * height) + y) * width + x) * 4;
+	return (cpu_color_t){ texel[0] / 255.0f, texel[1] / 255.0f, texel[2] / 255.0f, texel[3] / 255.0f };
+}
+
+static inline cpu_color_t cpu_color_mix(cpu_color_t a, cpu_color_t b, float t) {
+	return (cpu_color_t){ a.r + (b.r - a.r) * t, a.g + (b.g - a.g) * t, a.b + (b.b - a.b) * t, a.a + (b.a - a.a) * t };
+}
+
+// s and t are normalized texture coordinates, filter is GL_NEAREST or GL_LINEAR
+static cpu_color_t cpu_texture_filter(const cpu_texture_t* tex, uint32_t level, uint32_t layer, float s, float t, GLenum filter) {
+	float u = s * tex->widths[level], v = t * tex->heights[level];
+	if (filter == GL_NEAREST)
+		return cpu_texture_fetch(tex, level, layer, floorf(u), floorf(v));
+	
+	u -= 0.5f;
+	v -= 0.5f;
+	float x0 = floorf(u), y0 = floorf(v), fx = u - x0, fy = v - y0;
+	cpu_color_t top    = cpu_color_mix(cpu_texture_fetch(tex, level, layer, x0, y0),     cpu_texture_fetch(tex, level, layer, x0 + 1, y0),     fx);
+	cpu_color_t bottom = cpu_color_mix(cpu_texture_fetch(tex, level, layer, x0, y0 + 1), cpu_texture_fetch(tex, level, layer, x0 + 1, y0 + 1), fx);
+	return cpu_color_mix(top, bottom, fy);
+}
+
+/**
+ * Samples the texture like texture() in GLSL. lambda is the log2 of the texels per pixel (the level of detail), layer
+ * is ignored for 2D textures.
+ */
+cpu_color_t cpu_texture_sample(const cpu_texture_t* tex, float s, float t, float layer, float lambda) {
+	if (tex->levels[0] == NULL)
+		return (cpu_color_t){ 0, 0, 0, 1 };  // Incomplete texture
+	
+	uint32_t layer_index = (uint32_t)fmaxf(0, fminf(floorf(layer + 0.5f), tex->layer_count - 1));
+	if (lambda <= 0)
+		return cpu_texture_filter(tex, 0, layer_index, s, t, tex->mag_filter);
+	
+	uint32_t max_level = tex->level_count - 1;
+	switch (tex->min_filter) {
+		case GL_NEAREST: case GL_LINEAR:
+			return cpu_texture_filter(tex, 0, layer_index, s, t, tex->min_filter);
+		case GL_NEAREST_MIPMAP_NEAREST: case GL_LINEAR_MIPMAP_NEAREST: {
+			GLenum filter = (tex->min_filter == GL_NEAREST_MIPMAP_NEAREST) ? GL_NEAREST : GL_LINEAR;
+			float level = fminf(fmaxf(ceilf(lambda + 0.5f) - 1, 0), max_level);
+			return cpu_texture_filter(tex, level, layer_index, s, t, filter);
+		}
+		default: {
+			GLenum filter = (tex->min_filter == GL_NEAREST_MIPMAP_LINEAR) ? GL_NEAREST : GL_LINEAR;
+			if (lambda >= max_level)
+				return cpu_texture_filter(tex, max_level, layer_index, s, t, filter);
+			uint32_t level = floorf(lambda);
+			return cpu_color_mix(
+				cpu_texture_filter(tex, level,     layer_index, s, t, filter),
+				cpu_texture_filter(tex, level + 1, layer_index, s, t, filter),
+				lambda - level
+			);
+		}
+	}
+}
+
+
+//
+// Spans: blending of solid colors and unscaled glyphs with integer math. Each channel is
+// round((src * alpha + dst * (255 - alpha)) / 255), what GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA does in an RGBA8
+// framebuffer. The alpha channel uses alpha as src value. For glyphs alpha is round(color.a * glyph texel.r / 255).
+// The scalar, SSE2 and AVX2 versions give the exact same results.
+//
+
+static inline uint32_t cpu_raster_div255(uint32_t x) {
+	return (x + 1 + (x >> 8)) >> 8;  // Exact x / 255 for x < 65535
+}
+
+static inline void cpu_raster_blend_pixel(uint8_t* dst, uint32_t r, uint32_t g, uint32_t b, uint32_t alpha) {
+	uint32_t inv_alpha = 255 - alpha;
+	dst[0] = cpu_raster_div255(r     * alpha + dst[0] * inv_alpha + 127);
+	dst[1] = cpu_raster_div255(g     * alpha + dst[1] * inv_alpha + 127);
+	dst[2] = cpu_raster_div255(b     * alpha + dst[2] * inv_alpha + 127);
+	dst[3] = cpu_raster_div255(alpha * alpha + dst[3] * inv_alpha + 127);
+}
+
+void cpu_raster_fill_span_scalar(uint8_t* dst, uint32_t count, color_t color) {
+	if (color.a == 255) {
+		for (uint32_t i = 0; i < count; i++)
+			memcpy(dst + i * 4, &color, 4);
+	} else {
+		for (uint32_t i = 0; i < count; i++)
+			cpu_raster_blend_pixel(dst + i * 4, color.r, color.g, color.b, color.a);
+	}
+}
+
+void cpu_raster_glyph_span_scalar(uint8_t* dst, const uint8_t* texels, uint32_t count, color_t color) {
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t alpha = cpu_raster_div255(color.a * texels[i * 4] + 127);
+		cpu_raster_blend_pixel(dst + i * 4, color.r, color.g, color.b, alpha);
+	}
+}
+
+#ifdef CPU_RASTER_X86
+
+// The x86 versions work on 16 bit channels (2 pixels per 128 bit lane). Unpacking and packing both happen within the
+// 128 bit lanes, so the AVX2 versions are the SSE2 ones with twice the width.
+
+__attribute__((target("sse2"))) static inline __m128i cpu_raster_div255_sse2(__m128i x) {
+	return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, _mm_set1_epi16(1)), _mm_srli_epi16(x, 8)), 8);
+}
+
+__attribute__((target("sse2"))) void cpu_raster_fill_span_sse2(uint8_t* dst, uint32_t count, color_t color) {
+	uint32_t i = 0;
+	if (color.a == 255) {
+		uint32_t packed_color = 0;
+		memcpy(&packed_color, &color, 4);
+		__m128i src = _mm_set1_epi32(packed_color);
+		for (; i + 4 <= count; i += 4)
+			_mm_storeu_si128((__m128i*)(dst + i * 4), src);
+	} else {
+		__m128i zero = _mm_setzero_si128(), inv_alpha = _mm_set1_epi16(255 - color.a);
+		__m128i src = _mm_set_epi16(
+			color.a * color.a + 127, color.b * color.a + 127, color.g * color.a + 127, color.r * color.a + 127,
+			color.a * color.a + 127, color.b * color.a + 127, color.g * color.a + 127, color.r * color.a + 127
+		);
+		for (; i + 4 <= count; i += 4) {
+			__m128i pixels = _mm_loadu_si128((__m128i*)(dst + i * 4));
+			__m128i lo = _mm_unpacklo_epi8(pixels, zero), hi = _mm_unpackhi_epi8(pixels, zero);
+			lo = cpu_raster_div255_sse2(_mm_add_epi16(_mm_mullo_epi16(lo, inv_alpha), src));
+			hi = cpu_raster_div255_sse2(_mm_add_epi16(_mm_mullo_epi16(hi, inv_alpha), src));
+			_mm_storeu_si128((__m128i*)(dst + i * 4), _mm_packus_epi16(lo, hi));
+		}
+	}
+	cpu_raster_fill_span_scalar(dst + i * 4, count - i, color);
+}
+
+__attribute__((target("sse2"))) static inline __m128i cpu_raster_glyph_blend_sse2(__m128i dst, __m128i texels, __m128i color, __m128i color_alpha, __m128i alpha_mask) {
+	// Broadcast the red channel of each glyph texel into all 4 channels of its pixel
+	texels = _mm_shufflehi_epi16(_mm_shufflelo_epi16(texels, _MM_SHUFFLE(0, 0, 0, 0)), _MM_SHUFFLE(0, 0, 0, 0));
+	__m128i alpha = cpu_raster_div255_sse2(_mm_add_epi16(_mm_mullo_epi16(texels, color_alpha), _mm_set1_epi16(127)));
+	__m128i src = _mm_or_si128(color, _mm_and_si128(alpha, alpha_mask));
+	__m128i inv_alpha = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+	return cpu_raster_div255_sse2(_mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(src, alpha), _mm_mullo_epi16(dst, inv_alpha)), _mm_set1_epi16(127)));
+}
+
+__attribute__((target("sse2"))) void cpu_raster_glyph_span_sse2(uint8_t* dst, const uint8_t* texels, uint32_t count, color_t color) {
+	__m128i zero = _mm_setzero_si128(), color_alpha = _mm_set1_epi16(color.a);
+	__m128i color_rgb = _mm_set_epi16(0, color.b, color.g, color.r, 0, color.b, color.g, color.r);
+	__m128i alpha_mask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+	uint32_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i pixels = _mm_loadu_si128((__m128i*)(dst + i * 4)), glyph = _mm_loadu_si128((const __m128i*)(texels + i * 4));
+		__m128i lo = cpu_raster_glyph_blend_sse2(_mm_unpacklo_epi8(pixels, zero), _mm_unpacklo_epi8(glyph, zero), color_rgb, color_alpha, alpha_mask);
+		__m128i hi = cpu_raster_glyph_blend_sse2(_mm_unpackhi_epi8(pixels, zero), _mm_unpackhi_epi8(glyph, zero), color_rgb, color_alpha, alpha_mask);
+		_mm_storeu_si128((__m128i*)(dst + i * 4), _mm_packus_epi16(lo, hi));
+	}
+	cpu_raster_glyph_span_scalar(dst + i * 4, texels + i * 4, count - i, color);
+}
+
+__attribute__((target("avx2"))) static inline __m256i cpu_raster_div255_avx2(__m256i x) {
+	return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(x, _mm256_set1_epi16(1)), _mm256_srli_epi16(x, 8)), 8);
+}
+
+__attribute__((target("avx2"))) void cpu_raster_fill_span_avx2(uint8_t* dst, uint32_t count, color_t color) {
+	uint32_t i = 0;
+	if (color.a == 255) {
+		uint32_t packed_color = 0;
+		memcpy(&packed_color, &color, 4);
+		__m256i src = _mm256_set1_epi32(packed_color);
+		for (; i + 8 <= count; i += 8)
+			_mm256_storeu_si256((__m256i*)(dst + i * 4), src);
+	} else {
+		__m256i zero = _mm256_setzero_si256(), inv_alpha = _mm256_set1_epi16(255 - color.a);
+		__m256i src = _mm256_set1_epi64x(
+			(uint64_t)(color.a * color.a + 127) << 48 | (uint64_t)(color.b * color.a + 127) << 32 |
+			(uint64_t)(color.g * color.a + 127) << 16 | (uint64_t)(color.r * color.a + 127)
+		);
+		for (; i + 8 <= count; i += 8) {
+			__m256i pixels = _mm256_loadu_si256((__m256i*)(dst + i * 4));
+			__m256i lo = _mm256_unpacklo_epi8(pixels, zero), hi = _mm256_unpackhi_epi8(pixels, zero);
+			lo = cpu_raster_div255_avx2(_mm256_add_epi16(_mm256_mullo_epi16(lo, inv_alpha), src));
+			hi = cpu_raster_div255_avx2(_mm256_add_epi16(_mm256_mullo_epi16(hi, inv_alpha), src));
+			_mm256_storeu_si256((__m256i*)(dst + i * 4), _mm256_packus_epi16(lo, hi));
+		}
+	}
+	cpu_raster_fill_span_scalar(dst + i * 4, count - i, color);
+}
+
+__attribute__((target("avx2"))) static inline __m256i cpu_raster_glyph_blend_avx2(__m256i dst, __m256i texels, __m256i color, __m256i color_alpha, __m256i alpha_mask) {
+	texels = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(texels, _MM_SHUFFLE(0, 0, 0, 0)), _MM_SHUFFLE(0, 0, 0, 0));
+	__m256i alpha = cpu_raster_div255_avx2(_mm256_add_epi16(_mm256_mullo_epi16(texels, color_alpha), _mm256_set1_epi16(127)));
+	__m256i src = _mm256_or_si256(color, _mm256_and_si256(alpha, alpha_mask));
+	__m256i inv_alpha = _mm256_sub_epi16(_mm256_set1_epi16(255), alpha);
+	return cpu_raster_div255_avx2(_mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(src, alpha), _mm256_mullo_epi16(dst, inv_alpha)), _mm256_set1_epi16(127)));
+}
+
+__attribute__((target("avx2"))) void cpu_raster_glyph_span_avx2(uint8_t* dst, const uint8_t* texels, uint32_t count, color_t color) {
+	__m256i zero = _mm256_setzero_si256(), color_alpha = _mm256_set1_epi16(color.a);
+	__m256i color_rgb = _mm256_set1_epi64x((uint64_t)color.b << 32 | (uint64_t)color.g << 16 | color.r);
+	__m256i alpha_mask = _mm256_set1_epi64x((uint64_t)0xffff << 48);
+	uint32_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i pixels = _mm256_loadu_si256((__m256i*)(dst + i * 4)), glyph = _mm256_loadu_si256((const __m256i*)(texels + i * 4));
+		__m256i lo = cpu_raster_glyph_blend_avx2(_mm256_unpacklo_epi8(pixels, zero), _mm256_unpacklo_epi8(glyph, zero), color_rgb, color_alpha, alpha_mask);
+		__m256i hi = cpu_raster_glyph_blend_avx2(_mm256_unpackhi_epi8(pixels, zero), _mm256_unpackhi_epi8(glyph, zero), color_rgb, color_alpha, alpha_mask);
+		_mm256_storeu_si256((__m256i*)(dst + i * 4), _mm256_packus_epi16(lo, hi));
+	}
+	cpu_raster_glyph_span_sse2(dst + i * 4, texels + i * 4, count - i, color);
+}
+
+#endif
+
+void (*cpu_raster_fill_span)(uint8_t* dst, uint32_t count, color_t color) = cpu_raster_fill_span_scalar;
+void (*cpu_raster_glyph_span)(uint8_t* dst, const uint8_t* texels, uint32_t count, color_t color) = cpu_raster_glyph_span_scalar;
+
+/**
+ * Selects the span functions for cpu_raster_simd and returns the name of the selected ones. "auto" takes the best
+ * one the CPU supports, an explicitly requested one the CPU doesn't support falls back to scalar.
+ */
+const char* cpu_raster_select_spans() {
+	bool is_auto = (strcmp(cpu_raster_simd, "auto") == 0);
+	#ifdef CPU_RASTER_X86
+	__builtin_cpu_init();
+	if ( (is_auto || strcmp(cpu_raster_simd, "avx2") == 0) && __builtin_cpu_supports("avx2") ) {
+		cpu_raster_fill_span = cpu_raster_fill_span_avx2;
+		cpu_raster_glyph_span = cpu_raster_glyph_span_avx2;
+		return "avx2";
+	} else if ( (is_auto || strcmp(cpu_raster_simd, "sse2") == 0) && __builtin_cpu_supports("sse2") ) {
+		cpu_raster_fill_span = cpu_raster_fill_span_sse2;
+		cpu_raster_glyph_span = cpu_raster_glyph_span_sse2;
+		return "sse2";
+	}
+	#endif
+	cpu_raster_fill_span = cpu_raster_fill_span_scalar;
+	cpu_raster_glyph_span = cpu_raster_glyph_span_scalar;
+	return "scalar";
+}
+
+
+//
+// Drawing
+//
+
+static inline float cpu_raster_smoothstep(float edge0, float edge1, float x) {
+	float t = fminf(fmaxf((x - edge0) / (edge1 - edge0), 0), 1);
+	return t * t * (3 - 2 * t);
+}
+
+static inline uint8_t cpu_raster_unorm8(float value) {
+	return fminf(fmaxf(value, 0), 1) * 255 + 0.5f;
+}
+
+// Same as sdAxisAlignedRect() in the shaders
+static inline float cpu_raster_sd_axis_aligned_rect(float x, float y, float l, float t, float r, float b) {
+	float dx = fmaxf(l - x, x - r), dy = fmaxf(t - y, y - b);
+	return hypotf(fmaxf(0, dx), fmaxf(0, dy)) + fminf(0, fmaxf(dx, dy));
+}
+
+/**
+ * The fragment shader of one_ssbo for every pixel of rect within the clip rect (l t r b) plus blending.
+ */
+static void cpu_raster_draw_rect_generic(cpu_raster_t* raster, const rect_t* rect, int64_t l, int64_t t, int64_t r, int64_t b) {
+	bool use_texture = rect->has_texture || rect->has_texture_array, use_border = rect->has_border || rect->has_rounded_corners;
+	const cpu_texture_t* tex = &raster->textures[rect->texture_index % CPU_RASTER_MAX_TEXTURES];
+	cpu_color_t color = { rect->background_color.r / 255.0f, rect->background_color.g / 255.0f, rect->background_color.b / 255.0f, rect->background_color.a / 255.0f };
+	cpu_color_t border_color = { rect->border_color.r / 255.0f, rect->border_color.g / 255.0f, rect->border_color.b / 255.0f, rect->border_color.a / 255.0f };
+	
+	// The texture coordinates are in texels of level 0 and interpolated across the rect
+	float du_dx = rectf_width(rect->texture_coords) / rectl_width(rect->pos), dv_dy = rectf_height(rect->texture_coords) / rectl_height(rect->pos);
+	float lambda = log2f(fmaxf(fabsf(du_dx), fabsf(dv_dy)));
+	float tex_width = tex->widths[0], tex_height = tex->heights[0];
+	
+	float radius = rect->corner_radius + rect->border_width, border_width = rect->border_width, pixel_width = 1;
+	
+	for (int64_t y = t; y < b; y++) {
+		uint8_t* dst = raster->pixels + (y * raster->width + l) * 4;
+		for (int64_t x = l; x < r; x++, dst += 4) {
+			float px = x + 0.5f, py = y + 0.5f;
+			
+			cpu_color_t content_color = color;
+			if (use_texture) {
+				float u = rect->texture_coords.l + (px - rect->pos.l) * du_dx, v = rect->texture_coords.t + (py - rect->pos.t) * dv_dy;
+				content_color = cpu_texture_sample(tex, u / tex_width, v / tex_height, rect->texture_array_index, lambda);
+			}
+			
+			cpu_color_t frag_color;
+			if (rect->has_glyph) {
+				frag_color = (cpu_color_t){ color.r, color.g, color.b, color.a * content_color.r };
+			} else if (use_border) {
+				float rect_dist = cpu_raster_sd_axis_aligned_rect(px, py, rect->pos.l + radius, rect->pos.t + radius, rect->pos.r - radius, rect->pos.b - radius) - radius;
+				float rect_coverage = 1 - cpu_raster_smoothstep(-pixel_width, 0, rect_dist);
+				float border_inner_transition = 1 - cpu_raster_smoothstep(-border_width, -(border_width + pixel_width), rect_dist);
+				cpu_color_t rect_color = cpu_color_mix(content_color, border_color, border_inner_transition * border_color.a);
+				frag_color = (cpu_color_t){ rect_color.r, rect_color.g, rect_color.b, content_color.a * rect_coverage };
+			} else {
+				frag_color = content_color;
+			}
+			
+			float a = frag_color.a, inv_a = 1 - a;
+			dst[0] = cpu_raster_unorm8(frag_color.r * a + dst[0] / 255.0f * inv_a);
+			dst[1] = cpu_raster_unorm8(frag_color.g * a + dst[1] / 255.0f * inv_a);
+			dst[2] = cpu_raster_unorm8(frag_color.b * a + dst[2] / 255.0f * inv_a);
+			dst[3] = cpu_raster_unorm8(a           * a + dst[3] / 255.0f * inv_a);
+		}
+	}
+}
+
+static void cpu_raster_draw_rect(cpu_raster_t* raster, const rect_t* rect, int64_t l, int64_t t, int64_t r, int64_t b) {
+	bool use_texture = rect->has_texture || rect->has_texture_array, use_border = rect->has_border || rect->has_rounded_corners;
+	
+	if (!use_texture && !use_border && !rect->has_glyph) {
+		for (int64_t y = t; y < b; y++)
+			cpu_raster_fill_span(raster->pixels + (y * raster->width + l) * 4, r - l, rect->background_color);
+		return;
+	}
+	
+	// Glyphs drawn 1:1 from the atlas sample exactly at texel centers. So the texels can be used directly.
+	const cpu_texture_t* tex = &raster->textures[rect->texture_index % CPU_RASTER_MAX_TEXTURES];
+	rectf_t tc = rect->texture_coords;
+	bool unscaled_glyph = rect->has_glyph && use_texture && tex->layer_count == 1 && tex->levels[0] != NULL
+		&& rectf_width(tc) == rectl_width(rect->pos) && rectf_height(tc) == rectl_height(rect->pos)
+		&& tc.l == floorf(tc.l) && tc.t == floorf(tc.t) && tc.l >= 0 && tc.t >= 0 && tc.r <= tex->widths[0] && tc.b <= tex->heights[0];
+	if (unscaled_glyph) {
+		for (int64_t y = t; y < b; y++) {
+			const uint8_t* texels = tex->levels[0] + (((int64_t)tc.t + y - rect->pos.t) * tex->widths[0] + (int64_t)tc.l + l - rect->pos.l) * 4;
+			cpu_raster_glyph_span(raster->pixels + (y * raster->width + l) * 4, texels, r - l, rect->background_color);
+		}
+		return;
+	}
+	
+	// Borders and rounded corners only change pixels near the edges. Pixel centers at least corner_radius +
+	// 2 * border_width + 1 away from every edge get rect_coverage 1 and border_inner_transition 0, so the shader
+	// outputs the plain content color there and a solid color becomes a normal fill.
+	if (use_border && !use_texture && !rect->has_glyph) {
+		float inset = rect->corner_radius + 2 * rect->border_width + 1;
+		int64_t il = rect->pos.l + (int64_t)ceilf(inset - 0.5f), ir = rect->pos.r - (int64_t)ceilf(inset + 0.5f) + 1;
+		int64_t it = rect->pos.t + (int64_t)ceilf(inset - 0.5f), ib = rect->pos.b - (int64_t)ceilf(inset + 0.5f) + 1;
+		il = (il < l) ? l : (il > r) ? r : il;
+		ir = (ir < il) ? il : (ir > r) ? r : ir;
+		it = (it < t) ? t : (it > b) ? b : it;
+		ib = (ib < it) ? it : (ib > b) ? b : ib;
+		
+		cpu_raster_draw_rect_generic(raster, rect, l,  t,  r,  it);
+		cpu_raster_draw_rect_generic(raster, rect, l,  it, il, ib);
+		for (int64_t y = it; y < ib; y++)
+			cpu_raster_fill_span(raster->pixels + (y * raster->width + il) * 4, ir - il, rect->background_color);
+		cpu_raster_draw_rect_generic(raster, rect, ir, it, r,  ib);
+		cpu_raster_draw_rect_generic(raster, rect, l,  ib, r,  b);
+		return;
+	}
+	
+	cpu_raster_draw_rect_generic(raster, rect, l, t, r, b);
+}
+
+static void cpu_raster_draw_tiles(cpu_raster_t* raster) {
+	uint32_t tile_count = raster->tiles_x * raster->tiles_y;
+	uint32_t tile_index;
+	while ( (tile_index = __atomic_fetch_add(&raster->next_tile, 1, __ATOMIC_RELAXED)) < tile_count ) {
+		uint32_t tile_x = tile_index % raster->tiles_x, tile_y = tile_index / raster->tiles_x;
+		int64_t tl = tile_x * CPU_RASTER_TILE_SIZE, tt = tile_y * CPU_RASTER_TILE_SIZE;
+		int64_t tr = (tl + CPU_RASTER_TILE_SIZE < raster->width)  ? tl + CPU_RASTER_TILE_SIZE : raster->width;
+		int64_t tb = (tt + CPU_RASTER_TILE_SIZE < raster->height) ? tt + CPU_RASTER_TILE_SIZE : raster->height;
+		
+		for (int64_t y = tt; y < tb; y++)
+			cpu_raster_fill_span(raster->pixels + (y * raster->width + tl) * 4, tr - tl, raster->clear_color);
+		
+		for (uint32_t i = raster->tile_row_offsets[tile_y]; i < raster->tile_row_offsets[tile_y + 1]; i++) {
+			const rect_t* rect = &raster->rects[raster->tile_row_rects[i]];
+			int64_t l = (rect->pos.l > tl) ? rect->pos.l : tl, r = (rect->pos.r < tr) ? rect->pos.r : tr;
+			int64_t t = (rect->pos.t > tt) ? rect->pos.t : tt, b = (rect->pos.b < tb) ? rect->pos.b : tb;
+			if (l < r && t < b)
+				cpu_raster_draw_rect(raster, rect, l, t, r, b);
+		}
+	}
+}
+
+static void* cpu_raster_worker(void* arg) {
+	cpu_raster_t* raster = arg;
+	uint32_t done_generation = 0;
+	
+	pthread_mutex_lock(&raster->mutex);
+	while (true) {
+		while (raster->frame_generation == done_generation && !raster->quit)
+			pthread_cond_wait(&raster->work_cond, &raster->mutex);
+		if (raster->quit)
+			break;
+		done_generation = raster->frame_generation;
+		pthread_mutex_unlock(&raster->mutex);
+		
+		cpu_raster_draw_tiles(raster);
+		
+		pthread_mutex_lock(&raster->mutex);
+		raster->workers_busy--;
+		if (raster->workers_busy == 0)
+			pthread_cond_signal(&raster->done_cond);
+	}
+	pthread_mutex_unlock(&raster->mutex);
+	
+	return NULL;
+}
+
+
+/**
+ * Setup of the image and the worker threads. The textures are empty, fill raster->textures[] with
+ * cpu_texture_from_gl() for the texture units the rects use.
+ */
+void cpu_raster_init(cpu_raster_t* raster, uint32_t width, uint32_t height) {
+	*raster = (cpu_raster_t){ .width = width, .height = height };
+	raster->pixels = malloc((size_t)width * height * 4);
+	raster->tiles_x = (width  + CPU_RASTER_TILE_SIZE - 1) / CPU_RASTER_TILE_SIZE;
+	raster->tiles_y = (height + CPU_RASTER_TILE_SIZE - 1) / CPU_RASTER_TILE_SIZE;
+	raster->tile_row_offsets = calloc(raster->tiles_y + 1, sizeof(raster->tile_row_offsets[0]));
+	
+	raster->thread_count = (cpu_raster_threads > 0) ? cpu_raster_threads : (uint32_t)SDL_GetCPUCount();
+	if (raster->thread_count < 1)
+		raster->thread_count = 1;
+	else if (raster->thread_count > CPU_RASTER_MAX_THREADS)
+		raster->thread_count = CPU_RASTER_MAX_THREADS;
+	
+	pthread_mutex_init(&raster->mutex, NULL);
+	pthread_cond_init(&raster->work_cond, NULL);
+	pthread_cond_init(&raster->done_cond, NULL);
+	for (uint32_t i = 1; i < raster->thread_count; i++)
+		pthread_create(&raster->threads[i], NULL, cpu_raster_worker, raster);
+}
+
+void cpu_raster_destroy(cpu_raster_t* raster) {
+	pthread_mutex_lock(&raster->mutex);
+	raster->quit = true;
+	pthread_cond_broadcast(&raster->work_cond);
+	pthread_mutex_unlock(&raster->mutex);
+	for (uint32_t i = 1; i < raster->thread_count; i++)
+		pthread_join(raster->threads[i], NULL);
+	pthread_cond_destroy(&raster->done_cond);
+	pthread_cond_destroy(&raster->work_cond);
+	pthread_mutex_destroy(&raster->mutex);
+	
+	for (uint32_t i = 0; i < CPU_RASTER_MAX_TEXTURES; i++)
+		cpu_texture_destroy(&raster->textures[i]);
+	free(raster->tile_row_rects);
+	free(raster->tile_row_offsets);
+	free(raster->pixels);
+}
+
+/**
+ * Clears the image to clear_color and draws all rects into it. Returns when the image is complete.
+ */
+void cpu_raster_draw(cpu_raster_t* raster, const rect_t* rects, uint32_t rects_count, color_t clear_color) {
+	raster->rects = rects;
+	raster->rects_count = rects_count;
+	raster->clear_color = clear_color;
+	
+	// Bin the rects into tile rows: count per row, prefix sum, then fill in the rect indices (keeps the rect order)
+	int64_t tile_row_of(int64_t y) {
+		return (y < 0) ? 0 : (y >= raster->height) ? raster->tiles_y - 1 : y / CPU_RASTER_TILE_SIZE;
+	}
+	bool is_visible(const rect_t* rect) {
+		return rect->pos.l < rect->pos.r && rect->pos.t < rect->pos.b && rect->pos.r > 0 && rect->pos.b > 0 && rect->pos.l < raster->width && rect->pos.t < raster->height;
+	}
+	
+	uint32_t* offsets = raster->tile_row_offsets;
+	memset(offsets, 0, (raster->tiles_y + 1) * sizeof(offsets[0]));
+	for (uint32_t i = 0; i < rects_count; i++) {
+		if (!is_visible(&rects[i]))
+			continue;
+		for (int64_t row = tile_row_of(rects[i].pos.t); row <= tile_row_of(rects[i].pos.b - 1); row++)
+			offsets[row + 1]++;
+	}
+	for (uint32_t row = 0; row < raster->tiles_y; row++)
+		offsets[row + 1] += offsets[row];
+	
+	if (offsets[raster->tiles_y] > raster->tile_row_rects_capacity) {
+		raster->tile_row_rects_capacity = offsets[raster->tiles_y];
+		raster->tile_row_rects = realloc(raster->tile_row_rects, raster->tile_row_rects_capacity * sizeof(raster->tile_row_rects[0]));
+	}
+	uint32_t fill_positions[raster->tiles_y];
+	memcpy(fill_positions, offsets, raster->tiles_y * sizeof(fill_positions[0]));
+	for (uint32_t i = 0; i < rects_count; i++) {
+		if (!is_visible(&rects[i]))
+			continue;
+		for (int64_t row = tile_row_of(rects[i].pos.t); row <= tile_row_of(rects[i].pos.b - 1); row++)
+			raster->tile_row_rects[fill_positions[row]++] = i;
+	}
+	
+	// Wake up the workers and draw tiles on this thread as well until all are done
+	raster->next_tile = 0;
+	pthread_mutex_lock(&raster->mutex);
+	raster->frame_generation++;
+	raster->workers_busy = raster->thread_count - 1;
+	pthread_cond_broadcast(&raster->work_cond);
+	pthread_mutex_unlock(&raster->mutex);
+	
+	cpu_raster_draw_tiles(raster);
+	
+	pthread_mutex_lock(&raster->mutex);
+	while (raster->workers_busy > 0)
+		pthread_cond_wait(&raster->done_cond, &raster->mutex);
+	pthread_mutex_unlock(&raster->mutex);
+}
+
+
+
+//
+// Shader program cache
+//
+// With --program-cache=dir the linked programs are stored as program binaries (glGetProgramBinary()) in dir and loaded
+// from there (glProgramBinary()) the next time, skipping the compile and link. On software renderers like llvmpipe
+// that's most of the startup time. The files are named after a hash of the shader sources and the GL vendor, renderer
+// and version, so a driver update just leads to new files. Drivers may still reject a binary, then the program is
+// compiled and the file replaced.
+//
+// Layout of a cache file (native byte order since it only works with the same driver anyway):
+//
+//     offset  size
+//          0     4  magic "26PB"
+//          4     4  uint32_t version, 1
+//          8     8  uint64_t key (hash of the sources and driver, the filename is that key in hex)
+//         16     4  uint32_t binary format, as returned by glGetProgramBinary()
+//         20     4  uint32_t binary size
+//         24     -  binary
+//
+
+#define PROGRAM_CACHE_VERSION 1
+typedef struct {
+	char     magic[4];
+	uint32_t version;
+	uint64_t key;
+	uint32_t binary_format, binary_size;
+} program_cache_header_t;
+
+const char* program_cache_dir = NULL;  // --program-cache=dir
+
+uint64_t program_cache_key(bool separable, size_t shader_count, shader_type_and_source_t shaders[shader_count]) {
+	// 64 bit FNV-1a
+	uint64_t hash = 0xcbf29ce484222325;
+	void hash_bytes(const void* data, size_t size) {
+		for (size_t i = 0; i < size; i++)
+			hash = (hash ^ ((const uint8_t*)data)[i]) * 0x100000001b3;
+	}
+	void hash_string(const char* string) {
+		hash_bytes(string, strlen(string) + 1);
+	}
+	
+	// Binaries only work with the driver that created them. Without the cache the key just identifies the program in
+	// the reported times, so skip the glGetString() calls then.
+	if (program_cache_dir) {
+		hash_string((const char*)glGetString(GL_VENDOR));
+		hash_string((const char*)glGetString(GL_RENDERER));
+		hash_string((const char*)glGetString(GL_VERSION));
+	}
+	hash_bytes(&separable, sizeof(separable));
+	for (size_t i = 0; i < shader_count; i++) {
+		hash_bytes(&shaders[i].type, sizeof(shaders[i].type));
+		hash_string(shaders[i].source);
+	}
+	return hash;
+}
+
+char* program_cache_filename(uint64_t key) {
+	char* filename = NULL;
+	asprintf(&filename, "%s/%016" PRIx64 ".bin", program_cache_dir, key);
+	return filename;
+}
+
+/**
+ * Returns the program stored under key or 0 if there is none or the driver rejected it.
+ */
+GLuint program_cache_load(uint64_t key, bool separable) {
+	char* filename = program_cache_filename(key);
+	FILE* f = fopen(filename, "rb");
+	free(filename);
+	if (f == NULL)
+		return 0;
+	
+	program_cache_header_t header;
+	void* binary = NULL;
+	GLuint program = 0;
+	if ( fread(&header, sizeof(header), 1, f) == 1 && memcmp(header.magic, "26PB", 4) == 0 && header.version == PROGRAM_CACHE_VERSION && header.key == key ) {
+		binary = malloc(header.binary_size);
+		if ( fread(binary, header.binary_size, 1, f) == 1 ) {
+			program = glCreateProgram();
+			glProgramParameteri(program, GL_PROGRAM_SEPARABLE, separable);
+			glProgramBinary(program, header.binary_format, binary, header.binary_size);
+			GLint is_linked = GL_FALSE;
+			glGetProgramiv(program, GL_LINK_STATUS, &is_linked);
+			if (!is_linked) {
+				glDeleteProgram(program);
+				program = 0;
+			}
+		}
+	}
+	
+	free(binary);
+	fclose(f);
+	return program;
+}
+
+void program_cache_store(uint64_t key, GLuint program) {
+	GLint binary_size = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binary_size);
+	if (binary_size <= 0)
+		return;
+	program_cache_header_t header = (program_cache_header_t){ .magic = "26PB", .version = PROGRAM_CACHE_VERSION, .key = key, .binary_size = binary_size };
+	void* binary = malloc(binary_size);
+	glGetProgramBinary(program, binary_size, NULL, &header.binary_format, binary);
+	
+	#ifdef _WIN32
+	mkdir(program_cache_dir);
+	#else
+	mkdir(program_cache_dir, 0755);
+	#endif
+	// Write into a temporary file first, parallel runs then never see half written files
+	char* filename = program_cache_filename(key);
+	char* temp_filename = NULL;
+	asprintf(&temp_filename, "%s.%d.tmp", filename, (int)getpid());
+	FILE* f = fopen(temp_filename, "wb");
+	if (f) {
+		bool written = fwrite(&header, sizeof(header), 1, f) == 1 && fwrite(binary, binary_size, 1, f) == 1;
+		written = (fclose(f) == 0) && written;
+		if ( !written || rename(temp_filename, filename) != 0 ) {
+			fprintf(stderr, "Program cache: failed to write %s\n", filename);
+			remove(temp_filename);
+		}
+	} else {
+		fprintf(stderr, "Program cache: can't write %s: %s\n", temp_filename, strerror(errno));
+	}
+	
+	free(temp_filename);
+	free(filename);
+	free(binary);
+}
+
+
+
+//
+// Upload ring
+//
+// With --upload=ring the SSBO approaches don't orphan their buffers with glNamedBufferData() each frame. Instead they
+// write into one persistently and coherently mapped buffer (glNamedBufferStorage()) that is split into
+// UPLOAD_RING_SLOTS slots. Each frame uses the next slot and puts a fence behind the draw that reads it. Before a slot
+// is written again we wait for its fence, so the CPU is at most UPLOAD_RING_SLOTS - 1 frames ahead of the GPU. The time
+// spent waiting shows up in the fence_wt and fence_ct columns. With the default --upload=orphan the driver does all
+// of that internally (or copies the data).
+//
+// The *_dirty approaches use upload_ring_write_changes() instead. Each slot remembers what changed since it was
+// written the last time and only that is copied into it.
+//
+// The *_fused approaches always use a ring and pack their data right into the mapped slot they get from
+// upload_ring_next_slot(). There is no CPU side copy of the data and the gen buffers phase also does the upload.
+//
+
+typedef enum { UPLOAD_ORPHAN = 0, UPLOAD_RING } upload_mode_t;
+upload_mode_t upload_mode = UPLOAD_ORPHAN;  // --upload=orphan|ring
+
+#define UPLOAD_RING_SLOTS 3
+
+typedef struct {
+	GLuint     buffer;
+	uint8_t*   mapping;
+	GLsizeiptr slot_size;
+	uint32_t   slot;
+	GLsync     fences[UPLOAD_RING_SLOTS];
+	dirty_spans_t stale[UPLOAD_RING_SLOTS];  // Elements that changed since each slot was written, see upload_ring_write_changes()
+} upload_ring_t;
+
+/**
+ * slot_size is the most data one frame uploads. It's rounded up so each slot can be bound as an SSBO range.
+ */
+void upload_ring_init(upload_ring_t* ring, GLsizeiptr slot_size) {
+	GLint alignment = 0;
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	if (alignment < 1)
+		alignment = 1;
+	
+	*ring = (upload_ring_t){ 0 };
+	ring->slot_size = ( (slot_size > 0 ? slot_size : 1) + alignment - 1 ) / alignment * alignment;
+	ring->slot = UPLOAD_RING_SLOTS - 1;  // The first upload_ring_write() advances to slot 0
+	
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glCreateBuffers(1, &ring->buffer);
+	glNamedBufferStorage(ring->buffer, ring->slot_size * UPLOAD_RING_SLOTS, NULL, flags);
+	ring->mapping = glMapNamedBufferRange(ring->buffer, 0, ring->slot_size * UPLOAD_RING_SLOTS, flags);
+	
+	// Nothing was written yet, so everything is stale in all slots
+	for (uint32_t i = 0; i < UPLOAD_RING_SLOTS; i++)
+		dirty_spans_add(&ring->stale[i], 0, UINT32_MAX);
+}
+
+/**
+ * Advances to the next slot, waits until the GPU is done with it and returns its mapping.
+ */
+uint8_t* upload_ring_next_slot(upload_ring_t* ring) {
+	ring->slot = (ring->slot + 1) % UPLOAD_RING_SLOTS;
+	
+	GLsync fence = ring->fences[ring->slot];
+	if (fence) {
+		report_fence_wait_start();
+		GLenum result = glClientWaitSync(fence, 0, 0);
+		while (result == GL_TIMEOUT_EXPIRED)
+			result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+		report_fence_wait_done();
+		if (result == GL_WAIT_FAILED)
+			fprintf(stderr, "Upload ring: glClientWaitSync() failed\n");
+		glDeleteSync(fence);
+		ring->fences[ring->slot] = NULL;
+	}
+	return ring->mapping + ring->slot * ring->slot_size;
+}
+
+/**
+ * Advances to the next slot, waits until the GPU is done with it and copies the data into it. Since the mapping is
+ * coherent the data is visible to the following draw without an explicit flush or barrier.
+ */
+void upload_ring_write(upload_ring_t* ring, const void* data, GLsizeiptr size) {
+	assert(size <= ring->slot_size);
+	uint8_t* slot = upload_ring_next_slot(ring);
+	memcpy(slot, data, size);
+	report_upload_bytes(size);
+}
+
+/**
+ * Like upload_ring_write() but data is an array of element_size elements and changes are the elements that changed
+ * since the previous frame. Every slot collects those changes until it's written again and then only copies them.
+ */
+void upload_ring_write_changes(upload_ring_t* ring, const void* data, GLsizeiptr size, const dirty_spans_t* changes, GLsizeiptr element_size) {
+	assert(size <= ring->slot_size);
+	for (uint32_t i = 0; i < UPLOAD_RING_SLOTS; i++)
+		dirty_spans_merge(&ring->stale[i], changes);
+	uint8_t* slot = upload_ring_next_slot(ring);
+	
+	dirty_spans_t* stale = &ring->stale[ring->slot];
+	for (uint32_t i = 0; i < stale->count; i++) {
+		GLsizeiptr begin = stale->spans[i].begin * element_size, end = stale->spans[i].end * element_size;
+		if (begin >= size)
+			break;
+		end = (end < size) ? end : size;
+		memcpy(slot + begin, (const uint8_t*)data + begin, end - begin);
+		report_upload_bytes(end - begin);
+	}
+	dirty_spans_clear(stale);
+}
+
+/**
+ * Copies data into mapped buffer memory with non-temporal stores. That memory is usually write-combined (uncached) and
+ * those stores go straight to it instead of through the caches. Pack a few elements into a small array that stays in
+ * the L1 cache and stream that into the slot, then the data only goes over the memory bus once. Call
+ * upload_stream_done() on each thread that streamed data before the GPU reads it. The stores aren't ordered otherwise.
+ */
+void upload_stream_copy(void* dest, const void* src, size_t size) {
+	#ifdef UPLOAD_STREAM_X86
+	if ((uintptr_t)dest % 16 == 0 && (uintptr_t)src % 16 == 0 && size % 16 == 0) {
+		for (size_t i = 0; i < size; i += 16)
+			_mm_stream_si128((__m128i*)((uint8_t*)dest + i), _mm_load_si128((const __m128i*)((const uint8_t*)src + i)));
+		return;
+	}
+	#endif
+	memcpy(dest, src, size);
+}
+
+void upload_stream_done() {
+	#ifdef UPLOAD_STREAM_X86
+	_mm_sfence();
+	#endif
+}
+
+void upload_ring_bind(upload_ring_t* ring, GLenum target, GLuint index) {
+	glBindBufferRange(target, index, ring->buffer, ring->slot * ring->slot_size, ring->slot_size);
+}
+
+/**
+ * Call after the commands that read the current slot (usually the draw).
+ */
+void upload_ring_fence(upload_ring_t* ring) {
+	ring->fences[ring->slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void upload_ring_destroy(upload_ring_t* ring) {
+	for (uint32_t i = 0; i < UPLOAD_RING_SLOTS; i++) {
+		if (ring->fences[i])
+			glDeleteSync(ring->fences[i]);
+		dirty_spans_destroy(&ring->stale[i]);
+	}
+	glUnmapNamedBuffer(ring->buffer);
+	glDeleteBuffers(1, &ring->buffer);
+	*ring = (upload_ring_t){ 0 };
+}
+
+
+
+//
+// Job system
+//
+// jobs_parallel_for() splits the gen buffers loop of an approach over several threads. It cuts an index range (the
+// rects) into chunks and runs them on the calling thread and thread_count - 1 worker threads. Each thread starts with
+// an equal share of the chunks and takes them from the front of its share. When its share is empty it steals chunks
+// from the back of the other shares, so a thread that got the expensive rects (or was descheduled) doesn't hold up the
+// others. A share is one 64 bit word (next and end chunk) that is only changed via compare and swap, so taking and
+// stealing chunks needs no lock. With one thread jobs_parallel_for() just calls the function for the whole range.
+//
+// Approaches that write a variable number of elements per rect (e.g. the instruction list) count them first, turn the
+// counts into offsets with jobs_exclusive_prefix_sum() and then write each rect at its offset.
+//
+// The job functions are static functions next to their bench function. They get a context struct with whatever the
+// bench function used to share with its loop (args, buffers, offsets). Passing nested functions would need trampolines
+// on the stack and with it an executable stack.
+//
+// --gen-threads=1,2,4 runs every approach once with each thread count (0 is one thread per CPU). The thread count is a
+// column of the sweep CSV and results/gen-scaling.rb lists the gen buffers times per thread count.
+//
+
+#define JOBS_MAX_THREADS        64
+#define JOBS_CHUNKS_PER_THREAD  8     // Chunks in the initial share of each thread, gives the stealing something to work with
+#define JOBS_MIN_CHUNK_SIZE     1024  // Smaller chunks cost more in atomics and cache line transfers than they gain
+
+typedef void (*jobs_func_t)(void* ctx, uint32_t begin, uint32_t end, uint32_t thread_index);
+
+typedef struct {
+	uint64_t chunks __attribute__ ((aligned (64)));  // Next chunk in the low and end chunk in the high 32 bits, own cache line
+} jobs_share_t;
+
+typedef struct {
+	// Worker threads, woken up by incrementing generation
+	uint32_t thread_count;
+	pthread_t threads[JOBS_MAX_THREADS];
+	pthread_mutex_t mutex;
+	pthread_cond_t work_cond, done_cond;
+	uint32_t generation, workers_busy;
+	bool quit;
+	
+	// Current job
+	jobs_func_t func;
+	void* ctx;
+	uint32_t count, chunk_size, chunk_count;
+	jobs_share_t shares[JOBS_MAX_THREADS];
+	
+	uint32_t* chunk_sums;  // Per chunk sums of jobs_exclusive_prefix_sum()
+	uint32_t chunk_sums_capacity;
+} jobs_t;
+
+jobs_t gen_jobs;  // Used by the bench functions for their gen buffers phase, main() sets it up for each --gen-threads= count
+
+/**
+ * Takes the next chunk from the front of the share or steals the last one from its back. Returns false when the
+ * share is empty.
+ */
+static bool jobs_take_chunk(jobs_share_t* share, bool steal, uint32_t* chunk) {
+	uint64_t chunks = __atomic_load_n(&share->chunks, __ATOMIC_RELAXED);
+	while (true) {
+		uint32_t next = chunks, end = chunks >> 32;
+		if (next >= end)
+			return false;
+		uint64_t desired = steal ? ((uint64_t)(end - 1) << 32 | next) : ((uint64_t)end << 32 | (next + 1));
+		if ( __atomic_compare_exchange_n(&share->chunks, &chunks, desired, true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED) ) {
+			*chunk = steal ? end - 1 : next;
+			return true;
+		}
+	}
+}
+
+static void jobs_run_chunks(jobs_t* jobs, uint32_t thread_index) {
+	void run_chunk(uint32_t chunk) {
+		uint32_t begin = chunk * jobs->chunk_size;
+		uint32_t end = (begin + jobs->chunk_size < jobs->count) ? begin + jobs->chunk_size : jobs->count;
+		jobs->func(jobs->ctx, begin, end, thread_index);
+	}
+	
+	uint32_t chunk;
+	while ( jobs_take_chunk(&jobs->shares[thread_index], false, &chunk) )
+		run_chunk(chunk);
+	// Steal from the other threads, starting with the next one so the thieves don't all pick the same victim
+	for (uint32_t i = 1; i < jobs->thread_count; i++) {
+		jobs_share_t* victim = &jobs->shares[(thread_index + i) % jobs->thread_count];
+		while ( jobs_take_chunk(victim, true, &chunk) )
+			run_chunk(chunk);
+	}
+}
+
+static void* jobs_worker(void* arg) {
+	jobs_t* jobs = arg;
+	uint32_t done_generation = 0;
+	
+	pthread_mutex_lock(&jobs->mutex);
+	// The index of this thread is its position in jobs->threads
+	uint32_t thread_index = 1;
+	while ( !pthread_equal(jobs->threads[thread_index], pthread_self()) )
+		thread_index++;
+	
+	while (true) {
+		while (jobs->generation == done_generation && !jobs->quit)
+			pthread_cond_wait(&jobs->work_cond, &jobs->mutex);
+		if (jobs->quit)
+			break;
+		done_generation = jobs->generation;
+		pthread_mutex_unlock(&jobs->mutex);
+		
+		jobs_run_chunks(jobs, thread_index);
+		
+		pthread_mutex_lock(&jobs->mutex);
+		jobs->workers_busy--;
+		if (jobs->workers_busy == 0)
+			pthread_cond_signal(&jobs->done_cond);
+	}
+	pthread_mutex_unlock(&jobs->mutex);
+	
+	return NULL;
+}
+
+static uint32_t jobs_resolve_thread_count(uint32_t thread_count) {
+	if (thread_count == 0)
+		thread_count = SDL_GetCPUCount();
+	return (thread_count < 1) ? 1 : (thread_count > JOBS_MAX_THREADS) ? JOBS_MAX_THREADS : thread_count;
+}
+
+/**
+ * thread_count includes the calling thread, 0 uses one thread per CPU.
+ */
+void jobs_init(jobs_t* jobs, uint32_t thread_count) {
+	*jobs = (jobs_t){ 0 };
+	jobs->thread_count = jobs_resolve_thread_count(thread_count);
+	
+	pthread_mutex_init(&jobs->mutex, NULL);
+	pthread_cond_init(&jobs->work_cond, NULL);
+	pthread_cond_init(&jobs->done_cond, NULL);
+	// Hold the mutex so the workers see all thread IDs when they look up their index
+	pthread_mutex_lock(&jobs->mutex);
+	for (uint32_t i = 1; i < jobs->thread_count; i++)
+		pthread_create(&jobs->threads[i], NULL, jobs_worker, jobs);
+	pthread_mutex_unlock(&jobs->mutex);
+}
+
+void jobs_destroy(jobs_t* jobs) {
+	pthread_mutex_lock(&jobs->mutex);
+	jobs->quit = true;
+	pthread_cond_broadcast(&jobs->work_cond);
+	pthread_mutex_unlock(&jobs->mutex);
+	for (uint32_t i = 1; i < jobs->thread_count; i++)
+		pthread_join(jobs->threads[i], NULL);
+	pthread_cond_destroy(&jobs->done_cond);
+	pthread_cond_destroy(&jobs->work_cond);
+	pthread_mutex_destroy(&jobs->mutex);
+	free(jobs->chunk_sums);
+	*jobs = (jobs_t){ 0 };
+}
+
+/**
+ * Restarts the workers with a different thread count (0 is one thread per CPU). Does nothing when the count is the same.
+ */
+void jobs_set_thread_count(jobs_t* jobs, uint32_t thread_count) {
+	if (jobs_resolve_thread_count(thread_count) == jobs->thread_count)
+		return;
+	jobs_destroy(jobs);
+	jobs_init(jobs, thread_count);
+}
+
+static uint32_t jobs_chunk_size(jobs_t* jobs, uint32_t count) {
+	if (jobs->thread_count == 1)
+		return (count > 0) ? count : 1;
+	uint32_t chunk_size = (count + jobs->thread_count * JOBS_CHUNKS_PER_THREAD - 1) / (jobs->thread_count * JOBS_CHUNKS_PER_THREAD);
+	return (chunk_size > JOBS_MIN_CHUNK_SIZE) ? chunk_size : JOBS_MIN_CHUNK_SIZE;
+}
+
+/**
+ * Calls func once for every chunk of chunk_size indices in 0..count and returns when all are done.
+ */
+static void jobs_run(jobs_t* jobs, uint32_t count, uint32_t chunk_size, jobs_func_t func, void* ctx) {
+	jobs->func = func;
+	jobs->ctx = ctx;
+	jobs->count = count;
+	jobs->chunk_size = chunk_size;
+	jobs->chunk_count = (count + chunk_size - 1) / chunk_size;
+	if (jobs->chunk_count <= 1 || jobs->thread_count == 1) {
+		for (uint32_t begin = 0; begin < count; begin += chunk_size)
+			func(ctx, begin, (begin + chunk_size < count) ? begin + chunk_size : count, 0);
+		return;
+	}
+	
+	for (uint32_t i = 0; i < jobs->thread_count; i++) {
+		uint64_t begin = (uint64_t)jobs->chunk_count * i / jobs->thread_count, end = (uint64_t)jobs->chunk_count * (i + 1) / jobs->thread_count;
+		__atomic_store_n(&jobs->shares[i].chunks, end << 32 | begin, __ATOMIC_RELAXED);
+	}
+	
+	// Wake up the workers and take chunks on this thread as well until all are done
+	pthread_mutex_lock(&jobs->mutex);
+	jobs->generation++;
+	jobs->workers_busy = jobs->thread_count - 1;
+	pthread_cond_broadcast(&jobs->work_cond);
+	pthread_mutex_unlock(&jobs->mutex);
+	
+	jobs_run_chunks(jobs, 0);
+	
+	pthread_mutex_lock(&jobs->mutex);
+	while (jobs->workers_busy > 0)
+		pthread_cond_wait(&jobs->done_cond, &jobs->mutex);
+	pthread_mutex_unlock(&jobs->mutex);
+}
+
+/**
+ * Calls func(ctx, begin, end, thread_index) for chunks of the indices 0..count on all threads and returns when all
+ * chunks are done. thread_index is 0 for the calling thread and below jobs->thread_count, e.g. for per-thread scratch
+ * data.
+ */
+void jobs_parallel_for(jobs_t* jobs, uint32_t count, jobs_func_t func, void* ctx) {
+	if (count > 0)
+		jobs_run(jobs, count, jobs_chunk_size(jobs, count), func, ctx);
+}
+
+typedef struct {
+	uint32_t* values;
+	uint32_t* chunk_sums;
+	uint32_t chunk_size;
+} jobs_prefix_sum_t;
+
+static void jobs_sum_chunk(void* ctx, uint32_t begin, uint32_t end, uint32_t thread_index) {
+	jobs_prefix_sum_t* sum_args = ctx;
+	uint32_t sum = 0;
+	for (uint32_t i = begin; i < end; i++)
+		sum += sum_args->values[i];
+	sum_args->chunk_sums[begin / sum_args->chunk_size] = sum;
+}
+
+static void jobs_scan_chunk(void* ctx, uint32_t begin, uint32_t end, uint32_t thread_index) {
+	jobs_prefix_sum_t* sum_args = ctx;
+	uint32_t sum = sum_args->chunk_sums[begin / sum_args->chunk_size];
+	for (uint32_t i = begin; i < end; i++) {
+		uint32_t value = sum_args->values[i];
+		sum_args->values[i] = sum;
+		sum += value;
+	}
+}
+
+/**
+ * Replaces values with their exclusive prefix sum (values[i] becomes the sum of values[0] to values[i - 1]) and returns
+ * the sum of all values. Each chunk sums up its values, the chunk sums are scanned on the calling thread and then each
+ * chunk scans its values starting at the sum of all chunks before it.
+ */
+uint32_t jobs_exclusive_prefix_sum(jobs_t* jobs, uint32_t* values, uint32_t count) {
+	if (count == 0)
+		return 0;
+	uint32_t chunk_size = jobs_chunk_size(jobs, count), chunk_count = (count + chunk_size - 1) / chunk_size;
+	if (chunk_count > jobs->chunk_sums_capacity) {
+		jobs->chunk_sums_capacity = chunk_count;
+		jobs->chunk_sums = realloc(jobs->chunk_sums, jobs->chunk_sums_capacity * sizeof(jobs->chunk_sums[0]));
+	}
+	uint32_t* chunk_sums = jobs->chunk_sums;
+	jobs_prefix_sum_t sum_args = { .values = values, .chunk_sums = chunk_sums, .chunk_size = chunk_size };
+	
+	jobs_run(jobs, count, chunk_size, jobs_sum_chunk, &sum_args);
+	uint32_t total = 0;
+	for (uint32_t i = 0; i < chunk_count; i++) {
+		uint32_t sum = chunk_sums[i];
+		chunk_sums[i] = total;
+		total += sum;
+	}
+	jobs_run(jobs, count, chunk_size, jobs_scan_chunk, &sum_args);
+	
+	return total;
+}
+
+
+
+//
+// Batch packers
+//
+// The SSBO approaches pack their rects with nested bits() and pack_*() functions, one rect at a time and with a branch
+// for each has_* flag. The *_simd variants of one_ssbo, ssbo_instr_list and ssbo_inlined_instr_6 use the batch
+// packers below instead. pack_batch() loads the fields of PACK_BATCH_SIZE rects into SIMD registers (one field of 4 or
+// 8 rects per register), shifts and masks the bit fields of all of them at once and selects the instructions of each
+// rect with blends instead of branches. The results end up in a pack_batch_t with one array per field. The
+// pack_*_rects() functions then write them out in the format of the approach, with the same values as the nested
+// functions.
+//
+// --gen-simd=auto|avx2|sse4|scalar selects the pack_batch() version like --cpu-raster-simd= does for the rasterizer.
+// The SIMD versions only convert the low 32 bits of the positions, so they have to fit into an int32_t (the packed
+// formats only keep 12 bits anyway).
+//
+
+#define PACK_BATCH_SIZE 8
+
+const char* gen_simd = "auto";  // --gen-simd=auto|avx2|sse4|scalar
+
+// Formats of the *_simd variants, the same as the local types of the bench functions (checked by static asserts there)
+typedef struct { float x, y, z, w; } pack_vec4_t __attribute__ ((aligned (16)));
+typedef struct {
+	uint8_t layer, flags, texture_index, texture_array_index;
+	color_t color;
+	color_t border_color;
+	float border_width;
+	float border_radius;
+	pack_vec4_t pos;
+	pack_vec4_t tex_coords;
+} pack_one_ssbo_rect_t;
+typedef struct { uint32_t header1, header2, color, instr; } pack_instr_list_rect_t;
+typedef struct { uint32_t x, y; } pack_instr_t;
+typedef struct { uint32_t header1, header2, color, padding; pack_instr_t instr[6]; } pack_inlined_instr_rect_t;
+enum { PACK_ONE_SSBO_USE_TEXTURE = (1 << 0), PACK_ONE_SSBO_USE_BORDER = (1 << 1), PACK_ONE_SSBO_GLYPH = (1 << 2) };
+enum { PACK_T_GLYPH = 0, PACK_T_TEXTURE, PACK_T_ROUNDED_RECT_EQU, PACK_T_LINE_EQU, PACK_T_CIRCLE_EQU, PACK_T_BORDER };
+
+// Parts of a pack_batch_t that pack_batch() should fill
+typedef enum { PACK_INSTRS = (1 << 0), PACK_ONE_SSBO = (1 << 1) } pack_parts_t;
+
+typedef struct {
+	// PACK_INSTRS: headers of the instruction list and inlined instruction formats and up to 3 instructions in the
+	// order the shaders expect them. Only the first instr_count[i] instructions of rect i are valid.
+	uint32_t header1[PACK_BATCH_SIZE], header2[PACK_BATCH_SIZE], color[PACK_BATCH_SIZE], instr_count[PACK_BATCH_SIZE];
+	uint32_t instr_x[3][PACK_BATCH_SIZE], instr_y[3][PACK_BATCH_SIZE];
+	// PACK_ONE_SSBO: layer, flags, texture_index and texture_array_index in one word and the converted floats
+	uint32_t one_ssbo_header[PACK_BATCH_SIZE];
+	float    border_radius[PACK_BATCH_SIZE], pos[4][PACK_BATCH_SIZE];
+} pack_batch_t;
+
+static inline uint32_t pack_bits(uint32_t value, uint32_t start_bit_lsb, uint32_t bit_count) {
+	return (value & ((1 << bit_count) - 1)) << start_bit_lsb;
+}
+
+static inline uint32_t pack_color(color_t color) {
+	return pack_bits(color.r, 24, 8) | pack_bits(color.g, 16, 8) | pack_bits(color.b, 8, 8) | pack_bits(color.a, 0, 8);
+}
+
+void pack_batch_scalar(const rect_t* rects, uint32_t count, pack_batch_t* batch, uint32_t parts) {
+	for (uint32_t i = 0; i < count; i++) {
+		const rect_t* r = &rects[i];
+		if (parts & PACK_INSTRS) {
+			batch->header1[i] = pack_bits(r->pos.l, 12, 12) | pack_bits(r->pos.t, 0, 12);
+			batch->header2[i] = pack_bits(r->pos.r, 12, 12) | pack_bits(r->pos.b, 0, 12);
+			batch->color[i] = pack_color(r->background_color);
+			
+			rectl_t tex = (rectl_t){ r->texture_coords.l, r->texture_coords.t, r->texture_coords.r, r->texture_coords.b };
+			uint32_t n = 0;
+			if (r->has_glyph) {
+				batch->instr_x[n][i] = pack_bits(PACK_T_GLYPH, 28, 4) | pack_bits(r->texture_index, 24, 4) | pack_bits(tex.l, 12, 12) | pack_bits(tex.t, 0, 12);
+				batch->instr_y[n][i] = pack_bits(tex.r, 12, 12) | pack_bits(tex.b, 0, 12);
+				n++;
+			} else {
+				if (r->has_texture) {
+					batch->instr_x[n][i] = pack_bits(PACK_T_TEXTURE, 28, 4) | pack_bits(r->texture_index, 24, 4) | pack_bits(tex.l, 12, 12) | pack_bits(tex.t, 0, 12);
+					batch->instr_y[n][i] = pack_bits(r->texture_array_index, 24, 8) | pack_bits(tex.r, 12, 12) | pack_bits(tex.b, 0, 12);
+					n++;
+				}
+				if (r->has_rounded_corners) {
+					batch->instr_x[n][i] = pack_bits(PACK_T_ROUNDED_RECT_EQU, 28, 4) | batch->header1[i];
+					batch->instr_y[n][i] = pack_bits(r->corner_radius, 24, 8) | batch->header2[i];
+					n++;
+				}
+				if (r->has_border) {
+					batch->instr_x[n][i] = pack_bits(PACK_T_BORDER, 28, 4) | pack_bits((int32_t)-(r->border_width), 0, 12);
+					batch->instr_y[n][i] = pack_color(r->border_color);
+					n++;
+				}
+			}
+			batch->instr_count[i] = n;
+		}
+		if (parts & PACK_ONE_SSBO) {
+			uint32_t flags = ((r->has_texture || r->has_texture_array) ? PACK_ONE_SSBO_USE_TEXTURE : 0) | ((r->has_border || r->has_rounded_corners) ? PACK_ONE_SSBO_USE_BORDER : 0) | (r->has_glyph ? PACK_ONE_SSBO_GLYPH : 0);
+			batch->one_ssbo_header[i] = pack_bits(r->texture_array_index, 24, 8) | pack_bits(r->texture_index, 16, 8) | pack_bits(flags, 8, 8);
+			batch->border_radius[i] = r->corner_radius;
+			batch->pos[0][i] = r->pos.l;
+			batch->pos[1][i] = r->pos.t;
+			batch->pos[2][i] = r->pos.r;
+			batch->pos[3][i] = r->pos.b;
+		}
+	}
+}
+
+#ifdef GEN_SIMD_X86
+
+// Both versions work on 32 bit lanes. The bools of a rect are loaded as one word (has_border in the lowest byte) and
+// has_glyph as another one with the padding after it masked out. Partial batches repeat the last rect in the unused
+// lanes so the stores below can always write whole registers.
+
+// Loads the 32 bits at offset of each rect into one lane
+__attribute__((target("sse4.1"))) static inline __m128i pack_load_sse4(const uint8_t* const rects[4], size_t offset) {
+	int32_t values[4];
+	for (uint32_t lane = 0; lane < 4; lane++)
+		memcpy(&values[lane], rects[lane] + offset, sizeof(values[lane]));
+	return _mm_loadu_si128((const __m128i*)values);
+}
+
+__attribute__((target("sse4.1"))) void pack_batch_sse4(const rect_t* rects, uint32_t count, pack_batch_t* batch, uint32_t parts) {
+	for (uint32_t base = 0; base < count; base += 4) {
+		const uint8_t* r[4];
+		for (uint32_t lane = 0; lane < 4; lane++)
+			r[lane] = (const uint8_t*)&rects[(base + lane < count) ? base + lane : count - 1];
+		#define LOAD(offset) pack_load_sse4(r, offset)
+		
+		__m128i zero = _mm_setzero_si128(), one = _mm_set1_epi32(1), mask12 = _mm_set1_epi32(0xfff);
+		__m128i bswap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+		__m128i pos_l = LOAD(offsetof(rect_t, pos.l)), pos_t = LOAD(offsetof(rect_t, pos.t)), pos_r = LOAD(offsetof(rect_t, pos.r)), pos_b = LOAD(offsetof(rect_t, pos.b));
+		__m128i bools = LOAD(offsetof(rect_t, has_border)), glyph01 = _mm_and_si128(LOAD(offsetof(rect_t, has_glyph)), one);
+		__m128i border01 = _mm_and_si128(bools, one), rounded01 = _mm_and_si128(_mm_srli_epi32(bools, 8), one);
+		__m128i texture01 = _mm_and_si128(_mm_srli_epi32(bools, 16), one), texture_array01 = _mm_and_si128(_mm_srli_epi32(bools, 24), one);
+		__m128i texture_index = LOAD(offsetof(rect_t, texture_index)), texture_array_index = LOAD(offsetof(rect_t, texture_array_index));
+		__m128i corner_radius = LOAD(offsetof(rect_t, corner_radius));
+		
+		if (parts & PACK_INSTRS) {
+			__m128i header1 = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(pos_l, mask12), 12), _mm_and_si128(pos_t, mask12));
+			__m128i header2 = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(pos_r, mask12), 12), _mm_and_si128(pos_b, mask12));
+			
+			__m128i tex_l = _mm_cvttps_epi32(_mm_castsi128_ps(LOAD(offsetof(rect_t, texture_coords.l)))), tex_t = _mm_cvttps_epi32(_mm_castsi128_ps(LOAD(offsetof(rect_t, texture_coords.t))));
+			__m128i tex_r = _mm_cvttps_epi32(_mm_castsi128_ps(LOAD(offsetof(rect_t, texture_coords.r)))), tex_b = _mm_cvttps_epi32(_mm_castsi128_ps(LOAD(offsetof(rect_t, texture_coords.b))));
+			__m128i tex_lt = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(texture_index, _mm_set1_epi32(0xf)), 24), _mm_or_si128(_mm_slli_epi32(_mm_and_si128(tex_l, mask12), 12), _mm_and_si128(tex_t, mask12)));
+			__m128i tex_rb = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(tex_r, mask12), 12), _mm_and_si128(tex_b, mask12));
+			__m128i glyph_x   = _mm_or_si128(_mm_set1_epi32(PACK_T_GLYPH << 28), tex_lt),            glyph_y   = tex_rb;
+			__m128i texture_x = _mm_or_si128(_mm_set1_epi32(PACK_T_TEXTURE << 28), tex_lt),          texture_y = _mm_or_si128(_mm_slli_epi32(texture_array_index, 24), tex_rb);
+			__m128i rounded_x = _mm_or_si128(_mm_set1_epi32(PACK_T_ROUNDED_RECT_EQU << 28), header1), rounded_y = _mm_or_si128(_mm_slli_epi32(corner_radius, 24), header2);
+			__m128  border_dist = _mm_xor_ps(_mm_castsi128_ps(LOAD(offsetof(rect_t, border_width))), _mm_set1_ps(-0.0f));
+			__m128i border_x  = _mm_or_si128(_mm_set1_epi32(PACK_T_BORDER << 28), _mm_and_si128(_mm_cvttps_epi32(border_dist), mask12));
+			__m128i border_y  = _mm_shuffle_epi8(LOAD(offsetof(rect_t, border_color)), bswap);
+			
+			// Instructions in the order glyph or (texture, rounded_rect_equ, border), masks are all bits set or cleared
+			__m128i glyph_mask = _mm_sub_epi32(zero, glyph01), texture_mask = _mm_sub_epi32(zero, texture01), rounded_mask = _mm_sub_epi32(zero, rounded01);
+			__m128i instr0_x = _mm_blendv_epi8(_mm_blendv_epi8(_mm_blendv_epi8(border_x, rounded_x, rounded_mask), texture_x, texture_mask), glyph_x, glyph_mask);
+			__m128i instr0_y = _mm_blendv_epi8(_mm_blendv_epi8(_mm_blendv_epi8(border_y, rounded_y, rounded_mask), texture_y, texture_mask), glyph_y, glyph_mask);
+			__m128i instr1_x = _mm_blendv_epi8(border_x, rounded_x, _mm_and_si128(texture_mask, rounded_mask));
+			__m128i instr1_y = _mm_blendv_epi8(border_y, rounded_y, _mm_and_si128(texture_mask, rounded_mask));
+			__m128i instr_count = _mm_blendv_epi8(_mm_add_epi32(_mm_add_epi32(texture01, rounded01), border01), one, glyph_mask);
+			
+			_mm_storeu_si128((__m128i*)&batch->header1[base], header1);
+			_mm_storeu_si128((__m128i*)&batch->header2[base], header2);
+			_mm_storeu_si128((__m128i*)&batch->color[base], _mm_shuffle_epi8(LOAD(offsetof(rect_t, background_color)), bswap));
+			_mm_storeu_si128((__m128i*)&batch->instr_count[base], instr_count);
+			_mm_storeu_si128((__m128i*)&batch->instr_x[0][base], instr0_x);
+			_mm_storeu_si128((__m128i*)&batch->instr_y[0][base], instr0_y);
+			_mm_storeu_si128((__m128i*)&batch->instr_x[1][base], instr1_x);
+			_mm_storeu_si128((__m128i*)&batch->instr_y[1][base], instr1_y);
+			_mm_storeu_si128((__m128i*)&batch->instr_x[2][base], border_x);
+			_mm_storeu_si128((__m128i*)&batch->instr_y[2][base], border_y);
+		}
+		if (parts & PACK_ONE_SSBO) {
+			__m128i flags = _mm_or_si128(_mm_or_si128(texture01, texture_array01), _mm_or_si128(_mm_slli_epi32(_mm_or_si128(border01, rounded01), 1), _mm_slli_epi32(glyph01, 2)));
+			__m128i header = _mm_or_si128(_mm_slli_epi32(texture_array_index, 24), _mm_or_si128(_mm_slli_epi32(_mm_and_si128(texture_index, _mm_set1_epi32(0xff)), 16), _mm_slli_epi32(flags, 8)));
+			_mm_storeu_si128((__m128i*)&batch->one_ssbo_header[base], header);
+			_mm_storeu_ps(&batch->border_radius[base], _mm_cvtepi32_ps(corner_radius));
+			_mm_storeu_ps(&batch->pos[0][base], _mm_cvtepi32_ps(pos_l));
+			_mm_storeu_ps(&batch->pos[1][base], _mm_cvtepi32_ps(pos_t));
+			_mm_storeu_ps(&batch->pos[2][base], _mm_cvtepi32_ps(pos_r));
+			_mm_storeu_ps(&batch->pos[3][base], _mm_cvtepi32_ps(pos_b));
+		}
+		#undef LOAD
+	}
+}
+
+// The AVX2 version gathers each field of all 8 rects with one instruction
+__attribute__((target("avx2"))) void pack_batch_avx2(const rect_t* rects, uint32_t count, pack_batch_t* batch, uint32_t parts) {
+	__m256i offsets = _mm256_mullo_epi32(_mm256_min_epu32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(count - 1)), _mm256_set1_epi32(sizeof(rect_t)));
+	#define LOAD(offset) _mm256_i32gather_epi32((const int*)((const uint8_t*)rects + (offset)), offsets, 1)
+	
+	__m256i zero = _mm256_setzero_si256(), one = _mm256_set1_epi32(1), mask12 = _mm256_set1_epi32(0xfff);
+	__m256i bswap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	__m256i pos_l = LOAD(offsetof(rect_t, pos.l)), pos_t = LOAD(offsetof(rect_t, pos.t)), pos_r = LOAD(offsetof(rect_t, pos.r)), pos_b = LOAD(offsetof(rect_t, pos.b));
+	__m256i bools = LOAD(offsetof(rect_t, has_border)), glyph01 = _mm256_and_si256(LOAD(offsetof(rect_t, has_glyph)), one);
+	__m256i border01 = _mm256_and_si256(bools, one), rounded01 = _mm256_and_si256(_mm256_srli_epi32(bools, 8), one);
+	__m256i texture01 = _mm256_and_si256(_mm256_srli_epi32(bools, 16), one), texture_array01 = _mm256_and_si256(_mm256_srli_epi32(bools, 24), one);
+	__m256i texture_index = LOAD(offsetof(rect_t, texture_index)), texture_array_index = LOAD(offsetof(rect_t, texture_array_index));
+	__m256i corner_radius = LOAD(offsetof(rect_t, corner_radius));
+	
+	if (parts & PACK_INSTRS) {
+		__m256i header1 = _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(pos_l, mask12), 12), _mm256_and_si256(pos_t, mask12));
+		__m256i header2 = _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(pos_r, mask12), 12), _mm256_and_si256(pos_b, mask12));
+		
+		__m256i tex_l = _mm256_cvttps_epi32(_mm256_castsi256_ps(LOAD(offsetof(rect_t, texture_coords.l)))), tex_t = _mm256_cvttps_epi32(_mm256_castsi256_ps(LOAD(offsetof(rect_t, texture_coords.t))));
+		__m256i tex_r = _mm256_cvttps_epi32(_mm256_castsi256_ps(LOAD(offsetof(rect_t, texture_coords.r)))), tex_b = _mm256_cvttps_epi32(_mm256_castsi256_ps(LOAD(offsetof(rect_t, texture_coords.b))));
+		__m256i tex_lt = _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(texture_index, _mm256_set1_epi32(0xf)), 24), _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(tex_l, mask12), 12), _mm256_and_si256(tex_t, mask12)));
+		__m256i tex_rb = _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(tex_r, mask12), 12), _mm256_and_si256(tex_b, mask12));
+		__m256i glyph_x   = _mm256_or_si256(_mm256_set1_epi32(PACK_T_GLYPH << 28), tex_lt),            glyph_y   = tex_rb;
+		__m256i texture_x = _mm256_or_si256(_mm256_set1_epi32(PACK_T_TEXTURE << 28), tex_lt),          texture_y = _mm256_or_si256(_mm256_slli_epi32(texture_array_index, 24), tex_rb);
+		__m256i rounded_x = _mm256_or_si256(_mm256_set1_epi32(PACK_T_ROUNDED_RECT_EQU << 28), header1), rounded_y = _mm256_or_si256(_mm256_slli_epi32(corner_radius, 24), header2);
+		__m256  border_dist = _mm256_xor_ps(_mm256_castsi256_ps(LOAD(offsetof(rect_t, border_width))), _mm256_set1_ps(-0.0f));
+		__m256i border_x  = _mm256_or_si256(_mm256_set1_epi32(PACK_T_BORDER << 28), _mm256_and_si256(_mm256_cvttps_epi32(border_dist), mask12));
+		__m256i border_y  = _mm256_shuffle_epi8(LOAD(offsetof(rect_t, border_color)), bswap);
+		
+		__m256i glyph_mask = _mm256_sub_epi32(zero, glyph01), texture_mask = _mm256_sub_epi32(zero, texture01), rounded_mask = _mm256_sub_epi32(zero, rounded01);
+		__m256i instr0_x = _mm256_blendv_epi8(_mm256_blendv_epi8(_mm256_blendv_epi8(border_x, rounded_x, rounded_mask), texture_x, texture_mask), glyph_x, glyph_mask);
+		__m256i instr0_y = _mm256_blendv_epi8(_mm256_blendv_epi8(_mm256_blendv_epi8(border_y, rounded_y, rounded_mask), texture_y, texture_mask), glyph_y, glyph_mask);
+		__m256i instr1_x = _mm256_blendv_epi8(border_x, rounded_x, _mm256_and_si256(texture_mask, rounded_mask));
+		__m256i instr1_y = _mm256_blendv_epi8(border_y, rounded_y, _mm256_and_si256(texture_mask, rounded_mask));
+		__m256i instr_count = _mm256_blendv_epi8(_mm256_add_epi32(_mm256_add_epi32(texture01, rounded01), border01), one, glyph_mask);
+		
+		_mm256_storeu_si256((__m256i*)batch->header1, header1);
+		_mm256_storeu_si256((__m256i*)batch->header2, header2);
+		_mm256_storeu_si256((__m256i*)batch->color, _mm256_shuffle_epi8(LOAD(offsetof(rect_t, background_color)), bswap));
+		_mm256_storeu_si256((__m256i*)batch->instr_count, instr_count);
+		_mm256_storeu_si256((__m256i*)batch->instr_x[0], instr0_x);
+		_mm256_storeu_si256((__m256i*)batch->instr_y[0], instr0_y);
+		_mm256_storeu_si256((__m256i*)batch->instr_x[1], instr1_x);
+		_mm256_storeu_si256((__m256i*)batch->instr_y[1], instr1_y);
+		_mm256_storeu_si256((__m256i*)batch->instr_x[2], border_x);
+		_mm256_storeu_si256((__m256i*)batch->instr_y[2], border_y);
+	}
+	if (parts & PACK_ONE_SSBO) {
+		__m256i flags = _mm256_or_si256(_mm256_or_si256(texture01, texture_array01), _mm256_or_si256(_mm256_slli_epi32(_mm256_or_si256(border01, rounded01), 1), _mm256_slli_epi32(glyph01, 2)));
+		__m256i header = _mm256_or_si256(_mm256_slli_epi32(texture_array_index, 24), _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(texture_index, _mm256_set1_epi32(0xff)), 16), _mm256_slli_epi32(flags, 8)));
+		_mm256_storeu_si256((__m256i*)batch->one_ssbo_header, header);
+		_mm256_storeu_ps(batch->border_radius, _mm256_cvtepi32_ps(corner_radius));
+		_mm256_storeu_ps(batch->pos[0], _mm256_cvtepi32_ps(pos_l));
+		_mm256_storeu_ps(batch->pos[1], _mm256_cvtepi32_ps(pos_t));
+		_mm256_storeu_ps(batch->pos[2], _mm256_cvtepi32_ps(pos_r));
+		_mm256_storeu_ps(batch->pos[3], _mm256_cvtepi32_ps(pos_b));
+	}
+	#undef LOAD
+}
+
+#endif
+
+void (*pack_batch)(const rect_t* rects, uint32_t count, pack_batch_t* batch, uint32_t parts) = pack_batch_scalar;
+
+/**
+ * Selects the pack_batch() version for gen_simd and returns its name. "auto" takes the best one the CPU supports, an
+ * explicitly requested one the CPU doesn't support falls back to scalar.
+ */
+const char* pack_select_batch() {
+	bool is_auto = (strcmp(gen_simd, "auto") == 0);
+	#ifdef GEN_SIMD_X86
+	__builtin_cpu_init();
+	if ( (is_auto || strcmp(gen_simd, "avx2") == 0) && __builtin_cpu_supports("avx2") ) {
+		pack_batch = pack_batch_avx2;
+		return "avx2";
+	} else if ( (is_auto || strcmp(gen_simd, "sse4") == 0) && __builtin_cpu_supports("sse4.1") ) {
+		pack_batch = pack_batch_sse4;
+		return "sse4";
+	}
+	#endif
+	pack_batch = pack_batch_scalar;
+	return "scalar";
+}
+
+// The pack_*_rects() functions pack the rects begin to end into the buffer of an approach (at the same indices). They
+// can run on several threads as long as the ranges don't overlap.
 
-void report_draw_done() {
-	report_trigger_checkpoint_and_elapsed_timer(RC_DRAW_DONE, RD_PRESENT);
+void pack_one_ssbo_rects(const rect_t* rects, uint32_t begin, uint32_t end, pack_one_ssbo_rect_t* out) {
+	pack_batch_t batch;
+	for (uint32_t base = begin; base < end; base += PACK_BATCH_SIZE) {
+		uint32_t count = (end - base < PACK_BATCH_SIZE) ? end - base : PACK_BATCH_SIZE;
+		pack_batch(rects + base, count, &batch, PACK_ONE_SSBO);
+		for (uint32_t i = 0; i < count; i++) {
+			const rect_t* r = &rects[base + i];
+			pack_one_ssbo_rect_t* o = &out[base + i];
+			memcpy(o, &batch.one_ssbo_header[i], sizeof(batch.one_ssbo_header[i]));
+			o->color = r->background_color;
+			o->border_color = r->border_color;
+			o->border_width = r->border_width;
+			o->border_radius = batch.border_radius[i];
+			o->pos = (pack_vec4_t){ batch.pos[0][i], batch.pos[1][i], batch.pos[2][i], batch.pos[3][i] };
+			o->tex_coords = (pack_vec4_t){ r->texture_coords.l, r->texture_coords.t, r->texture_coords.r, r->texture_coords.b };
+		}
+	}
 }
 
-void report_frame_end() {
-	report_trigger_checkpoint_and_elapsed_timer(RC_FRAME_END, RD_NONE);
-	
-	// Measurements done, from here do the per frame data processing.
-	reported_frame_count++;
-	
-	// Set reporting_query_timers to false to remove the pipeline stall at the end of each frame
-	if (reporting_query_timers) {
-		// Query the last timestamp first (checkpoint frame end) so we get one large pipeline stall. When this is done all other timers are finished because they occured before that. 
-		glGetQueryObjectui64v(report_checkpoints[RC_FRAME_END].gpu_timestamp_id, GL_QUERY_RESULT, &report_checkpoints[RC_FRAME_END].gpu_timestamp_ns);
-		report_query_checkpoints_and_delta_elapsed_timers();
-	}
-	
-	report_update_delta(RD_FRAME,       RC_FRAME_START,      RC_FRAME_END);
-	report_update_delta(RD_GEN_BUFFERS, RC_FRAME_START,      RC_GEN_BUFFERS_DONE);
-	report_update_delta(RD_UPLOAD,      RC_GEN_BUFFERS_DONE, RC_UPLOAD_DONE);
-	report_update_delta(RD_CLEAR,       RC_UPLOAD_DONE,      RC_CLEAR_DONE);
-	report_update_delta(RD_DRAW,        RC_CLEAR_DONE,       RC_DRAW_DONE);
-	report_update_delta(RD_PRESENT,     RC_DRAW_DONE,        RC_FRAME_END);
-	
-	usec_t frame_dt_us = report_checkpoints[RC_FRAME_START].walltime - report_last_frame_start_walltime;
-	report_accu_dt_us += frame_dt_us;
-	report_last_frame_start_walltime = report_checkpoints[RC_FRAME_START].walltime;
-	
-	if (reporting_output_per_frame_data) {
-		// Per-frame log header (duplicated here for reference)
-		//fprintf(stderr,
-		//	"scenario        , approach                  , frame ,"
-		//	"   frame_wt ,   frame_ct ,   frame_gt ,         dt ,"
-		//	"  buffer_wt ,  buffer_ct ,  buffer_gt ,  buffer_ge ,"
-		//	"  upload_wt ,  upload_ct ,  upload_gt ,  upload_ge ,"
-		//	"   clear_wt ,   clear_ct ,   clear_gt ,   clear_ge ,"
-		//	"    draw_wt ,    draw_ct ,    draw_gt ,    draw_ge ,"
-		//	"    pres_wt ,    pres_ct ,    pres_gt ,    pres_ge\n"
-		//);
-		fprintf(stderr,
-			"%-15s , %-25s , %5u ,"
-			" %8"PRIu64"us , %8"PRIu64"us , %8.3lfus , %8"PRIu64"us ,"
-			" %8"PRIu64"us , %8"PRIu64"us , %8.3lfus , %8.3lfus ,"
-			" %8"PRIu64"us , %8"PRIu64"us , %8.3lfus , %8.3lfus ,"
-			" %8"PRIu64"us , %8"PRIu64"us , %8.3lfus , %8.3lfus ,"
-			" %8"PRIu64"us , %8"PRIu64"us , %8.3lfus , %8.3lfus ,"
-			" %8"PRIu64"us , %8"PRIu64"us , %8.3lfus , %8.3lfus\n",
-			report_current_scenario, report_current_approach, reported_frame_count,
-			report_deltas[RD_FRAME      ].walltime, report_deltas[RD_FRAME      ].cpu_time, report_deltas[RD_FRAME      ].gpu_timestamp_ns / 1000.0, frame_dt_us,
-			report_deltas[RD_GEN_BUFFERS].walltime, report_deltas[RD_GEN_BUFFERS].cpu_time, report_deltas[RD_GEN_BUFFERS].gpu_timestamp_ns / 1000.0, report_deltas[RD_GEN_BUFFERS].gpu_elapsed_time_ns / 1000.0,
-			report_deltas[RD_UPLOAD     ].walltime, report_deltas[RD_UPLOAD     ].cpu_time, report_deltas[RD_UPLOAD     ].gpu_timestamp_ns / 1000.0, report_deltas[RD_UPLOAD     ].gpu_elapsed_time_ns / 1000.0,
-			report_deltas[RD_CLEAR      ].walltime, report_deltas[RD_CLEAR      ].cpu_time, report_deltas[RD_CLEAR      ].gpu_timestamp_ns / 1000.0, report_deltas[RD_CLEAR      ].gpu_elapsed_time_ns / 1000.0,
-			report_deltas[RD_DRAW       ].walltime, report_deltas[RD_DRAW       ].cpu_time, report_deltas[RD_DRAW       ].gpu_timestamp_ns / 1000.0, report_deltas[RD_DRAW       ].gpu_elapsed_time_ns / 1000.0,
-			report_deltas[RD_PRESENT    ].walltime, report_deltas[RD_PRESENT    ].cpu_time, report_deltas[RD_PRESENT    ].gpu_timestamp_ns / 1000.0, report_deltas[RD_PRESENT    ].gpu_elapsed_time_ns / 1000.0
-		);
+/**
+ * The instructions of the rects are written one after the other starting at instr_offset. Returns the number of
+ * instructions written.
+ */
+uint32_t pack_instr_list_rects(const rect_t* rects, uint32_t begin, uint32_t end, uint32_t instr_offset, pack_instr_list_rect_t* rects_out, pack_instr_t* instrs_out) {
+	pack_batch_t batch;
+	uint32_t instr_index = instr_offset;
+	for (uint32_t base = begin; base < end; base += PACK_BATCH_SIZE) {
+		uint32_t count = (end - base < PACK_BATCH_SIZE) ? end - base : PACK_BATCH_SIZE;
+		pack_batch(rects + base, count, &batch, PACK_INSTRS);
+		for (uint32_t i = 0; i < count; i++) {
+			uint32_t instr_count = batch.instr_count[i];
+			rects_out[base + i] = (pack_instr_list_rect_t){ .header1 = batch.header1[i], .header2 = batch.header2[i], .color = batch.color[i], .instr = pack_bits(instr_index, 8, 24) | pack_bits(instr_count, 0, 8) };
+			for (uint32_t j = 0; j < instr_count; j++)
+				instrs_out[instr_index + j] = (pack_instr_t){ batch.instr_x[j][i], batch.instr_y[j][i] };
+			instr_index += instr_count;
+		}
 	}
+	return instr_index - instr_offset;
 }
 
-void report_approach_end() {
-	report_trigger_checkpoint_and_elapsed_timer(RC_APPROACH_END, RD_NONE);
-	if (reporting_query_timers)
-		glGetQueryObjectui64v(report_checkpoints[RC_APPROACH_END].gpu_timestamp_id, GL_QUERY_RESULT, &report_checkpoints[RC_APPROACH_END].gpu_timestamp_ns);
-	
-	report_update_delta(RD_APPROACH, RC_APPROACH_START, RC_APPROACH_END);
-	
-	// Output per-approach log (header duplicated here for reference)
-	//fprintf(stdout,
-	//	"scenario        , approach                  ,"
-	//	" approach_wt, approach_ct, approach_gt,"
-	//	"   frame_wt ,   frame_ct ,   frame_gt ,         dt ,"
-	//	"  buffer_wt ,  buffer_ct ,  buffer_gt ,  buffer_ge ,"
-	//	"  upload_wt ,  upload_ct ,  upload_gt ,  upload_ge ,"
-	//	"   clear_wt ,   clear_ct ,   clear_gt ,   clear_ge ,"
-	//	"    draw_wt ,    draw_ct ,    draw_gt ,    draw_ge ,"
-	//	"    pres_wt ,    pres_ct ,    pres_gt ,    pres_ge\n"
-	//);
-	fprintf(stdout,
-		"%-15s , %-25s ,"
-		" %8.3lfms , %8.3lfms , %8.3lfms ,"
-		" %8.3lfms , %8.3lfms , %8.3lfms , %8.3lfms ,"
-		" %8.3lfms , %8.3lfms , %8.3lfms , %8.3lfms ,"
-		" %8.3lfms , %8.3lfms , %8.3lfms , %8.3lfms ,"
-		" %8.3lfms , %8.3lfms , %8.3lfms , %8.3lfms ,"
-		" %8.3lfms , %8.3lfms , %8.3lfms , %8.3lfms ,"
-		" %8.3lfms , %8.3lfms , %8.3lfms , %8.3lfms\n",
-		report_current_scenario, report_current_approach,
-		report_deltas[RD_APPROACH   ].walltime      / 1000.0, report_deltas[RD_APPROACH   ].cpu_time      / 1000.0, report_deltas[RD_APPROACH   ].gpu_timestamp_ns      / 1000000.0,
-		report_deltas[RD_FRAME      ].accu_walltime / 1000.0, report_deltas[RD_FRAME      ].accu_cpu_time / 1000.0, report_deltas[RD_FRAME      ].accu_gpu_timestamp_ns / 1000000.0, report_accu_dt_us / 1000.0,
-		report_deltas[RD_GEN_BUFFERS].accu_walltime / 1000.0, report_deltas[RD_GEN_BUFFERS].accu_cpu_time / 1000.0, report_deltas[RD_GEN_BUFFERS].accu_gpu_timestamp_ns / 1000000.0, report_deltas[RD_GEN_BUFFERS].accu_gpu_elapsed_time_ns / 1000000.0,
-		report_deltas[RD_UPLOAD     ].accu_walltime / 1000.0, report_deltas[RD_UPLOAD     ].accu_cpu_time / 1000.0, report_deltas[RD_UPLOAD     ].accu_gpu_timestamp_ns / 1000000.0, report_deltas[RD_UPLOAD     ].accu_gpu_elapsed_time_ns / 1000000.0,
-		report_deltas[RD_CLEAR      ].accu_walltime / 1000.0, report_deltas[RD_CLEAR      ].accu_cpu_time / 1000.0, report_deltas[RD_CLEAR      ].accu_gpu_timestamp_ns / 1000000.0, report_deltas[RD_CLEAR      ].accu_gpu_elapsed_time_ns / 1000000.0,
-		report_deltas[RD_DRAW       ].accu_walltime / 1000.0, report_deltas[RD_DRAW       ].accu_cpu_time / 1000.0, report_deltas[RD_DRAW       ].accu_gpu_timestamp_ns / 1000000.0, report_deltas[RD_DRAW       ].accu_gpu_elapsed_time_ns / 1000000.0,
-		report_deltas[RD_PRESENT    ].accu_walltime / 1000.0, report_deltas[RD_PRESENT    ].accu_cpu_time / 1000.0, report_deltas[RD_PRESENT    ].accu_gpu_timestamp_ns / 1000000.0, report_deltas[RD_PRESENT    ].accu_gpu_elapsed_time_ns / 1000000.0
-	);
-	
-	// Dump a screenshot of the benchmark
-	if (reporting_capture_last_frames) {
-		char filename[255];
-		snprintf(filename, sizeof(filename), "26-%02u-%s-%s.ppm", report_counter, report_current_scenario, report_current_approach);
-		save_default_framebuffer_as_ppm(filename, GL_FRONT);
+/**
+ * The inlined instructions number their types from 1 on (0 ends the list in the shader), so they're one more than in
+ * pack_batch_t.
+ */
+void pack_inlined_instr_rects(const rect_t* rects, uint32_t begin, uint32_t end, pack_inlined_instr_rect_t* out) {
+	pack_batch_t batch;
+	for (uint32_t base = begin; base < end; base += PACK_BATCH_SIZE) {
+		uint32_t count = (end - base < PACK_BATCH_SIZE) ? end - base : PACK_BATCH_SIZE;
+		pack_batch(rects + base, count, &batch, PACK_INSTRS);
+		for (uint32_t i = 0; i < count; i++) {
+			pack_inlined_instr_rect_t rect = (pack_inlined_instr_rect_t){ .header1 = batch.header1[i], .header2 = batch.header2[i], .color = batch.color[i] };
+			for (uint32_t j = 0; j < batch.instr_count[i]; j++)
+				rect.instr[j] = (pack_instr_t){ batch.instr_x[j][i] + (1 << 28), batch.instr_y[j][i] };
+			out[base + i] = rect;
+		}
 	}
 }
 
@@ -493,7 +4235,9 @@ void report_approach_end() {
 // Benchmarks
 //
 
-// Basically just a copy of load_shader_program() from gl45_helpers.h with GL_PROGRAM_SEPARABLE set so we can use the program for pipeline objects
+// Basically just a copy of load_shader_program() from gl45_helpers.h with GL_PROGRAM_SEPARABLE set so we can use the
+// program for pipeline objects. It also uses the program cache and reports the compile and link times of each program,
+// so all approaches use it (with separable = false) instead of load_shader_program().
 GLuint load_shader_program_separable(bool separable, size_t shader_count, shader_type_and_source_t shaders[shader_count]) {
 	const char* shader_type_name(GLenum type) {
 		switch (type) {
@@ -520,8 +4264,21 @@ GLuint load_shader_program_separable(bool separable, size_t shader_count, shader
 		}
 	}
 	
+	// The key also identifies the program in the reported times
+	uint64_t cache_key = program_cache_key(separable, shader_count, shaders);
+	if (program_cache_dir) {
+		nsec_t binary_start = time_now_ns();
+		GLuint cached_program = program_cache_load(cache_key, separable);
+		if (cached_program) {
+			report_program_loaded(cache_key, "hit", 0, 0, time_now_ns() - binary_start);
+			return cached_program;
+		}
+	}
+	
 	GLuint program = glCreateProgram();
 	
+	// Querying the compile and link status waits for them, so the times include drivers that compile in the background
+	nsec_t compile_start = time_now_ns();
 	for (size_t i = 0; i < shader_count; i++) {
 		GLuint shader = glCreateShader(shaders[i].type);
 		glShaderSource(shader, 1, (const char*[]){ shaders[i].source }, NULL);
@@ -549,12 +4306,19 @@ GLuint load_shader_program_separable(bool separable, size_t shader_count, shader
 	}
 	
 	glProgramParameteri(program, GL_PROGRAM_SEPARABLE, separable);
+	if (program_cache_dir)
+		glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 	
 	// Note: Error reporting needed since linker errors (like missing local group size) are not reported as OpenGL errors
+	nsec_t link_start = time_now_ns();
 	glLinkProgram(program);
 	GLint is_linked = GL_FALSE;
 	glGetProgramiv(program, GL_LINK_STATUS, &is_linked);
 	if (is_linked) {
+		nsec_t link_end = time_now_ns();
+		report_program_loaded(cache_key, program_cache_dir ? "miss" : "off", link_start - compile_start, link_end - link_start, 0);
+		if (program_cache_dir)
+			program_cache_store(cache_key, program);
 		return program;
 	} else {
 		GLint log_size = GL_FALSE;
@@ -578,10 +4342,38 @@ GLuint load_shader_program_separable(bool separable, size_t shader_count, shader
 		return 0;
 }
 
+// How the SDF approaches anti-alias the edges of their shapes
+typedef enum {
+	SDF_AA_SHADER = 0,      // Fades the edges over one pixel in the fragment shader
+	SDF_AA_NONE,            // Hard edges (NO_SDF_AA), evaluated once per pixel like everything else. MSAA only smooths the triangle edges.
+	SDF_AA_NONE_PER_SAMPLE  // Hard edges evaluated for each sample (also SDF_PER_SAMPLE), MSAA smooths the SDF edges as well
+} sdf_aa_t;
+
+const char* sdf_aa_defines(sdf_aa_t sdf_aa) {
+	switch (sdf_aa) {
+		case SDF_AA_SHADER:           return "";
+		case SDF_AA_NONE:             return "#define NO_SDF_AA\n";
+		case SDF_AA_NONE_PER_SAMPLE:  return "#define NO_SDF_AA\n#define SDF_PER_SAMPLE\n";
+	}
+	return "";
+}
+
+/**
+ * Returns a copy of the shader source with the defines (e.g. "#define NO_SDF_AA\n") inserted after the #version line,
+ * so one shader source can be compiled in several variants. Free the result after the program is linked.
+ */
+char* shader_variant(const char* defines, const char* source) {
+	const char* version_end = strchr(source, '\n');
+	version_end = version_end ? version_end + 1 : source;
+	char* variant = NULL;
+	asprintf(&variant, "%.*s%s%s", (int)(version_end - source), source, defines, version_end);
+	return variant;
+}
+
 void bench_one_rect_per_draw(scenario_args_t* args, bool use_program_pipeline) {
 	// Setup
 	int window_width = 0, window_height = 0;
-	SDL_GetWindowSize(args->window, &window_width, &window_height);
+	display_size(args->display, &window_width, &window_height);
 	
 	// Create a VBO and VAO to render a rectangle
 	GLuint rect_vbo = 0, rect_vao = 0;
@@ -695,6 +4487,7 @@ void bench_one_rect_per_draw(scenario_args_t* args, bool use_program_pipeline) {
 	report_approach_start(use_program_pipeline ? "1rect_1draw_pipe" : "1rect_1draw");
 	
 	for (uint32_t frame_index = 0; frame_index < args->frame_count; frame_index++) {
+		animation_next_frame(args);
 		report_frame_start();
 		
 		// This approach doesn't need a GPU buffer we have to write the rects into, so we just do nothing in those steps.
@@ -719,7 +4512,7 @@ void bench_one_rect_per_draw(scenario_args_t* args, bool use_program_pipeline) {
 					
 					glProgramUniform4f(shader_program,  0, r->pos.l, r->pos.t, rectl_width(r->pos), rectl_height(r->pos));  // pos_ltwh
 					glProgramUniform4f(shader_program,  1, r->texture_coords.l, r->texture_coords.t, rectf_width(r->texture_coords), rectf_height(r->texture_coords));  // tex_coords_ltwh
-					glProgramUniform2f(shader_program,  3, window_width / 2, window_height / 2);  // half_window_size
+					glProgramUniform2f(shader_program,  3, window_width / 2.0f, window_height / 2.0f);  // half_window_size
 					glProgramUniform1i(shader_program,  4, r->has_texture);  // use_texture
 					glProgramUniform1i(shader_program,  5, r->has_texture_array);  // use_texture_array
 					glProgramUniform1i(shader_program,  6, r->has_glyph);  // use_glyph
@@ -750,7 +4543,7 @@ void bench_one_rect_per_draw(scenario_args_t* args, bool use_program_pipeline) {
 			
 		report_draw_done();
 			
-			SDL_GL_SwapWindow(args->window);
+			display_present(args->display);
 			
 		report_frame_end();
 	}
@@ -765,13 +4558,295 @@ void bench_one_rect_per_draw(scenario_args_t* args, bool use_program_pipeline) {
 }
 
 
+/**
+ * Same per-rect shader work as bench_one_rect_per_draw() but all rects are drawn with one glMultiDrawArraysIndirect().
+ * Consecutive rects with the same material (texture and flags) form a run and each run is one indirect command that
+ * draws its rects as instances. The per-rect data that used to be uniforms goes into an SSBO. The shader gets the rect
+ * index from an instanced attribute: for instanced attributes OpenGL adds the baseInstance of the command, so with an
+ * attribute buffer that contains 0, 1, 2, ... the attribute is the rect index (gl_DrawID would need GL 4.6 or
+ * ARB_shader_draw_parameters). All textures are bound once. Since the material doesn't change within a draw the
+ * texture lookups in the shader are in uniform control flow per draw.
+ */
+enum mdi_flags_t { MDI_USE_TEXTURE = (1 << 0), MDI_USE_TEXTURE_ARRAY = (1 << 1), MDI_GLYPH = (1 << 2), MDI_USE_BORDER = (1 << 3) };
+typedef struct {
+	float pos_ltwh[4];
+	float tex_coords_ltwh[4];
+	color_t color, border_color;
+	uint32_t flags, texture_index, texture_array_index;
+	float border_width, border_radius;
+	float padding;  // The std430 array stride of the struct is a multiple of 16 because of its vec4s
+} mdi_rect_t;
+
+typedef struct {
+	scenario_args_t* args;
+	mdi_rect_t* rects_cpu_buffer;
+} mdi_pack_t;
+
+// The same values 1rect_1draw sets as uniforms
+static void mdi_pack_rects(void* ctx, uint32_t begin, uint32_t end, uint32_t thread_index) {
+	mdi_pack_t* pack = ctx;
+	for (uint32_t i = begin; i < end; i++) {
+		rect_t* r = &pack->args->rects_ptr[i];
+		pack->rects_cpu_buffer[i] = (mdi_rect_t){
+			.pos_ltwh = { r->pos.l, r->pos.t, rectl_width(r->pos), rectl_height(r->pos) },
+			.tex_coords_ltwh = { r->texture_coords.l, r->texture_coords.t, rectf_width(r->texture_coords), rectf_height(r->texture_coords) },
+			.color = r->background_color, .border_color = r->border_color,
+			.flags = (r->has_texture ? MDI_USE_TEXTURE : 0) | (r->has_texture_array ? MDI_USE_TEXTURE_ARRAY : 0) | (r->has_glyph ? MDI_GLYPH : 0) | (r->has_border ? MDI_USE_BORDER : 0),
+			.texture_index = r->texture_index, .texture_array_index = r->texture_array_index,
+			.border_width = r->border_width, .border_radius = r->corner_radius
+		};
+	}
+}
+
+void bench_multi_draw_indirect(scenario_args_t* args) {
+	// Setup
+	int window_width = 0, window_height = 0;
+	display_size(args->display, &window_width, &window_height);
+	
+	typedef struct {
+		GLuint count, instance_count, first, base_instance;
+	} mdi_draw_arrays_indirect_command_t;
+	mdi_rect_t* rects_cpu_buffer = malloc(args->rects_count * sizeof(rects_cpu_buffer[0]));
+	mdi_draw_arrays_indirect_command_t* commands_cpu_buffer = malloc(args->rects_count * sizeof(commands_cpu_buffer[0]));
+	
+	// Create a VBO with the vertices of one rect and one with the rect indices (0, 1, 2, ...) for the instanced attribute
+	GLuint rect_vbo = 0, index_vbo = 0, vao = 0, ssbo = 0, indirect_buffer = 0;
+	struct { float x, y; } rect_vertices[] = {
+		{ 0, 0 }, // left  top
+		{ 0, 1 }, // left  bottom
+		{ 1, 0 }, // right top
+		{ 0, 1 }, // left  bottom
+		{ 1, 1 }, // right bottom
+		{ 1, 0 }, // right top
+	};
+	glCreateBuffers(1, &rect_vbo);
+	glNamedBufferStorage(rect_vbo, sizeof(rect_vertices), rect_vertices, 0);
+	
+	uint32_t* rect_indices = malloc(args->rects_count * sizeof(rect_indices[0]));
+	for (uint32_t i = 0; i < args->rects_count; i++)
+		rect_indices[i] = i;
+	glCreateBuffers(1, &index_vbo);
+	glNamedBufferStorage(index_vbo, (args->rects_count > 0 ? args->rects_count : 1) * sizeof(rect_indices[0]), rect_indices, 0);
+	free(rect_indices);
+	
+	GLint pos_index_loc = 0, rect_index_loc = 1;
+	glCreateVertexArrays(1, &vao);
+	glVertexArrayVertexBuffer(vao, 0, rect_vbo, 0, sizeof(rect_vertices[0]));  // Use rect_vbo as data source 0
+	glEnableVertexArrayAttrib(vao,  pos_index_loc);
+	glVertexArrayAttribBinding(vao, pos_index_loc, 0);
+	glVertexArrayAttribFormat(vao,  pos_index_loc, 2, GL_FLOAT, GL_FALSE, 0);
+	glVertexArrayVertexBuffer(vao, 1, index_vbo, 0, sizeof(uint32_t));  // Use index_vbo as data source 1, one value per instance
+	glVertexArrayBindingDivisor(vao, 1, 1);
+	glEnableVertexArrayAttrib(vao,  rect_index_loc);
+	glVertexArrayAttribBinding(vao, rect_index_loc, 1);
+	glVertexArrayAttribIFormat(vao, rect_index_loc, 1, GL_UNSIGNED_INT, 0);
+	
+	glCreateBuffers(1, &ssbo);
+	glCreateBuffers(1, &indirect_buffer);
+	
+	GLuint program = load_shader_program_separable(false, 2, (shader_type_and_source_t[]){
+		{ GL_VERTEX_SHADER,
+			"#version 450 core\n"
+			"\n"
+			"layout(location = 0) uniform vec2 half_window_size;\n"
+			"\n"
+			"struct rect_data_t {\n"
+			"	vec4  pos_ltwh;\n"
+			"	vec4  tex_coords_ltwh;\n"
+			"	uint  packed_color, packed_border_color;\n"
+			"	uint  flags, texture_index, texture_array_index;\n"
+			"	float border_width, border_radius;\n"
+			"};\n"
+			"layout(std430, binding = 0) readonly buffer RectData {\n"
+			"	rect_data_t rects[];\n"
+			"};\n"
+			"\n"
+			"layout(location = 0) in vec2 pos_index;\n"
+			"layout(location = 1) in uint rect_index;  // baseInstance of the command + gl_InstanceID\n"
+			"\n"
+			"out vec2 vertex_tex_coords;\n"
+			"out vec2 vertex_pos_vs;\n"
+			"flat out vec4 vertex_rect_ltrb_vs;\n"
+			"flat out uint vertex_rect_index;\n"
+			"\n"
+			"void main() {\n"
+			"	rect_data_t rect = rects[rect_index];\n"
+			"	vertex_tex_coords = rect.tex_coords_ltwh.xy + pos_index * rect.tex_coords_ltwh.zw;\n"
+			"	vec2 axes_flip = vec2(1, -1);  // to flip y axis from bottom-up (OpenGL standard) to top-down (normal for UIs)\n"
+			"	vertex_rect_ltrb_vs = vec4(rect.pos_ltwh.xy, rect.pos_ltwh.xy + rect.pos_ltwh.zw);\n"
+			"	vertex_pos_vs = rect.pos_ltwh.xy + pos_index * rect.pos_ltwh.zw;\n"
+			"	vertex_rect_index = rect_index;\n"
+			"	gl_Position = vec4((vertex_pos_vs / half_window_size - 1.0) * axes_flip, 0, 1);\n"
+			"}\n"
+		}, { GL_FRAGMENT_SHADER,
+			"#version 450 core\n"
+			"\n"
+			"struct rect_data_t {\n"
+			"	vec4  pos_ltwh;\n"
+			"	vec4  tex_coords_ltwh;\n"
+			"	uint  packed_color, packed_border_color;\n"
+			"	uint  flags, texture_index, texture_array_index;\n"
+			"	float border_width, border_radius;\n"
+			"};\n"
+			"layout(std430, binding = 0) readonly buffer RectData {\n"
+			"	rect_data_t rects[];\n"
+			"};\n"
+			"\n"
+			"layout(binding =  0) uniform sampler2D      glyph_texture;\n"
+			"layout(binding =  1) uniform sampler2D      image_texture;\n"
+			"layout(binding = 12) uniform sampler2DArray texture_array;\n"
+			"\n"
+			"in vec2 vertex_tex_coords;\n"
+			"in vec2 vertex_pos_vs;\n"
+			"flat in vec4 vertex_rect_ltrb_vs;\n"
+			"flat in uint vertex_rect_index;\n"
+			"\n"
+			"out vec4 frag_color;"
+			"\n"
+			"// Function by jozxyqk from https://stackoverflow.com/questions/30545052/calculate-signed-distance-between-point-and-rectangle\n"
+			"// Renamed tl to lt and br to rb to make the meaning of the individual components more obvious\n"
+			"float sdAxisAlignedRect(vec2 uv, vec2 lt, vec2 rb) {\n"
+			"	vec2 d = max(lt-uv, uv-rb);\n"
+			"	return length(max(vec2(0.0), d)) + min(0.0, max(d.x, d.y));\n"
+			"}\n"
+			"\n"
+			"void main() {\n"
+			"	rect_data_t rect = rects[vertex_rect_index];\n"
+			"	bool use_texture = (rect.flags & 1u) != 0, use_texture_array = (rect.flags & 2u) != 0, use_glyph = (rect.flags & 4u) != 0, use_border = (rect.flags & 8u) != 0;\n"
+			"	vec4 vertex_color = unpackUnorm4x8(rect.packed_color);\n"
+			"	vec4 border_color = unpackUnorm4x8(rect.packed_border_color);\n"
+			"	\n"
+			"	vec4 content_color = vertex_color;\n"
+			"	if (use_texture && !use_texture_array) {\n"
+			"		if (rect.texture_index == 0)\n"
+			"			content_color = texture(glyph_texture, vertex_tex_coords / textureSize(glyph_texture, 0));\n"
+			"		else\n"
+			"			content_color = texture(image_texture, vertex_tex_coords / textureSize(image_texture, 0));\n"
+			"	} else if (use_texture_array) {\n"
+			"		content_color = texture(texture_array, vec3(vertex_tex_coords / textureSize(texture_array, 0).xy, rect.texture_array_index));\n"
+			"	}\n"
+			"	if (use_glyph) {\n"
+			"		frag_color = vec4(vertex_color.rgb, vertex_color.a * content_color.r);\n"
+			"	} else if (use_border) {\n"
+			"		float r = rect.border_radius + rect.border_width;\n"
+			"		float rect_dist = sdAxisAlignedRect(vertex_pos_vs, vertex_rect_ltrb_vs.xy + r, vertex_rect_ltrb_vs.zw - r) - r;\n"
+			"		float pixel_width = dFdx(vertex_pos_vs.x) * 1;  // Use 2.0 for a smoother AA look\n"
+			"		float rect_coverage = 1 - smoothstep(-pixel_width, 0, rect_dist);\n"
+			"		float border_inner_transition = 1 - smoothstep(-rect.border_width, -(rect.border_width + pixel_width), rect_dist);\n"
+			"		\n"
+			"		vec4 rect_color = vec4(mix(content_color.rgb, border_color.rgb, border_inner_transition * border_color.a), content_color.a);\n"
+			"		frag_color = vec4(rect_color.rgb, rect_color.a * rect_coverage);\n"
+			"	} else {\n"
+			"		frag_color = content_color;\n"
+			"	}\n"
+			"}\n"
+		}
+	});
+	
+	report_approach_start("mdi_runs");
+	
+	for (uint32_t frame_index = 0; frame_index < args->frame_count; frame_index++) {
+		animation_next_frame(args);
+		report_frame_start();
+			
+			jobs_parallel_for(&gen_jobs, args->rects_count, mdi_pack_rects, &(mdi_pack_t){ .args = args, .rects_cpu_buffer = rects_cpu_buffer });
+			
+			// One command per run of rects with the same material, the draw order stays the same
+			uint32_t command_count = 0;
+			for (uint32_t i = 0; i < args->rects_count; i++) {
+				mdi_rect_t* rect = &rects_cpu_buffer[i];
+				if (command_count > 0) {
+					mdi_draw_arrays_indirect_command_t* command = &commands_cpu_buffer[command_count - 1];
+					mdi_rect_t* run_rect = &rects_cpu_buffer[command->base_instance];
+					if (rect->flags == run_rect->flags && rect->texture_index == run_rect->texture_index) {
+						command->instance_count++;
+						continue;
+					}
+				}
+				commands_cpu_buffer[command_count++] = (mdi_draw_arrays_indirect_command_t){
+					.count = sizeof(rect_vertices) / sizeof(rect_vertices[0]), .instance_count = 1, .first = 0, .base_instance = i
+				};
+			}
+			
+		report_gen_buffers_done();
+			
+			glNamedBufferData(ssbo, args->rects_count * sizeof(rects_cpu_buffer[0]), rects_cpu_buffer, GL_STREAM_DRAW);
+			report_upload_bytes(args->rects_count * sizeof(rects_cpu_buffer[0]));
+			glNamedBufferData(indirect_buffer, command_count * sizeof(commands_cpu_buffer[0]), commands_cpu_buffer, GL_STREAM_DRAW);
+			report_upload_bytes(command_count * sizeof(commands_cpu_buffer[0]));
+			
+		report_upload_done();
+			
+			glClearColor(0.8, 0.8, 1.0, 1.0);
+			glClear(GL_COLOR_BUFFER_BIT);
+			
+		report_clear_done();
+			
+			glBindVertexArray(vao);
+				glUseProgram(program);
+					glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo);
+					glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer);
+						glProgramUniform2f(program, 0, window_width / 2.0f, window_height / 2.0f);
+						
+						glBindTextureUnit(0, args->glyph_texture);
+						glBindTextureUnit(1, args->image_texture);
+						glBindTextureUnit(12, args->texture_array);
+						
+						glMultiDrawArraysIndirect(GL_TRIANGLES, NULL, command_count, 0);
+					glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+					glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+				glUseProgram(0);
+			glBindVertexArray(0);
+			
+		report_draw_done();
+			
+			display_present(args->display);
+			
+		report_frame_end();
+	}
+	report_approach_end();
+	
+	unload_shader_program(program);
+	glDeleteVertexArrays(1, &vao);
+	glDeleteBuffers(1, &rect_vbo);
+	glDeleteBuffers(1, &index_vbo);
+	glDeleteBuffers(1, &ssbo);
+	glDeleteBuffers(1, &indirect_buffer);
+	free(rects_cpu_buffer);
+	free(commands_cpu_buffer);
+}
+
+
+typedef struct { float x, y; uint8_t r, g, b, a; } simple_vbo_vertex_t;
+
+typedef struct {
+	scenario_args_t* args;
+	simple_vbo_vertex_t* vertices;
+} simple_vbo_pack_t;
+
+static void simple_vbo_pack_rects(void* ctx, uint32_t begin, uint32_t end, uint32_t thread_index) {
+	simple_vbo_pack_t* pack = ctx;
+	scenario_args_t* args = pack->args;
+	simple_vbo_vertex_t* vertices = pack->vertices;
+	const int vertices_per_rect = 6;
+	
+	for (uint32_t i = begin; i < end; i++) {
+		rect_t* r = &args->rects_ptr[i];
+		vertices[i*vertices_per_rect + 0] = (simple_vbo_vertex_t){ .x = r->pos.l, .y = r->pos.t, .r = r->background_color.r, .g = r->background_color.g, .b = r->background_color.b, .a = r->background_color.a };  // left  top
+		vertices[i*vertices_per_rect + 1] = (simple_vbo_vertex_t){ .x = r->pos.l, .y = r->pos.b, .r = r->background_color.r, .g = r->background_color.g, .b = r->background_color.b, .a = r->background_color.a };  // left  bottom
+		vertices[i*vertices_per_rect + 2] = (simple_vbo_vertex_t){ .x = r->pos.r, .y = r->pos.t, .r = r->background_color.r, .g = r->background_color.g, .b = r->background_color.b, .a = r->background_color.a };  // right top
+		vertices[i*vertices_per_rect + 3] = (simple_vbo_vertex_t){ .x = r->pos.l, .y = r->pos.b, .r = r->background_color.r, .g = r->background_color.g, .b = r->background_color.b, .a = r->background_color.a };  // left  bottom
+		vertices[i*vertices_per_rect + 4] = (simple_vbo_vertex_t){ .x = r->pos.r, .y = r->pos.b, .r = r->background_color.r, .g = r->background_color.g, .b = r->background_color.b, .a = r->background_color.a };  // right bottom
+		vertices[i*vertices_per_rect + 5] = (simple_vbo_vertex_t){ .x = r->pos.r, .y = r->pos.t, .r = r->background_color.r, .g = r->background_color.g, .b = r->background_color.b, .a = r->background_color.a };  // right top
+	}
+}
+
 void bench_simple_vertex_buffer_for_all_rects(scenario_args_t* args, bool use_buffer_storage) {
 	// Setup
 	int window_width = 0, window_height = 0;
-	SDL_GetWindowSize(args->window, &window_width, &window_height);
+	display_size(args->display, &window_width, &window_height);
 	
 	// Create a VBO and VAO
-	typedef struct { float x, y; uint8_t r, g, b, a; } simple_vbo_vertex_t;
 	GLuint vbo = 0, vao = 0;
 	glCreateBuffers(1, &vbo);
 	const int vertices_per_rect = 6, vbo_size = args->rects_count * vertices_per_rect * sizeof(simple_vbo_vertex_t);
@@ -790,7 +4865,7 @@ void bench_simple_vertex_buffer_for_all_rects(scenario_args_t* args, bool use_bu
 	glVertexArrayAttribBinding(vao, vertex_color_loc, 0);
 	glVertexArrayAttribFormat( vao, vertex_color_loc, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(simple_vbo_vertex_t, r));
 	
-	GLuint shader_program = load_shader_program(2, (shader_type_and_source_t[]){
+	GLuint shader_program = load_shader_program_separable(false, 2, (shader_type_and_source_t[]){
 		{ GL_VERTEX_SHADER,
 			"#version 450 core\n"
 			"\n"
@@ -821,29 +4896,24 @@ void bench_simple_vertex_buffer_for_all_rects(scenario_args_t* args, bool use_bu
 	report_approach_start(use_buffer_storage ? "simple_vbo_stor" : "simple_vbo");
 	
 	for (uint32_t frame_index = 0; frame_index < args->frame_count; frame_index++) {
+		animation_next_frame(args);
 		report_frame_start();
 			
-			// Update VBO with new data (doesn't change here but would with real usecases)
-			for (uint32_t i = 0; i < args->rects_count; i++) {
-				rect_t* r = &args->rects_ptr[i];
-				vertices[i*vertices_per_rect + 0] = (simple_vbo_vertex_t){ .x = r->pos.l, .y = r->pos.t, .r = r->background_color.r, .g = r->background_color.g, .b = r->background_color.b, .a = r->background_color.a };  // left  top
-				vertices[i*vertices_per_rect + 1] = (simple_vbo_vertex_t){ .x = r->pos.l, .y = r->pos.b, .r = r->background_color.r, .g = r->background_color.g, .b = r->background_color.b, .a = r->background_color.a };  // left  bottom
-				vertices[i*vertices_per_rect + 2] = (simple_vbo_vertex_t){ .x = r->pos.r, .y = r->pos.t, .r = r->background_color.r, .g = r->background_color.g, .b = r->background_color.b, .a = r->background_color.a };  // right top
-				vertices[i*vertices_per_rect + 3] = (simple_vbo_vertex_t){ .x = r->pos.l, .y = r->pos.b, .r = r->background_color.r, .g = r->background_color.g, .b = r->background_color.b, .a = r->background_color.a };  // left  bottom
-				vertices[i*vertices_per_rect + 4] = (simple_vbo_vertex_t){ .x = r->pos.r, .y = r->pos.b, .r = r->background_color.r, .g = r->background_color.g, .b = r->background_color.b, .a = r->background_color.a };  // right bottom
-				vertices[i*vertices_per_rect + 5] = (simple_vbo_vertex_t){ .x = r->pos.r, .y = r->pos.t, .r = r->background_color.r, .g = r->background_color.g, .b = r->background_color.b, .a = r->background_color.a };  // right top
-			}
+			// Update VBO with new data (only changes between frames with --animate=)
+			jobs_parallel_for(&gen_jobs, args->rects_count, simple_vbo_pack_rects, &(simple_vbo_pack_t){ .args = args, .vertices = vertices });
 			
 		report_gen_buffers_done();
 			
 			if (use_buffer_storage) {
 				glInvalidateBufferData(vbo);
 				glNamedBufferSubData(vbo, 0, vbo_size, vertices);
+				report_upload_bytes(vbo_size);
 			} else {
 				// Create a new GPU buffer each time so we don't have to wait for the previous draw call to finish.
 				// Instead the old buffer data gets orphaned and freed once the previous frame is done. This prevents a
 				// pipeline stall on continous refresh.
 				glNamedBufferData(vbo, vbo_size, vertices, GL_STREAM_DRAW);
+				report_upload_bytes(vbo_size);
 			}
 			
 		report_upload_done();
@@ -855,14 +4925,14 @@ void bench_simple_vertex_buffer_for_all_rects(scenario_args_t* args, bool use_bu
 			
 			glBindVertexArray(vao);
 				glUseProgram(shader_program);
-					glProgramUniform2f(shader_program, 0, window_width / 2, window_height / 2);
+					glProgramUniform2f(shader_program, 0, window_width / 2.0f, window_height / 2.0f);
 					glDrawArrays(GL_TRIANGLES, 0, args->rects_count * vertices_per_rect);
 				glUseProgram(0);
 			glBindVertexArray(0);
 			
 		report_draw_done();
 			
-			SDL_GL_SwapWindow(args->window);
+			display_present(args->display);
 			
 		report_frame_end();
 	}
@@ -875,24 +4945,51 @@ void bench_simple_vertex_buffer_for_all_rects(scenario_args_t* args, bool use_bu
 	glDeleteBuffers(1, &vbo);
 }
 
+typedef struct {
+	// Stuff that is actually different per vertex
+	float x, y;
+	float tex_x, tex_y;
+	// Stuff that is just different per rect
+	uint8_t layer, flags, texture_index, texture_array_index;
+	color_t background_color;
+	color_t border_color;
+	float border_width;
+	float border_radius;
+	float pos_l, pos_t, pos_r, pos_b;
+} complete_vbo_vertex_t;
+
+typedef struct {
+	scenario_args_t* args;
+	complete_vbo_vertex_t* vertices;
+} complete_vbo_pack_t;
+
+static void complete_vbo_pack_rects(void* ctx, uint32_t begin, uint32_t end, uint32_t thread_index) {
+	complete_vbo_pack_t* pack = ctx;
+	scenario_args_t* args = pack->args;
+	complete_vbo_vertex_t* vertices = pack->vertices;
+	const int vertices_per_rect = 6;
+	
+	for (uint32_t i = begin; i < end; i++) {
+		rect_t* r = &args->rects_ptr[i];
+		uint32_t flags = 0;
+		if (r->has_texture)                          flags |= 1;
+		if (r->has_glyph)                            flags |= 2;
+		if (r->has_border || r->has_rounded_corners) flags |= 4;
+		vertices[i*vertices_per_rect + 0] = (complete_vbo_vertex_t){ .x = r->pos.l, .y = r->pos.t, .tex_x = r->texture_coords.l, .tex_y = r->texture_coords.t, .pos_l = r->pos.l, .pos_t = r->pos.t, .pos_r = r->pos.r, .pos_b = r->pos.b, .flags = flags, .texture_index = r->texture_index, .texture_array_index = r->texture_array_index, .background_color = r->background_color, .border_color = r->border_color, .border_width = r->border_width, .border_radius = r->corner_radius };  // left  top
+		vertices[i*vertices_per_rect + 1] = (complete_vbo_vertex_t){ .x = r->pos.l, .y = r->pos.b, .tex_x = r->texture_coords.l, .tex_y = r->texture_coords.b, .pos_l = r->pos.l, .pos_t = r->pos.t, .pos_r = r->pos.r, .pos_b = r->pos.b, .flags = flags, .texture_index = r->texture_index, .texture_array_index = r->texture_array_index, .background_color = r->background_color, .border_color = r->border_color, .border_width = r->border_width, .border_radius = r->corner_radius };  // left  bottom
+		vertices[i*vertices_per_rect + 2] = (complete_vbo_vertex_t){ .x = r->pos.r, .y = r->pos.t, .tex_x = r->texture_coords.r, .tex_y = r->texture_coords.t, .pos_l = r->pos.l, .pos_t = r->pos.t, .pos_r = r->pos.r, .pos_b = r->pos.b, .flags = flags, .texture_index = r->texture_index, .texture_array_index = r->texture_array_index, .background_color = r->background_color, .border_color = r->border_color, .border_width = r->border_width, .border_radius = r->corner_radius };  // right top
+		vertices[i*vertices_per_rect + 3] = (complete_vbo_vertex_t){ .x = r->pos.l, .y = r->pos.b, .tex_x = r->texture_coords.l, .tex_y = r->texture_coords.b, .pos_l = r->pos.l, .pos_t = r->pos.t, .pos_r = r->pos.r, .pos_b = r->pos.b, .flags = flags, .texture_index = r->texture_index, .texture_array_index = r->texture_array_index, .background_color = r->background_color, .border_color = r->border_color, .border_width = r->border_width, .border_radius = r->corner_radius };  // left  bottom
+		vertices[i*vertices_per_rect + 4] = (complete_vbo_vertex_t){ .x = r->pos.r, .y = r->pos.b, .tex_x = r->texture_coords.r, .tex_y = r->texture_coords.b, .pos_l = r->pos.l, .pos_t = r->pos.t, .pos_r = r->pos.r, .pos_b = r->pos.b, .flags = flags, .texture_index = r->texture_index, .texture_array_index = r->texture_array_index, .background_color = r->background_color, .border_color = r->border_color, .border_width = r->border_width, .border_radius = r->corner_radius };  // right bottom
+		vertices[i*vertices_per_rect + 5] = (complete_vbo_vertex_t){ .x = r->pos.r, .y = r->pos.t, .tex_x = r->texture_coords.r, .tex_y = r->texture_coords.t, .pos_l = r->pos.l, .pos_t = r->pos.t, .pos_r = r->pos.r, .pos_b = r->pos.b, .flags = flags, .texture_index = r->texture_index, .texture_array_index = r->texture_array_index, .background_color = r->background_color, .border_color = r->border_color, .border_width = r->border_width, .border_radius = r->corner_radius };  // right top
+	}
+}
+
 void bench_complete_vertex_buffer_for_all_rects(scenario_args_t* args) {
 	// Setup
 	int window_width = 0, window_height = 0;
-	SDL_GetWindowSize(args->window, &window_width, &window_height);
+	display_size(args->display, &window_width, &window_height);
 	
 	// Create a VBO and VAO
-	typedef struct {
-		// Stuff that is actually different per vertex
-		float x, y;
-		float tex_x, tex_y;
-		// Stuff that is just different per rect
-		uint8_t layer, flags, texture_index, texture_array_index;
-		color_t background_color;
-		color_t border_color;
-		float border_width;
-		float border_radius;
-		float pos_l, pos_t, pos_r, pos_b;
-	} complete_vbo_vertex_t;
 	GLuint vbo = 0, vao = 0;
 	glCreateBuffers(1, &vbo);
 	const int vertices_per_rect = 6, vbo_size = args->rects_count * vertices_per_rect * sizeof(complete_vbo_vertex_t);
@@ -931,7 +5028,7 @@ void bench_complete_vertex_buffer_for_all_rects(scenario_args_t* args) {
 	glVertexArrayAttribBinding(vao, 9, 0);
 	glVertexArrayAttribFormat( vao, 9, 4, GL_FLOAT, GL_FALSE, offsetof(complete_vbo_vertex_t, pos_l));
 	
-	GLuint shader_program = load_shader_program(2, (shader_type_and_source_t[]){
+	GLuint shader_program = load_shader_program_separable(false, 2, (shader_type_and_source_t[]){
 		{ GL_VERTEX_SHADER,
 			"#version 450 core\n"
 			"\n"
@@ -1058,22 +5155,11 @@ void bench_complete_vertex_buffer_for_all_rects(scenario_args_t* args) {
 	report_approach_start("complete_vbo");
 	
 	for (uint32_t frame_index = 0; frame_index < args->frame_count; frame_index++) {
+		animation_next_frame(args);
 		report_frame_start();
 			
-			// Update VBO with new data (doesn't change here but would with real usecases)
-			for (uint32_t i = 0; i < args->rects_count; i++) {
-				rect_t* r = &args->rects_ptr[i];
-				uint32_t flags = 0;
-				if (r->has_texture)                          flags |= 1;
-				if (r->has_glyph)                            flags |= 2;
-				if (r->has_border || r->has_rounded_corners) flags |= 4;
-				vertices[i*vertices_per_rect + 0] = (complete_vbo_vertex_t){ .x = r->pos.l, .y = r->pos.t, .tex_x = r->texture_coords.l, .tex_y = r->texture_coords.t, .pos_l = r->pos.l, .pos_t = r->pos.t, .pos_r = r->pos.r, .pos_b = r->pos.b, .flags = flags, .texture_index = r->texture_index, .texture_array_index = r->texture_array_index, .background_color = r->background_color, .border_color = r->border_color, .border_width = r->border_width, .border_radius = r->corner_radius };  // left  top
-				vertices[i*vertices_per_rect + 1] = (complete_vbo_vertex_t){ .x = r->pos.l, .y = r->pos.b, .tex_x = r->texture_coords.l, .tex_y = r->texture_coords.b, .pos_l = r->pos.l, .pos_t = r->pos.t, .pos_r = r->pos.r, .pos_b = r->pos.b, .flags = flags, .texture_index = r->texture_index, .texture_array_index = r->texture_array_index, .background_color = r->background_color, .border_color = r->border_color, .border_width = r->border_width, .border_radius = r->corner_radius };  // left  bottom
-				vertices[i*vertices_per_rect + 2] = (complete_vbo_vertex_t){ .x = r->pos.r, .y = r->pos.t, .tex_x = r->texture_coords.r, .tex_y = r->texture_coords.t, .pos_l = r->pos.l, .pos_t = r->pos.t, .pos_r = r->pos.r, .pos_b = r->pos.b, .flags = flags, .texture_index = r->texture_index, .texture_array_index = r->texture_array_index, .background_color = r->background_color, .border_color = r->border_color, .border_width = r->border_width, .border_radius = r->corner_radius };  // right top
-				vertices[i*vertices_per_rect + 3] = (complete_vbo_vertex_t){ .x = r->pos.l, .y = r->pos.b, .tex_x = r->texture_coords.l, .tex_y = r->texture_coords.b, .pos_l = r->pos.l, .pos_t = r->pos.t, .pos_r = r->pos.r, .pos_b = r->pos.b, .flags = flags, .texture_index = r->texture_index, .texture_array_index = r->texture_array_index, .background_color = r->background_color, .border_color = r->border_color, .border_width = r->border_width, .border_radius = r->corner_radius };  // left  bottom
-				vertices[i*vertices_per_rect + 4] = (complete_vbo_vertex_t){ .x = r->pos.r, .y = r->pos.b, .tex_x = r->texture_coords.r, .tex_y = r->texture_coords.b, .pos_l = r->pos.l, .pos_t = r->pos.t, .pos_r = r->pos.r, .pos_b = r->pos.b, .flags = flags, .texture_index = r->texture_index, .texture_array_index = r->texture_array_index, .background_color = r->background_color, .border_color = r->border_color, .border_width = r->border_width, .border_radius = r->corner_radius };  // right bottom
-				vertices[i*vertices_per_rect + 5] = (complete_vbo_vertex_t){ .x = r->pos.r, .y = r->pos.t, .tex_x = r->texture_coords.r, .tex_y = r->texture_coords.t, .pos_l = r->pos.l, .pos_t = r->pos.t, .pos_r = r->pos.r, .pos_b = r->pos.b, .flags = flags, .texture_index = r->texture_index, .texture_array_index = r->texture_array_index, .background_color = r->background_color, .border_color = r->border_color, .border_width = r->border_width, .border_radius = r->corner_radius };  // right top
-			}
+			// Update VBO with new data (only changes between frames with --animate=)
+			jobs_parallel_for(&gen_jobs, args->rects_count, complete_vbo_pack_rects, &(complete_vbo_pack_t){ .args = args, .vertices = vertices });
 			
 		report_gen_buffers_done();
 			
@@ -1081,6 +5167,7 @@ void bench_complete_vertex_buffer_for_all_rects(scenario_args_t* args) {
 			// Instead the old buffer data gets orphaned and freed once the previous frame is done. This prevents a
 			// pipeline stall on continous refresh.
 			glNamedBufferData(vbo, vbo_size, vertices, GL_STREAM_DRAW);
+			report_upload_bytes(vbo_size);
 			
 		report_upload_done();
 			
@@ -1091,7 +5178,7 @@ void bench_complete_vertex_buffer_for_all_rects(scenario_args_t* args) {
 			
 			glBindVertexArray(vao);
 				glUseProgram(shader_program);
-					glProgramUniform2f(shader_program, 0, window_width / 2, window_height / 2);
+					glProgramUniform2f(shader_program, 0, window_width / 2.0f, window_height / 2.0f);
 					
 					glBindTextureUnit(0, args->glyph_texture);
 					glBindTextureUnit(1, args->image_texture);
@@ -1103,7 +5190,7 @@ void bench_complete_vertex_buffer_for_all_rects(scenario_args_t* args) {
 			
 		report_draw_done();
 			
-			SDL_GL_SwapWindow(args->window);
+			display_present(args->display);
 			
 		report_frame_end();
 	}
@@ -1116,26 +5203,89 @@ void bench_complete_vertex_buffer_for_all_rects(scenario_args_t* args) {
 }
 
 
-void bench_one_ssbo(scenario_args_t* args) {
+// How bench_one_ssbo() gets the rects to the GPU each frame
+typedef enum {
+	ONE_SSBO_UPLOAD_ALL = 0,  // Pack all rects into rects_cpu_buffer and upload it (orphaned or via the ring, see --upload=)
+	ONE_SSBO_UPLOAD_CHANGES,  // Pack all rects once, then only the changed ones (see animation_changes()) and only upload those
+	ONE_SSBO_UPLOAD_FUSED     // Pack all rects right into a mapped ring slot with streaming stores, there is no rects_cpu_buffer
+} one_ssbo_upload_t;
+
+enum one_ssbo_flags_t { ONE_SSBO_USE_TEXTURE = (1 << 0), ONE_SSBO_USE_BORDER = (1 << 1), ONE_SSBO_GLYPH = (1 << 2) };
+typedef struct { float x, y, z, w; } one_ssbo_vec4_t __attribute__ ((aligned (16)));
+typedef struct {
+	uint8_t layer, flags, texture_index, texture_array_index;
+	color_t color;
+	color_t border_color;
+	float border_width;
+	float border_radius;
+	// Probably 12 bytes padding / space here.
+	// Use one_ssbo_vec4_t because of 16 byte alignment. We use it as a vec4 in the vertex shader and vec4 has to be 16 byte aligned for the std430 layout.
+	// This is where GLSL expects the data to be. The compiler should add some padding between this one_ssbo_vec4_t and the previous fields as necessary.
+	one_ssbo_vec4_t pos;
+	one_ssbo_vec4_t tex_coords;
+} one_ssbo_rect_t;
+_Static_assert(sizeof(one_ssbo_rect_t) == sizeof(pack_one_ssbo_rect_t) && offsetof(one_ssbo_rect_t, pos) == offsetof(pack_one_ssbo_rect_t, pos), "one_ssbo_rect_t doesn't match the batch packer format");
+
+typedef struct {
+	scenario_args_t* args;
+	bool use_batch_packer;
+	one_ssbo_rect_t* out;  // rects_cpu_buffer or the ring slot
+	uint32_t offset;       // Index of the first rect, e.g. the start of a changed span
+} one_ssbo_pack_t;
+
+// Packs the rects from begin to end into out[0] to out[end - begin - 1]
+static void one_ssbo_pack_rects_into(one_ssbo_pack_t* pack, uint32_t begin, uint32_t end, one_ssbo_rect_t* out) {
+	if (pack->use_batch_packer) {
+		pack_one_ssbo_rects(pack->args->rects_ptr + begin, 0, end - begin, (pack_one_ssbo_rect_t*)out);
+		return;
+	}
+	for (uint32_t i = begin; i < end; i++) {
+		// rectl_t  pos;
+		// color_t  background_color;
+		// bool     has_border, has_rounded_corners, has_texture, has_texture_array, has_glyph;
+		// float    border_width;
+		// color_t  border_color;
+		// uint32_t corner_radius;
+		// GLuint   texture_index;
+		// uint32_t texture_array_index;
+		// rectf_t  texture_coords;
+		// uint32_t random;
+		rect_t* r = &pack->args->rects_ptr[i];
+		out[i - begin] = (one_ssbo_rect_t){
+			.pos = (one_ssbo_vec4_t){ r->pos.l, r->pos.t, r->pos.r, r->pos.b }, .color = r->background_color,
+			.border_width = r->border_width, .border_color = r->border_color, .border_radius = r->corner_radius,
+			.texture_index = r->texture_index, .texture_array_index = r->texture_array_index, .tex_coords = (one_ssbo_vec4_t){ r->texture_coords.l, r->texture_coords.t, r->texture_coords.r, r->texture_coords.b },
+			.flags = ((r->has_texture || r->has_texture_array) ? ONE_SSBO_USE_TEXTURE : 0) | ((r->has_border || r->has_rounded_corners) ? ONE_SSBO_USE_BORDER : 0) | (r->has_glyph ? ONE_SSBO_GLYPH : 0)
+		};
+	}
+}
+
+static void one_ssbo_pack_rects(void* ctx, uint32_t begin, uint32_t end, uint32_t thread_index) {
+	one_ssbo_pack_t* pack = ctx;
+	one_ssbo_pack_rects_into(pack, pack->offset + begin, pack->offset + end, pack->out + pack->offset + begin);
+}
+
+// Packs the rects into a small staging buffer and copies it to pack->out (the mapped slot) with streaming stores
+static void one_ssbo_pack_rects_streamed(void* ctx, uint32_t begin, uint32_t end, uint32_t thread_index) {
+	one_ssbo_pack_t* pack = ctx;
+	one_ssbo_rect_t staging[32];
+	const uint32_t staging_count = sizeof(staging) / sizeof(staging[0]);
+	for (uint32_t batch_begin = begin; batch_begin < end; batch_begin += staging_count) {
+		uint32_t batch_end = (batch_begin + staging_count < end) ? batch_begin + staging_count : end;
+		one_ssbo_pack_rects_into(pack, batch_begin, batch_end, staging);
+		upload_stream_copy(&pack->out[batch_begin], staging, (batch_end - batch_begin) * sizeof(staging[0]));
+	}
+	upload_stream_done();
+}
+
+void bench_one_ssbo(scenario_args_t* args, sdf_aa_t sdf_aa, bool use_batch_packer, one_ssbo_upload_t upload) {
 	// Setup
 	int window_width = 0, window_height = 0;
-	SDL_GetWindowSize(args->window, &window_width, &window_height);
+	display_size(args->display, &window_width, &window_height);
 	
-	enum one_ssbo_flags_t { ONE_SSBO_USE_TEXTURE = (1 << 0), ONE_SSBO_USE_BORDER = (1 << 1), ONE_SSBO_GLYPH = (1 << 2) };
-	typedef struct { float x, y, z, w; } one_ssbo_vec4_t __attribute__ ((aligned (16)));
-	typedef struct {
-		uint8_t layer, flags, texture_index, texture_array_index;
-		color_t color;
-		color_t border_color;
-		float border_width;
-		float border_radius;
-		// Probably 12 bytes padding / space here.
-		// Use one_ssbo_vec4_t because of 16 byte alignment. We use it as a vec4 in the vertex shader and vec4 has to be 16 byte aligned for the std430 layout.
-		// This is where GLSL expects the data to be. The compiler should add some padding between this one_ssbo_vec4_t and the previous fields as necessary.
-		one_ssbo_vec4_t pos;
-		one_ssbo_vec4_t tex_coords;
-	} one_ssbo_rect_t;
-	one_ssbo_rect_t* rects_cpu_buffer = malloc(args->rects_count * sizeof(rects_cpu_buffer[0]));
+	one_ssbo_rect_t* rects_cpu_buffer = (upload != ONE_SSBO_UPLOAD_FUSED) ? malloc(args->rects_count * sizeof(rects_cpu_buffer[0])) : NULL;
+	if (use_batch_packer)
+		pack_select_batch();
 	
 	
 	// All the data goes into the SSBO and we only use an empty VAO for the draw command. The shader then assembles the
@@ -1143,8 +5293,17 @@ void bench_one_ssbo(scenario_args_t* args) {
 	GLuint vao = 0, ssbo = 0;
 	glCreateVertexArrays(1, &vao);
 	glCreateBuffers(1, &ssbo);
-	GLuint program = load_shader_program(2, (shader_type_and_source_t[]){
-		{ GL_VERTEX_SHADER,
+	upload_ring_t ring = { 0 };
+	bool use_ring = (upload_mode == UPLOAD_RING || upload == ONE_SSBO_UPLOAD_FUSED);
+	if (use_ring)
+		upload_ring_init(&ring, args->rects_count * sizeof(rects_cpu_buffer[0]));
+	else if (upload == ONE_SSBO_UPLOAD_CHANGES)
+		glNamedBufferStorage(ssbo, args->rects_count * sizeof(rects_cpu_buffer[0]), NULL, GL_DYNAMIC_STORAGE_BIT);
+	dirty_spans_t changes = { 0 };
+	const char* defines = sdf_aa_defines(sdf_aa);
+	char* vertex_shader = NULL, *fragment_shader = NULL;
+	GLuint program = load_shader_program_separable(false, 2, (shader_type_and_source_t[]){
+		{ GL_VERTEX_SHADER, vertex_shader = shader_variant(defines,
 			"#version 450 core\n"
 			"\n"
 			"layout(location = 0) uniform vec2  half_viewport_size;\n"
@@ -1170,7 +5329,11 @@ void bench_one_ssbo(scenario_args_t* args) {
 			"out vec4  vertex_border_color;\n"
 			"out float vertex_border_radius;\n"
 			"out float vertex_border_width;\n"
-			"out vec2  vertex_pos_vs;\n"
+			"#ifdef SDF_PER_SAMPLE\n"
+			"out sample vec2  vertex_pos_vs;\n"
+			"#else\n"
+			"out vec2         vertex_pos_vs;\n"
+			"#endif\n"
 			"out vec4  vertex_rect_ltrb_ws;\n"
 			"out vec2  vertex_tex_coords;\n"
 			"\n"
@@ -1221,8 +5384,8 @@ void bench_one_ssbo(scenario_args_t* args) {
 			"	//vec2 pos_ndc = vec2(pos_ws - map_center_ws) * map_scale * axes_flip / half_viewport_size;\n"
 			"	vec2 pos_ndc = (pos_vs / half_viewport_size - 1.0) * axes_flip;\n"
 			"	gl_Position = vec4(pos_ndc, 0, 1);\n"
-			"}\n"
-		}, { GL_FRAGMENT_SHADER,
+			"}\n")
+		}, { GL_FRAGMENT_SHADER, fragment_shader = shader_variant(defines,
 			"#version 450 core\n"
 			"\n"
 			"// Note: binding is the number of the texture unit, not the uniform location. We don't care about the uniform location\n"
@@ -1252,7 +5415,11 @@ void bench_one_ssbo(scenario_args_t* args) {
 			"in      vec4  vertex_border_color;\n"
 			"in      float vertex_border_radius;\n"
 			"in      float vertex_border_width;\n"
+			"#ifdef SDF_PER_SAMPLE\n"
+			"in sample vec2  vertex_pos_vs;  // The SDF is evaluated for each sample, MSAA anti-aliases its edges\n"
+			"#else\n"
 			"in      vec2  vertex_pos_vs;\n"
+			"#endif\n"
 			"in      vec4  vertex_rect_ltrb_ws;\n"
 			"in      vec2  vertex_tex_coords;\n"
 			"\n"
@@ -1292,9 +5459,14 @@ void bench_one_ssbo(scenario_args_t* args) {
 			"	} else if ((vertex_flags & RF_USE_BORDER) != 0) {\n"
 			"		float r = vertex_border_radius + vertex_border_width;\n"
 			"		float rect_dist = sdAxisAlignedRect(vertex_pos_vs, vertex_rect_ltrb_ws.xy + r, vertex_rect_ltrb_ws.zw - r) - r;\n"
+			"		#ifdef NO_SDF_AA\n"
+			"		float rect_coverage = (rect_dist < 0) ? 1 : 0;\n"
+			"		float border_inner_transition = (rect_dist > -vertex_border_width) ? 1 : 0;\n"
+			"		#else\n"
 			"		float pixel_width = dFdx(vertex_pos_vs.x) * 1;  // Use 2.0 for a smoother AA look\n"
 			"		float rect_coverage = 1 - smoothstep(-pixel_width, 0, rect_dist);\n"
 			"		float border_inner_transition = 1 - smoothstep(-vertex_border_width, -(vertex_border_width + pixel_width), rect_dist);\n"
+			"		#endif\n"
 			"		//float border_coverage = border_inner_transition * rect_coverage;\n"
 			"		//float content_coverage = (1 - border_inner_transition) * rect_coverage;\n"
 			"		\n"
@@ -1305,33 +5477,36 @@ void bench_one_ssbo(scenario_args_t* args) {
 			"		frag_color = content_color;\n"
 			"	}\n"
 			"}\n"
-		}
+		)}
 	});
+	free(vertex_shader);
+	free(fragment_shader);
 	
-	report_approach_start("one_ssbo");
+	if (upload == ONE_SSBO_UPLOAD_CHANGES)
+		report_approach_start(use_batch_packer ? "one_ssbo_simd_dirty" : "one_ssbo_dirty");
+	else if (upload == ONE_SSBO_UPLOAD_FUSED)
+		report_approach_start(use_batch_packer ? "one_ssbo_simd_fused" : "one_ssbo_fused");
+	else
+		report_approach_start((sdf_aa == SDF_AA_SHADER) ? (use_batch_packer ? "one_ssbo_simd" : "one_ssbo") : (sdf_aa == SDF_AA_NONE) ? "one_ssbo_noaa" : "one_ssbo_msaa_persample");
 	
 	for (uint32_t frame_index = 0; frame_index < args->frame_count; frame_index++) {
+		animation_next_frame(args);
 		report_frame_start();
 			
-			// Update SSBO with new data (doesn't change here but would with real usecases)
-			for (uint32_t i = 0; i < args->rects_count; i++) {
-				// rectl_t  pos;
-				// color_t  background_color;
-				// bool     has_border, has_rounded_corners, has_texture, has_texture_array, has_glyph;
-				// float    border_width;
-				// color_t  border_color;
-				// uint32_t corner_radius;
-				// GLuint   texture_index;
-				// uint32_t texture_array_index;
-				// rectf_t  texture_coords;
-				// uint32_t random;
-				rect_t* r = &args->rects_ptr[i];
-				rects_cpu_buffer[i] = (one_ssbo_rect_t){
-					.pos = (one_ssbo_vec4_t){ r->pos.l, r->pos.t, r->pos.r, r->pos.b }, .color = r->background_color,
-					.border_width = r->border_width, .border_color = r->border_color, .border_radius = r->corner_radius,
-					.texture_index = r->texture_index, .texture_array_index = r->texture_array_index, .tex_coords = (one_ssbo_vec4_t){ r->texture_coords.l, r->texture_coords.t, r->texture_coords.r, r->texture_coords.b },
-					.flags = ((r->has_texture || r->has_texture_array) ? ONE_SSBO_USE_TEXTURE : 0) | ((r->has_border || r->has_rounded_corners) ? ONE_SSBO_USE_BORDER : 0) | (r->has_glyph ? ONE_SSBO_GLYPH : 0)
-				};
+			// Update SSBO with new data (only changes between frames with --animate=)
+			if (upload == ONE_SSBO_UPLOAD_CHANGES) {
+				animation_changes(args, frame_index, &changes);
+				for (uint32_t i = 0; i < changes.count; i++) {
+					uint32_t span_begin = changes.spans[i].begin;
+					jobs_parallel_for(&gen_jobs, changes.spans[i].end - span_begin, one_ssbo_pack_rects, &(one_ssbo_pack_t){ .args = args, .use_batch_packer = use_batch_packer, .out = rects_cpu_buffer, .offset = span_begin });
+				}
+			} else if (upload == ONE_SSBO_UPLOAD_FUSED) {
+				// Waiting for the fence of the slot is part of this phase now
+				one_ssbo_rect_t* slot = (one_ssbo_rect_t*)upload_ring_next_slot(&ring);
+				jobs_parallel_for(&gen_jobs, args->rects_count, one_ssbo_pack_rects_streamed, &(one_ssbo_pack_t){ .args = args, .use_batch_packer = use_batch_packer, .out = slot });
+				report_upload_bytes(args->rects_count * sizeof(slot[0]));
+			} else {
+				jobs_parallel_for(&gen_jobs, args->rects_count, one_ssbo_pack_rects, &(one_ssbo_pack_t){ .args = args, .use_batch_packer = use_batch_packer, .out = rects_cpu_buffer });
 			}
 			
 		report_gen_buffers_done();
@@ -1339,7 +5514,24 @@ void bench_one_ssbo(scenario_args_t* args) {
 			// Create a new GPU buffer each time so we don't have to wait for the previous draw call to finish.
 			// Instead the old buffer data gets orphaned and freed once the previous frame is done. This prevents a
 			// pipeline stall on continous refresh.
-			glNamedBufferData(ssbo, args->rects_count * sizeof(rects_cpu_buffer[0]), rects_cpu_buffer, GL_STREAM_DRAW);
+			// With ONE_SSBO_UPLOAD_CHANGES the buffer keeps its data and we only overwrite the changed spans. The driver
+			// has to take care of draws that still read the buffer. With ONE_SSBO_UPLOAD_FUSED the rects are already in
+			// the slot.
+			if (use_ring && upload == ONE_SSBO_UPLOAD_CHANGES) {
+				upload_ring_write_changes(&ring, rects_cpu_buffer, args->rects_count * sizeof(rects_cpu_buffer[0]), &changes, sizeof(rects_cpu_buffer[0]));
+			} else if (use_ring && upload == ONE_SSBO_UPLOAD_ALL) {
+				upload_ring_write(&ring, rects_cpu_buffer, args->rects_count * sizeof(rects_cpu_buffer[0]));
+			} else if (upload == ONE_SSBO_UPLOAD_CHANGES) {
+				for (uint32_t i = 0; i < changes.count; i++) {
+					GLintptr offset = changes.spans[i].begin * sizeof(rects_cpu_buffer[0]);
+					GLsizeiptr size = (changes.spans[i].end - changes.spans[i].begin) * sizeof(rects_cpu_buffer[0]);
+					glNamedBufferSubData(ssbo, offset, size, &rects_cpu_buffer[changes.spans[i].begin]);
+					report_upload_bytes(size);
+				}
+			} else if (upload == ONE_SSBO_UPLOAD_ALL) {
+				glNamedBufferData(ssbo, args->rects_count * sizeof(rects_cpu_buffer[0]), rects_cpu_buffer, GL_STREAM_DRAW);
+				report_upload_bytes(args->rects_count * sizeof(rects_cpu_buffer[0]));
+			}
 			
 		report_upload_done();
 			
@@ -1350,8 +5542,12 @@ void bench_one_ssbo(scenario_args_t* args) {
 			
 			glBindVertexArray(vao);
 				glUseProgram(program);
-					glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo);
-						glProgramUniform2f(program, 0, window_width / 2, window_height / 2);
+					if (use_ring) {
+						upload_ring_bind(&ring, GL_SHADER_STORAGE_BUFFER, 0);
+					} else {
+						glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo);
+					}
+						glProgramUniform2f(program, 0, window_width / 2.0f, window_height / 2.0f);
 						
 						glBindTextureUnit(0, args->glyph_texture);
 						glBindTextureUnit(1, args->image_texture);
@@ -1362,10 +5558,12 @@ void bench_one_ssbo(scenario_args_t* args) {
 					glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
 				glUseProgram(0);
 			glBindVertexArray(0);
+			if (use_ring)
+				upload_ring_fence(&ring);
 			
 		report_draw_done();
 			
-			SDL_GL_SwapWindow(args->window);
+			display_present(args->display);
 			
 		report_frame_end();
 	}
@@ -1374,14 +5572,42 @@ void bench_one_ssbo(scenario_args_t* args) {
 	unload_shader_program(program);
 	glDeleteVertexArrays(1, &vao);
 	glDeleteBuffers(1, &ssbo);
+	if (use_ring)
+		upload_ring_destroy(&ring);
+	dirty_spans_destroy(&changes);
 	free(rects_cpu_buffer);
 }
 
 
-void bench_ssbo_instruction_list(scenario_args_t* args) {
-	// Setup
-	int window_width = 0, window_height = 0;
-	SDL_GetWindowSize(args->window, &window_width, &window_height);
+typedef struct {       //        24         16          8          0
+	uint32_t header1;  // LLLL LLLL  llll llll  llll tttt  tttt tttt      // L = layer (unused right now), l = left, t = top
+	uint32_t header2;  // ____ ____  rrrr rrrr  rrrr bbbb  bbbb bbbb      // r = right, b = bottom
+	uint32_t color;    // rrrr rrrr  gggg gggg  bbbb bbbb  aaaa aaaa      // r = red, g = green, b = blue, a = alpha
+	uint32_t instr;    // oooo oooo  oooo oooo  oooo oooo  cccc cccc      // o = offset, c = count
+} ssbo_instr_list_rect_t;
+typedef struct { uint32_t x, y; } ssbo_instr_list_instr_t;
+
+typedef struct {
+	scenario_args_t* args;
+	ssbo_instr_list_rect_t* rects_cpu_buffer;
+	ssbo_instr_list_instr_t* instr_cpu_buffer;
+	uint32_t* instr_offsets;  // Offset of the first instruction of each rect, NULL packs the rects one after the other
+	uint32_t instr_count;     // Instructions packed so far when instr_offsets is NULL
+} ssbo_instr_list_pack_t;
+
+static void ssbo_instr_list_count_instrs(void* ctx, uint32_t begin, uint32_t end, uint32_t thread_index) {
+	ssbo_instr_list_pack_t* pack = ctx;
+	for (uint32_t i = begin; i < end; i++) {
+		rect_t* r = &pack->args->rects_ptr[i];
+		pack->instr_offsets[i] = r->has_glyph ? 1 : r->has_texture + r->has_rounded_corners + r->has_border;
+	}
+}
+
+static void ssbo_instr_list_pack_rects(void* ctx, uint32_t begin, uint32_t end, uint32_t thread_index) {
+	ssbo_instr_list_pack_t* pack = ctx;
+	scenario_args_t* args = pack->args;
+	ssbo_instr_list_rect_t* rects_cpu_buffer = pack->rects_cpu_buffer;
+	ssbo_instr_list_instr_t* instr_cpu_buffer = pack->instr_cpu_buffer;
 	
 	// Moves bits into a specific part of the value. The arguments start_bit_lsb and bit_count are the same as used in
 	// the GLSL function bitfieldExtract() to unpack them (`offset` and `bits`).
@@ -1391,12 +5617,6 @@ void bench_ssbo_instruction_list(scenario_args_t* args) {
 		return (value & mask) << start_bit_lsb;
 	}
 	
-	typedef struct {       //        24         16          8          0
-		uint32_t header1;  // LLLL LLLL  llll llll  llll tttt  tttt tttt      // L = layer (unused right now), l = left, t = top
-		uint32_t header2;  // ____ ____  rrrr rrrr  rrrr bbbb  bbbb bbbb      // r = right, b = bottom
-		uint32_t color;    // rrrr rrrr  gggg gggg  bbbb bbbb  aaaa aaaa      // r = red, g = green, b = blue, a = alpha
-		uint32_t instr;    // oooo oooo  oooo oooo  oooo oooo  cccc cccc      // o = offset, c = count
-	} ssbo_instr_list_rect_t;
 	ssbo_instr_list_rect_t pack_rect(uint32_t layer, rectl_t pos, color_t color, uint32_t instr_offset, uint32_t instr_count) {
 		return (ssbo_instr_list_rect_t){
 			.header1 = bits(layer, 24, 8) | bits(pos.l, 12, 12) | bits(pos.t, 0, 12),
@@ -1406,7 +5626,6 @@ void bench_ssbo_instruction_list(scenario_args_t* args) {
 		};
 	}
 	
-	typedef struct { uint32_t x, y; } ssbo_instr_list_instr_t;
 	enum { SSBOIL_T_GLYPH = 0, SSBOIL_T_TEXTURE, SSBOIL_T_ROUNDED_RECT_EQU, SSBOIL_T_LINE_EQU, SSBOIL_T_CIRCLE_EQU, SSBOIL_T_BORDER };
 	ssbo_instr_list_instr_t pack_glyph(uint32_t texture_unit, rectl_t tex_coords) {                                                   // glyph
 		return (ssbo_instr_list_instr_t){                                                                                             //   28   24         16    12    8          0
@@ -1445,10 +5664,60 @@ void bench_ssbo_instruction_list(scenario_args_t* args) {
 		};
 	}
 	
+	// Packs rect i with its instructions starting at instr_offset, returns the number of instructions
+	uint32_t pack_rect_and_instrs(uint32_t i, uint32_t instr_offset) {
+		// rectl_t  pos;
+		// color_t  background_color;
+		// bool     has_border, has_rounded_corners, has_texture, has_texture_array, has_glyph;
+		// float    border_width;
+		// color_t  border_color;
+		// uint32_t corner_radius;
+		// GLuint   texture_index;
+		// uint32_t texture_array_index;
+		// rectf_t  texture_coords;
+		// uint32_t random;
+		rect_t* r = &args->rects_ptr[i];
+		uint32_t instr_count = instr_offset;
+		if (r->has_glyph)
+			instr_cpu_buffer[instr_count++] = pack_glyph(r->texture_index, (rectl_t){r->texture_coords.l, r->texture_coords.t, r->texture_coords.r, r->texture_coords.b});
+		else {
+			if (r->has_texture)
+				instr_cpu_buffer[instr_count++] = pack_texture(r->texture_index, r->texture_array_index, (rectl_t){r->texture_coords.l, r->texture_coords.t, r->texture_coords.r, r->texture_coords.b});
+			if (r->has_rounded_corners)
+				instr_cpu_buffer[instr_count++] = pack_rounded_rect_equ(r->pos, r->corner_radius);
+			if (r->has_border)
+				instr_cpu_buffer[instr_count++] = pack_border(0, -(r->border_width), r->border_color);
+		}
+		rects_cpu_buffer[i] = pack_rect(0, r->pos, r->background_color, instr_offset, instr_count - instr_offset);
+		return instr_count - instr_offset;
+	}
+	
+	for (uint32_t i = begin; i < end; i++) {
+		if (pack->instr_offsets)
+			pack_rect_and_instrs(i, pack->instr_offsets[i]);
+		else
+			pack->instr_count += pack_rect_and_instrs(i, pack->instr_count);
+	}
+}
+
+static void ssbo_instr_list_pack_rects_batched(void* ctx, uint32_t begin, uint32_t end, uint32_t thread_index) {
+	ssbo_instr_list_pack_t* pack = ctx;
+	pack_instr_list_rects(pack->args->rects_ptr, begin, end, pack->instr_offsets[begin], (pack_instr_list_rect_t*)pack->rects_cpu_buffer, (pack_instr_t*)pack->instr_cpu_buffer);
+}
+
+void bench_ssbo_instruction_list(scenario_args_t* args, bool use_batch_packer) {
+	// Setup
+	int window_width = 0, window_height = 0;
+	display_size(args->display, &window_width, &window_height);
+	
 	// CPU side buffers. For the experiment we use a fixed instruction buffer with 4 times the count of the rects buffer and an assert below. Good enough for the experiment.
 	uint32_t max_instr_count = args->rects_count * 4, rects_buffer_size = args->rects_count * sizeof(ssbo_instr_list_rect_t), instr_buffer_size = max_instr_count * sizeof(ssbo_instr_list_instr_t);
 	ssbo_instr_list_rect_t*  rects_cpu_buffer = malloc(rects_buffer_size);
 	ssbo_instr_list_instr_t* instr_cpu_buffer = malloc(instr_buffer_size);
+	uint32_t* instr_offsets = malloc(args->rects_count * sizeof(instr_offsets[0]));
+	_Static_assert(sizeof(ssbo_instr_list_rect_t) == sizeof(pack_instr_list_rect_t) && sizeof(ssbo_instr_list_instr_t) == sizeof(pack_instr_t), "ssbo_instr_list_rect_t doesn't match the batch packer format");
+	if (use_batch_packer)
+		pack_select_batch();
 	
 	// All the data goes into the SSBOs and we only use an empty VAO for the draw command. The shader then assembles the per-vertex data by itself.
 	// An empty VAO should work according to spec, see https://community.khronos.org/t/running-a-vertex-shader-without-any-per-vertex-attribute/69568/4.
@@ -1456,7 +5725,13 @@ void bench_ssbo_instruction_list(scenario_args_t* args) {
 	glCreateVertexArrays(1, &vao);
 	glCreateBuffers(1, &rects_ssbo);
 	glCreateBuffers(1, &instr_ssbo);
-	GLuint program = load_shader_program(2, (shader_type_and_source_t[]){
+	upload_ring_t rects_ring = { 0 };
+	upload_ring_t instr_ring = { 0 };
+	if (upload_mode == UPLOAD_RING) {
+		upload_ring_init(&rects_ring, rects_buffer_size);
+		upload_ring_init(&instr_ring, instr_buffer_size);
+	}
+	GLuint program = load_shader_program_separable(false, 2, (shader_type_and_source_t[]){
 		{ GL_VERTEX_SHADER,
 			"#version 450 core\n"
 			"\n"
@@ -1622,47 +5897,45 @@ void bench_ssbo_instruction_list(scenario_args_t* args) {
 		}
 	});
 	
-	report_approach_start("ssbo_instr_list");
+	report_approach_start(use_batch_packer ? "ssbo_instr_list_simd" : "ssbo_instr_list");
 	
 	for (uint32_t frame_index = 0; frame_index < args->frame_count; frame_index++) {
+		animation_next_frame(args);
 		report_frame_start();
 			
-			// Update SSBOs with new data (doesn't change here but would with real usecases)
+			// Update SSBOs with new data (only changes between frames with --animate=)
 			uint32_t instr_count = 0;
-			for (uint32_t i = 0; i < args->rects_count; i++) {
-				// rectl_t  pos;
-				// color_t  background_color;
-				// bool     has_border, has_rounded_corners, has_texture, has_texture_array, has_glyph;
-				// float    border_width;
-				// color_t  border_color;
-				// uint32_t corner_radius;
-				// GLuint   texture_index;
-				// uint32_t texture_array_index;
-				// rectf_t  texture_coords;
-				// uint32_t random;
-				rect_t* r = &args->rects_ptr[i];
-				uint32_t instr_offset = instr_count;
-				if (r->has_glyph)
-					instr_cpu_buffer[instr_count++] = pack_glyph(r->texture_index, (rectl_t){r->texture_coords.l, r->texture_coords.t, r->texture_coords.r, r->texture_coords.b});
-				else {
-					if (r->has_texture)
-						instr_cpu_buffer[instr_count++] = pack_texture(r->texture_index, r->texture_array_index, (rectl_t){r->texture_coords.l, r->texture_coords.t, r->texture_coords.r, r->texture_coords.b});
-					if (r->has_rounded_corners)
-						instr_cpu_buffer[instr_count++] = pack_rounded_rect_equ(r->pos, r->corner_radius);
-					if (r->has_border)
-						instr_cpu_buffer[instr_count++] = pack_border(0, -(r->border_width), r->border_color);
+			ssbo_instr_list_pack_t pack = { .args = args, .rects_cpu_buffer = rects_cpu_buffer, .instr_cpu_buffer = instr_cpu_buffer };
+			if (gen_jobs.thread_count == 1) {
+				if (use_batch_packer) {
+					instr_count = pack_instr_list_rects(args->rects_ptr, 0, args->rects_count, 0, (pack_instr_list_rect_t*)rects_cpu_buffer, (pack_instr_t*)instr_cpu_buffer);
+				} else {
+					ssbo_instr_list_pack_rects(&pack, 0, args->rects_count, 0);
+					instr_count = pack.instr_count;
 				}
-				rects_cpu_buffer[i] = pack_rect(0, r->pos, r->background_color, instr_offset, instr_count - instr_offset);
-				assert(instr_count <= max_instr_count);
+			} else {
+				// Count the instructions of each rect first, their prefix sum is the offset of the first instruction of each rect
+				pack.instr_offsets = instr_offsets;
+				jobs_parallel_for(&gen_jobs, args->rects_count, ssbo_instr_list_count_instrs, &pack);
+				instr_count = jobs_exclusive_prefix_sum(&gen_jobs, instr_offsets, args->rects_count);
+				jobs_parallel_for(&gen_jobs, args->rects_count, use_batch_packer ? ssbo_instr_list_pack_rects_batched : ssbo_instr_list_pack_rects, &pack);
 			}
+			assert(instr_count <= max_instr_count);
 			
 		report_gen_buffers_done();
 			
 			// Create a new GPU buffer each time so we don't have to wait for the previous draw call to finish.
 			// Instead the old buffer data gets orphaned and freed once the previous frame is done. This prevents a
 			// pipeline stall on continous refresh.
-			glNamedBufferData(rects_ssbo, rects_buffer_size, rects_cpu_buffer, GL_STREAM_DRAW);
-			glNamedBufferData(instr_ssbo, instr_count * sizeof(instr_cpu_buffer[0]), instr_cpu_buffer, GL_STREAM_DRAW);
+			if (upload_mode == UPLOAD_RING) {
+				upload_ring_write(&rects_ring, rects_cpu_buffer, rects_buffer_size);
+				upload_ring_write(&instr_ring, instr_cpu_buffer, instr_count * sizeof(instr_cpu_buffer[0]));
+			} else {
+				glNamedBufferData(rects_ssbo, rects_buffer_size, rects_cpu_buffer, GL_STREAM_DRAW);
+				report_upload_bytes(rects_buffer_size);
+				glNamedBufferData(instr_ssbo, instr_count * sizeof(instr_cpu_buffer[0]), instr_cpu_buffer, GL_STREAM_DRAW);
+				report_upload_bytes(instr_count * sizeof(instr_cpu_buffer[0]));
+			}
 			
 		report_upload_done();
 			
@@ -1673,9 +5946,14 @@ void bench_ssbo_instruction_list(scenario_args_t* args) {
 			
 			glBindVertexArray(vao);
 				glUseProgram(program);
-					glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, rects_ssbo);
-					glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, instr_ssbo);
-						glProgramUniform2f(program, 0, window_width / 2, window_height / 2);
+					if (upload_mode == UPLOAD_RING) {
+						upload_ring_bind(&rects_ring, GL_SHADER_STORAGE_BUFFER, 0);
+						upload_ring_bind(&instr_ring, GL_SHADER_STORAGE_BUFFER, 1);
+					} else {
+						glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, rects_ssbo);
+						glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, instr_ssbo);
+					}
+						glProgramUniform2f(program, 0, window_width / 2.0f, window_height / 2.0f);
 						
 						glBindTextureUnit( 0, args->glyph_texture);
 						glBindTextureUnit( 1, args->image_texture);
@@ -1687,10 +5965,14 @@ void bench_ssbo_instruction_list(scenario_args_t* args) {
 					glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, 0);
 				glUseProgram(0);
 			glBindVertexArray(0);
+			if (upload_mode == UPLOAD_RING) {
+				upload_ring_fence(&rects_ring);
+				upload_ring_fence(&instr_ring);
+			}
 			
 		report_draw_done();
 			
-			SDL_GL_SwapWindow(args->window);
+			display_present(args->display);
 			
 		report_frame_end();
 	}
@@ -1700,14 +5982,33 @@ void bench_ssbo_instruction_list(scenario_args_t* args) {
 	glDeleteVertexArrays(1, &vao);
 	glDeleteBuffers(1, &instr_ssbo);
 	glDeleteBuffers(1, &rects_ssbo);
+	if (upload_mode == UPLOAD_RING) {
+		upload_ring_destroy(&rects_ring);
+		upload_ring_destroy(&instr_ring);
+	}
+	free(instr_offsets);
 	free(instr_cpu_buffer);
 	free(rects_cpu_buffer);
 }
 
-void bench_ssbo_inlined_instr_6(scenario_args_t* args) {
-	// Setup
-	int window_width = 0, window_height = 0;
-	SDL_GetWindowSize(args->window, &window_width, &window_height);
+typedef struct { uint32_t x, y; } ssbo_inlined_instr_instr_t;
+typedef struct {       //        24         16          8          0
+	uint32_t header1;  // LLLL LLLL  llll llll  llll tttt  tttt tttt      // L = layer (unused right now), l = left, t = top
+	uint32_t header2;  // ____ ____  rrrr rrrr  rrrr bbbb  bbbb bbbb      // r = right, b = bottom
+	uint32_t color;    // rrrr rrrr  gggg gggg  bbbb bbbb  aaaa aaaa      // r = red, g = green, b = blue, a = alpha
+	uint32_t padding;  // ____ ____  ____ ____  ____ ____  ____ ____
+	ssbo_inlined_instr_instr_t instr[6];
+} ssbo_inlined_instr_rect_t;
+
+typedef struct {
+	scenario_args_t* args;
+	ssbo_inlined_instr_rect_t* rects_cpu_buffer;
+} ssbo_inlined_instr_6_pack_t;
+
+static void ssbo_inlined_instr_6_pack_rects(void* ctx, uint32_t begin, uint32_t end, uint32_t thread_index) {
+	ssbo_inlined_instr_6_pack_t* pack = ctx;
+	scenario_args_t* args = pack->args;
+	ssbo_inlined_instr_rect_t* rects_cpu_buffer = pack->rects_cpu_buffer;
 	
 	// Moves bits into a specific part of the value. The arguments start_bit_lsb and bit_count are the same as used in
 	// the GLSL function bitfieldExtract() to unpack them (`offset` and `bits`).
@@ -1717,14 +6018,6 @@ void bench_ssbo_inlined_instr_6(scenario_args_t* args) {
 		return (value & mask) << start_bit_lsb;
 	}
 	
-	typedef struct { uint32_t x, y; } ssbo_inlined_instr_instr_t;
-	typedef struct {       //        24         16          8          0
-		uint32_t header1;  // LLLL LLLL  llll llll  llll tttt  tttt tttt      // L = layer (unused right now), l = left, t = top
-		uint32_t header2;  // ____ ____  rrrr rrrr  rrrr bbbb  bbbb bbbb      // r = right, b = bottom
-		uint32_t color;    // rrrr rrrr  gggg gggg  bbbb bbbb  aaaa aaaa      // r = red, g = green, b = blue, a = alpha
-		uint32_t padding;  // ____ ____  ____ ____  ____ ____  ____ ____
-		ssbo_inlined_instr_instr_t instr[6];
-	} ssbo_inlined_instr_rect_t;
 	ssbo_inlined_instr_rect_t pack_rect(uint32_t layer, rectl_t pos, color_t color) {
 		return (ssbo_inlined_instr_rect_t){
 			.header1 = bits(layer, 24, 8) | bits(pos.l, 12, 12) | bits(pos.t, 0, 12),
@@ -1771,16 +6064,63 @@ void bench_ssbo_inlined_instr_6(scenario_args_t* args) {
 		};
 	}
 	
+	for (uint32_t i = begin; i < end; i++) {
+		// rectl_t  pos;
+		// color_t  background_color;
+		// bool     has_border, has_rounded_corners, has_texture, has_texture_array, has_glyph;
+		// float    border_width;
+		// color_t  border_color;
+		// uint32_t corner_radius;
+		// GLuint   texture_index;
+		// uint32_t texture_array_index;
+		// rectf_t  texture_coords;
+		// uint32_t random;
+		rect_t* r = &args->rects_ptr[i];
+		ssbo_inlined_instr_rect_t rect = pack_rect(0, r->pos, r->background_color);
+		
+		uint32_t instr_count = 0;
+		if (r->has_glyph)
+			rect.instr[instr_count++] = pack_glyph(r->texture_index, (rectl_t){r->texture_coords.l, r->texture_coords.t, r->texture_coords.r, r->texture_coords.b});
+		else {
+			if (r->has_texture)
+				rect.instr[instr_count++] = pack_texture(r->texture_index, r->texture_array_index, (rectl_t){r->texture_coords.l, r->texture_coords.t, r->texture_coords.r, r->texture_coords.b});
+			if (r->has_rounded_corners)
+				rect.instr[instr_count++] = pack_rounded_rect_equ(r->pos, r->corner_radius);
+			if (r->has_border)
+				rect.instr[instr_count++] = pack_border(0, -(r->border_width), r->border_color);
+		}
+		assert(instr_count <= 6);
+		
+		rects_cpu_buffer[i] = rect;
+	}
+}
+
+static void ssbo_inlined_instr_6_pack_rects_batched(void* ctx, uint32_t begin, uint32_t end, uint32_t thread_index) {
+	ssbo_inlined_instr_6_pack_t* pack = ctx;
+	pack_inlined_instr_rects(pack->args->rects_ptr, begin, end, (pack_inlined_instr_rect_t*)pack->rects_cpu_buffer);
+}
+
+void bench_ssbo_inlined_instr_6(scenario_args_t* args, bool use_batch_packer) {
+	// Setup
+	int window_width = 0, window_height = 0;
+	display_size(args->display, &window_width, &window_height);
+	
 	// CPU side buffer
 	uint32_t rects_buffer_size = args->rects_count * sizeof(ssbo_inlined_instr_rect_t);
 	ssbo_inlined_instr_rect_t* rects_cpu_buffer = malloc(rects_buffer_size);
+	_Static_assert(sizeof(ssbo_inlined_instr_rect_t) == sizeof(pack_inlined_instr_rect_t), "ssbo_inlined_instr_rect_t doesn't match the batch packer format");
+	if (use_batch_packer)
+		pack_select_batch();
 	
 	// All the data goes into the SSBO and we only use an empty VAO for the draw command. The shader then assembles the per-vertex data by itself.
 	// An empty VAO should work according to spec, see https://community.khronos.org/t/running-a-vertex-shader-without-any-per-vertex-attribute/69568/4.
 	GLuint vao = 0, rects_ssbo = 0;
 	glCreateVertexArrays(1, &vao);
 	glCreateBuffers(1, &rects_ssbo);
-	GLuint program = load_shader_program(2, (shader_type_and_source_t[]){
+	upload_ring_t ring = { 0 };
+	if (upload_mode == UPLOAD_RING)
+		upload_ring_init(&ring, rects_buffer_size);
+	GLuint program = load_shader_program_separable(false, 2, (shader_type_and_source_t[]){
 		{ GL_VERTEX_SHADER,
 			"#version 450 core\n"
 			"\n"
@@ -1947,48 +6287,26 @@ void bench_ssbo_inlined_instr_6(scenario_args_t* args) {
 		}
 	});
 	
-	report_approach_start("ssbo_inlined_instr_6");
+	report_approach_start(use_batch_packer ? "ssbo_inlined_instr_6_simd" : "ssbo_inlined_instr_6");
 	
 	for (uint32_t frame_index = 0; frame_index < args->frame_count; frame_index++) {
+		animation_next_frame(args);
 		report_frame_start();
 			
-			// Update SSBOs with new data (doesn't change here but would with real usecases)
-			for (uint32_t i = 0; i < args->rects_count; i++) {
-				// rectl_t  pos;
-				// color_t  background_color;
-				// bool     has_border, has_rounded_corners, has_texture, has_texture_array, has_glyph;
-				// float    border_width;
-				// color_t  border_color;
-				// uint32_t corner_radius;
-				// GLuint   texture_index;
-				// uint32_t texture_array_index;
-				// rectf_t  texture_coords;
-				// uint32_t random;
-				rect_t* r = &args->rects_ptr[i];
-				ssbo_inlined_instr_rect_t rect = pack_rect(0, r->pos, r->background_color);
-				
-				uint32_t instr_count = 0;
-				if (r->has_glyph)
-					rect.instr[instr_count++] = pack_glyph(r->texture_index, (rectl_t){r->texture_coords.l, r->texture_coords.t, r->texture_coords.r, r->texture_coords.b});
-				else {
-					if (r->has_texture)
-						rect.instr[instr_count++] = pack_texture(r->texture_index, r->texture_array_index, (rectl_t){r->texture_coords.l, r->texture_coords.t, r->texture_coords.r, r->texture_coords.b});
-					if (r->has_rounded_corners)
-						rect.instr[instr_count++] = pack_rounded_rect_equ(r->pos, r->corner_radius);
-					if (r->has_border)
-						rect.instr[instr_count++] = pack_border(0, -(r->border_width), r->border_color);
-				}
-				assert(instr_count <= 6);
-				
-				rects_cpu_buffer[i] = rect;
-			}
+			// Update SSBOs with new data (only changes between frames with --animate=)
+			jobs_parallel_for(&gen_jobs, args->rects_count, use_batch_packer ? ssbo_inlined_instr_6_pack_rects_batched : ssbo_inlined_instr_6_pack_rects, &(ssbo_inlined_instr_6_pack_t){ .args = args, .rects_cpu_buffer = rects_cpu_buffer });
 			
 		report_gen_buffers_done();
 			
 			// Create a new GPU buffer each time so we don't have to wait for the previous draw call to finish.
 			// Instead the old buffer data gets orphaned and freed once the previous frame is done. This prevents a
 			// pipeline stall on continous refresh.
-			glNamedBufferData(rects_ssbo, rects_buffer_size, rects_cpu_buffer, GL_STREAM_DRAW);
+			if (upload_mode == UPLOAD_RING) {
+				upload_ring_write(&ring, rects_cpu_buffer, rects_buffer_size);
+			} else {
+				glNamedBufferData(rects_ssbo, rects_buffer_size, rects_cpu_buffer, GL_STREAM_DRAW);
+				report_upload_bytes(rects_buffer_size);
+			}
 			
 		report_upload_done();
 			
@@ -1999,8 +6317,12 @@ void bench_ssbo_inlined_instr_6(scenario_args_t* args) {
 			
 			glBindVertexArray(vao);
 				glUseProgram(program);
-					glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, rects_ssbo);
-						glProgramUniform2f(program, 0, window_width / 2, window_height / 2);
+					if (upload_mode == UPLOAD_RING) {
+						upload_ring_bind(&ring, GL_SHADER_STORAGE_BUFFER, 0);
+					} else {
+						glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, rects_ssbo);
+					}
+						glProgramUniform2f(program, 0, window_width / 2.0f, window_height / 2.0f);
 						
 						glBindTextureUnit( 0, args->glyph_texture);
 						glBindTextureUnit( 1, args->image_texture);
@@ -2011,10 +6333,12 @@ void bench_ssbo_inlined_instr_6(scenario_args_t* args) {
 					glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
 				glUseProgram(0);
 			glBindVertexArray(0);
+			if (upload_mode == UPLOAD_RING)
+				upload_ring_fence(&ring);
 			
 		report_draw_done();
 			
-			SDL_GL_SwapWindow(args->window);
+			display_present(args->display);
 			
 		report_frame_end();
 	}
@@ -2023,13 +6347,15 @@ void bench_ssbo_inlined_instr_6(scenario_args_t* args) {
 	unload_shader_program(program);
 	glDeleteVertexArrays(1, &vao);
 	glDeleteBuffers(1, &rects_ssbo);
+	if (upload_mode == UPLOAD_RING)
+		upload_ring_destroy(&ring);
 	free(rects_cpu_buffer);
 }
 
 void bench_ssbo_inlined_instr(scenario_args_t* args, uint32_t rect_instr_count, uint32_t vertex_instr_count) {
 	// Setup
 	int window_width = 0, window_height = 0;
-	SDL_GetWindowSize(args->window, &window_width, &window_height);
+	display_size(args->display, &window_width, &window_height);
 	
 	// CPU side buffer
 	typedef struct { uint32_t x, y; } vecui_t;
@@ -2109,6 +6435,9 @@ void bench_ssbo_inlined_instr(scenario_args_t* args, uint32_t rect_instr_count,
 	GLuint vao = 0, rects_ssbo = 0;
 	glCreateVertexArrays(1, &vao);
 	glCreateBuffers(1, &rects_ssbo);
+	upload_ring_t ring = { 0 };
+	if (upload_mode == UPLOAD_RING)
+		upload_ring_init(&ring, buffer_size);
 	// printf() style placeholders in the shader code: %1$u = rect_instr_count, $2$u = vertex_instr_count (see man 3 printf "Format of the format string").
 	// Removed those placeholders because that doesn't work on windows with MinGW.
 	char *vertex_shader_code = NULL, *fragment_shader_code = NULL;
@@ -2280,7 +6609,7 @@ void bench_ssbo_inlined_instr(scenario_args_t* args, uint32_t rect_instr_count,
 		"	fragment_color = vec4(content_color.rgb, content_color.a * coverage);\n"
 		"}\n",
 		vertex_instr_count);
-	GLuint program = load_shader_program(2, (shader_type_and_source_t[]){
+	GLuint program = load_shader_program_separable(false, 2, (shader_type_and_source_t[]){
 		{ GL_VERTEX_SHADER,   vertex_shader_code},
 		{ GL_FRAGMENT_SHADER, fragment_shader_code }
 	});
@@ -2292,9 +6621,10 @@ void bench_ssbo_inlined_instr(scenario_args_t* args, uint32_t rect_instr_count,
 	report_approach_start(approach_name);
 	
 	for (uint32_t frame_index = 0; frame_index < args->frame_count; frame_index++) {
+		animation_next_frame(args);
 		report_frame_start();
 			
-			// Update SSBOs with new data (doesn't change here but would with real usecases)
+			// Update SSBOs with new data (only changes between frames with --animate=)
 			buffer_reset();
 			for (uint32_t i = 0; i < args->rects_count; i++) {
 				// rectl_t  pos;
@@ -2328,7 +6658,12 @@ void bench_ssbo_inlined_instr(scenario_args_t* args, uint32_t rect_instr_count,
 			// Create a new GPU buffer each time so we don't have to wait for the previous draw call to finish.
 			// Instead the old buffer data gets orphaned and freed once the previous frame is done. This prevents a
 			// pipeline stall on continous refresh.
-			glNamedBufferData(rects_ssbo, buffer_size, buffer, GL_STREAM_DRAW);
+			if (upload_mode == UPLOAD_RING) {
+				upload_ring_write(&ring, buffer, buffer_size);
+			} else {
+				glNamedBufferData(rects_ssbo, buffer_size, buffer, GL_STREAM_DRAW);
+				report_upload_bytes(buffer_size);
+			}
 			
 		report_upload_done();
 			
@@ -2339,8 +6674,12 @@ void bench_ssbo_inlined_instr(scenario_args_t* args, uint32_t rect_instr_count,
 			
 			glBindVertexArray(vao);
 				glUseProgram(program);
-					glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, rects_ssbo);
-						glProgramUniform2f(program, 0, window_width / 2, window_height / 2);
+					if (upload_mode == UPLOAD_RING) {
+						upload_ring_bind(&ring, GL_SHADER_STORAGE_BUFFER, 0);
+					} else {
+						glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, rects_ssbo);
+					}
+						glProgramUniform2f(program, 0, window_width / 2.0f, window_height / 2.0f);
 						
 						glBindTextureUnit( 0, args->glyph_texture);
 						glBindTextureUnit( 1, args->image_texture);
@@ -2351,10 +6690,12 @@ void bench_ssbo_inlined_instr(scenario_args_t* args, uint32_t rect_instr_count,
 					glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
 				glUseProgram(0);
 			glBindVertexArray(0);
+			if (upload_mode == UPLOAD_RING)
+				upload_ring_fence(&ring);
 			
 		report_draw_done();
 			
-			SDL_GL_SwapWindow(args->window);
+			display_present(args->display);
 			
 		report_frame_end();
 	}
@@ -2363,14 +6704,41 @@ void bench_ssbo_inlined_instr(scenario_args_t* args, uint32_t rect_instr_count,
 	unload_shader_program(program);
 	glDeleteVertexArrays(1, &vao);
 	glDeleteBuffers(1, &rects_ssbo);
+	if (upload_mode == UPLOAD_RING)
+		upload_ring_destroy(&ring);
 	free(buffer);
 	free(approach_name);
 }
 
-void bench_ssbo_fixed_vertex_to_fragment_buffer(scenario_args_t* args, uint32_t vertex_instr_count) {
-	// Setup
-	int window_width = 0, window_height = 0;
-	SDL_GetWindowSize(args->window, &window_width, &window_height);
+typedef struct {       //        24         16          8          0
+	uint32_t header1;  // LLLL LLLL  llll llll  llll tttt  tttt tttt      // L = layer (unused right now), l = left, t = top
+	uint32_t header2;  // ____ ____  rrrr rrrr  rrrr bbbb  bbbb bbbb      // r = right, b = bottom
+	uint32_t color;    // rrrr rrrr  gggg gggg  bbbb bbbb  aaaa aaaa      // r = red, g = green, b = blue, a = alpha
+	uint32_t instr;    // oooo oooo  oooo oooo  oooo oooo  cccc cccc      // o = offset, c = count
+} ssbo_instr_combo_rect_t;
+typedef struct { uint32_t x, y; } ssbo_instr_combo_instr_t;
+
+typedef struct {
+	scenario_args_t* args;
+	ssbo_instr_combo_rect_t* rects_cpu_buffer;
+	ssbo_instr_combo_instr_t* instr_cpu_buffer;
+	uint32_t* instr_offsets;  // Offset of the first instruction of each rect, NULL packs the rects one after the other
+	uint32_t instr_count;     // Instructions packed so far when instr_offsets is NULL
+} ssbo_instr_combo_pack_t;
+
+static void ssbo_instr_combo_count_instrs(void* ctx, uint32_t begin, uint32_t end, uint32_t thread_index) {
+	ssbo_instr_combo_pack_t* pack = ctx;
+	for (uint32_t i = begin; i < end; i++) {
+		rect_t* r = &pack->args->rects_ptr[i];
+		pack->instr_offsets[i] = r->has_glyph ? 1 : r->has_texture + r->has_rounded_corners + r->has_border;
+	}
+}
+
+static void ssbo_instr_combo_pack_rects(void* ctx, uint32_t begin, uint32_t end, uint32_t thread_index) {
+	ssbo_instr_combo_pack_t* pack = ctx;
+	scenario_args_t* args = pack->args;
+	ssbo_instr_combo_rect_t* rects_cpu_buffer = pack->rects_cpu_buffer;
+	ssbo_instr_combo_instr_t* instr_cpu_buffer = pack->instr_cpu_buffer;
 	
 	// Moves bits into a specific part of the value. The arguments start_bit_lsb and bit_count are the same as used in
 	// the GLSL function bitfieldExtract() to unpack them (`offset` and `bits`).
@@ -2380,12 +6748,6 @@ void bench_ssbo_fixed_vertex_to_fragment_buffer(scenario_args_t* args, uint32_t
 		return (value & mask) << start_bit_lsb;
 	}
 	
-	typedef struct {       //        24         16          8          0
-		uint32_t header1;  // LLLL LLLL  llll llll  llll tttt  tttt tttt      // L = layer (unused right now), l = left, t = top
-		uint32_t header2;  // ____ ____  rrrr rrrr  rrrr bbbb  bbbb bbbb      // r = right, b = bottom
-		uint32_t color;    // rrrr rrrr  gggg gggg  bbbb bbbb  aaaa aaaa      // r = red, g = green, b = blue, a = alpha
-		uint32_t instr;    // oooo oooo  oooo oooo  oooo oooo  cccc cccc      // o = offset, c = count
-	} ssbo_instr_combo_rect_t;
 	ssbo_instr_combo_rect_t pack_rect(uint32_t layer, rectl_t pos, color_t color, uint32_t instr_offset, uint32_t instr_count) {
 		return (ssbo_instr_combo_rect_t){
 			.header1 = bits(layer, 24, 8) | bits(pos.l, 12, 12) | bits(pos.t, 0, 12),
@@ -2395,7 +6757,6 @@ void bench_ssbo_fixed_vertex_to_fragment_buffer(scenario_args_t* args, uint32_t
 		};
 	}
 	
-	typedef struct { uint32_t x, y; } ssbo_instr_combo_instr_t;
 	enum { SSBOIL_T_GLYPH = 1, SSBOIL_T_TEXTURE, SSBOIL_T_ROUNDED_RECT_EQU, SSBOIL_T_LINE_EQU, SSBOIL_T_CIRCLE_EQU, SSBOIL_T_BORDER };
 	ssbo_instr_combo_instr_t pack_glyph(uint32_t texture_unit, rectl_t tex_coords) {                                                  // glyph
 		return (ssbo_instr_combo_instr_t){                                                                                            //   28   24         16    12    8          0
@@ -2434,10 +6795,53 @@ void bench_ssbo_fixed_vertex_to_fragment_buffer(scenario_args_t* args, uint32_t
 		};
 	}
 	
+	// Packs rect i with its instructions starting at instr_offset, returns the number of instructions
+	uint32_t pack_rect_and_instrs(uint32_t i, uint32_t instr_offset) {
+		// rectl_t  pos;
+		// color_t  background_color;
+		// bool     has_border, has_rounded_corners, has_texture, has_texture_array, has_glyph;
+		// float    border_width;
+		// color_t  border_color;
+		// uint32_t corner_radius;
+		// GLuint   texture_index;
+		// uint32_t texture_array_index;
+		// rectf_t  texture_coords;
+		// uint32_t random;
+		rect_t* r = &args->rects_ptr[i];
+		uint32_t instr_count = instr_offset;
+		if (r->has_glyph)
+			instr_cpu_buffer[instr_count++] = pack_glyph(r->texture_index, (rectl_t){r->texture_coords.l, r->texture_coords.t, r->texture_coords.r, r->texture_coords.b});
+		else {
+			if (r->has_texture)
+				instr_cpu_buffer[instr_count++] = pack_texture(r->texture_index, r->texture_array_index, (rectl_t){r->texture_coords.l, r->texture_coords.t, r->texture_coords.r, r->texture_coords.b});
+			if (r->has_rounded_corners)
+				instr_cpu_buffer[instr_count++] = pack_rounded_rect_equ(r->pos, r->corner_radius);
+			if (r->has_border)
+				instr_cpu_buffer[instr_count++] = pack_border(0, -(r->border_width), r->border_color);
+		}
+		rects_cpu_buffer[i] = pack_rect(0, r->pos, r->background_color, instr_offset, instr_count - instr_offset);
+		assert(instr_count - instr_offset < 10);
+		return instr_count - instr_offset;
+	}
+	
+	for (uint32_t i = begin; i < end; i++) {
+		if (pack->instr_offsets)
+			pack_rect_and_instrs(i, pack->instr_offsets[i]);
+		else
+			pack->instr_count += pack_rect_and_instrs(i, pack->instr_count);
+	}
+}
+
+void bench_ssbo_fixed_vertex_to_fragment_buffer(scenario_args_t* args, uint32_t vertex_instr_count) {
+	// Setup
+	int window_width = 0, window_height = 0;
+	display_size(args->display, &window_width, &window_height);
+	
 	// CPU side buffers. For the experiment we use a fixed instruction buffer with 4 times the count of the rects buffer and an assert below. Good enough for the experiment.
 	uint32_t max_instr_count = args->rects_count * 4, rects_buffer_size = args->rects_count * sizeof(ssbo_instr_combo_rect_t), instr_buffer_size = max_instr_count * sizeof(ssbo_instr_combo_instr_t);
 	ssbo_instr_combo_rect_t*  rects_cpu_buffer = malloc(rects_buffer_size);
 	ssbo_instr_combo_instr_t* instr_cpu_buffer = malloc(instr_buffer_size);
+	uint32_t* instr_offsets = malloc(args->rects_count * sizeof(instr_offsets[0]));
 	
 	// All the data goes into the SSBOs and we only use an empty VAO for the draw command. The shader then assembles the per-vertex data by itself.
 	// An empty VAO should work according to spec, see https://community.khronos.org/t/running-a-vertex-shader-without-any-per-vertex-attribute/69568/4.
@@ -2445,6 +6849,12 @@ void bench_ssbo_fixed_vertex_to_fragment_buffer(scenario_args_t* args, uint32_t
 	glCreateVertexArrays(1, &vao);
 	glCreateBuffers(1, &rects_ssbo);
 	glCreateBuffers(1, &instr_ssbo);
+	upload_ring_t rects_ring = { 0 };
+	upload_ring_t instr_ring = { 0 };
+	if (upload_mode == UPLOAD_RING) {
+		upload_ring_init(&rects_ring, rects_buffer_size);
+		upload_ring_init(&instr_ring, instr_buffer_size);
+	}
 	// printf() style placeholders in the shader code: %1$u = vertex_instr_count (see man 3 printf "Format of the format string").
 	// Removed those placeholders because that doesn't work on windows with MinGW.
 	char *vertex_shader_code = NULL, *fragment_shader_code = NULL;
@@ -2618,7 +7028,7 @@ void bench_ssbo_fixed_vertex_to_fragment_buffer(scenario_args_t* args, uint32_t
 		"	fragment_color = vec4(content_color.rgb, content_color.a * coverage);\n"
 		"}\n",
 		vertex_instr_count);
-	GLuint program = load_shader_program(2, (shader_type_and_source_t[]){
+	GLuint program = load_shader_program_separable(false, 2, (shader_type_and_source_t[]){
 		{ GL_VERTEX_SHADER,   vertex_shader_code},
 		{ GL_FRAGMENT_SHADER, fragment_shader_code }
 	});
@@ -2630,45 +7040,38 @@ void bench_ssbo_fixed_vertex_to_fragment_buffer(scenario_args_t* args, uint32_t
 	report_approach_start(approach_name);
 	
 	for (uint32_t frame_index = 0; frame_index < args->frame_count; frame_index++) {
+		animation_next_frame(args);
 		report_frame_start();
 			
-			// Update SSBOs with new data (doesn't change here but would with real usecases)
+			// Update SSBOs with new data (only changes between frames with --animate=)
 			uint32_t instr_count = 0;
-			for (uint32_t i = 0; i < args->rects_count; i++) {
-				// rectl_t  pos;
-				// color_t  background_color;
-				// bool     has_border, has_rounded_corners, has_texture, has_texture_array, has_glyph;
-				// float    border_width;
-				// color_t  border_color;
-				// uint32_t corner_radius;
-				// GLuint   texture_index;
-				// uint32_t texture_array_index;
-				// rectf_t  texture_coords;
-				// uint32_t random;
-				rect_t* r = &args->rects_ptr[i];
-				uint32_t instr_offset = instr_count;
-				if (r->has_glyph)
-					instr_cpu_buffer[instr_count++] = pack_glyph(r->texture_index, (rectl_t){r->texture_coords.l, r->texture_coords.t, r->texture_coords.r, r->texture_coords.b});
-				else {
-					if (r->has_texture)
-						instr_cpu_buffer[instr_count++] = pack_texture(r->texture_index, r->texture_array_index, (rectl_t){r->texture_coords.l, r->texture_coords.t, r->texture_coords.r, r->texture_coords.b});
-					if (r->has_rounded_corners)
-						instr_cpu_buffer[instr_count++] = pack_rounded_rect_equ(r->pos, r->corner_radius);
-					if (r->has_border)
-						instr_cpu_buffer[instr_count++] = pack_border(0, -(r->border_width), r->border_color);
-				}
-				rects_cpu_buffer[i] = pack_rect(0, r->pos, r->background_color, instr_offset, instr_count - instr_offset);
-				assert(instr_count - instr_offset < 10);
-				assert(instr_count <= max_instr_count);
+			ssbo_instr_combo_pack_t pack = { .args = args, .rects_cpu_buffer = rects_cpu_buffer, .instr_cpu_buffer = instr_cpu_buffer };
+			if (gen_jobs.thread_count == 1) {
+				ssbo_instr_combo_pack_rects(&pack, 0, args->rects_count, 0);
+				instr_count = pack.instr_count;
+			} else {
+				// Count the instructions of each rect first, their prefix sum is the offset of the first instruction of each rect
+				pack.instr_offsets = instr_offsets;
+				jobs_parallel_for(&gen_jobs, args->rects_count, ssbo_instr_combo_count_instrs, &pack);
+				instr_count = jobs_exclusive_prefix_sum(&gen_jobs, instr_offsets, args->rects_count);
+				jobs_parallel_for(&gen_jobs, args->rects_count, ssbo_instr_combo_pack_rects, &pack);
 			}
+			assert(instr_count <= max_instr_count);
 			
 		report_gen_buffers_done();
 			
 			// Create a new GPU buffer each time so we don't have to wait for the previous draw call to finish.
 			// Instead the old buffer data gets orphaned and freed once the previous frame is done. This prevents a
 			// pipeline stall on continous refresh.
-			glNamedBufferData(rects_ssbo, rects_buffer_size, rects_cpu_buffer, GL_STREAM_DRAW);
-			glNamedBufferData(instr_ssbo, instr_count * sizeof(instr_cpu_buffer[0]), instr_cpu_buffer, GL_STREAM_DRAW);
+			if (upload_mode == UPLOAD_RING) {
+				upload_ring_write(&rects_ring, rects_cpu_buffer, rects_buffer_size);
+				upload_ring_write(&instr_ring, instr_cpu_buffer, instr_count * sizeof(instr_cpu_buffer[0]));
+			} else {
+				glNamedBufferData(rects_ssbo, rects_buffer_size, rects_cpu_buffer, GL_STREAM_DRAW);
+				report_upload_bytes(rects_buffer_size);
+				glNamedBufferData(instr_ssbo, instr_count * sizeof(instr_cpu_buffer[0]), instr_cpu_buffer, GL_STREAM_DRAW);
+				report_upload_bytes(instr_count * sizeof(instr_cpu_buffer[0]));
+			}
 			
 		report_upload_done();
 			
@@ -2679,9 +7082,14 @@ void bench_ssbo_fixed_vertex_to_fragment_buffer(scenario_args_t* args, uint32_t
 			
 			glBindVertexArray(vao);
 				glUseProgram(program);
-					glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, rects_ssbo);
-					glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, instr_ssbo);
-						glProgramUniform2f(program, 0, window_width / 2, window_height / 2);
+					if (upload_mode == UPLOAD_RING) {
+						upload_ring_bind(&rects_ring, GL_SHADER_STORAGE_BUFFER, 0);
+						upload_ring_bind(&instr_ring, GL_SHADER_STORAGE_BUFFER, 1);
+					} else {
+						glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, rects_ssbo);
+						glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, instr_ssbo);
+					}
+						glProgramUniform2f(program, 0, window_width / 2.0f, window_height / 2.0f);
 						
 						glBindTextureUnit( 0, args->glyph_texture);
 						glBindTextureUnit( 1, args->image_texture);
@@ -2693,10 +7101,14 @@ void bench_ssbo_fixed_vertex_to_fragment_buffer(scenario_args_t* args, uint32_t
 					glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, 0);
 				glUseProgram(0);
 			glBindVertexArray(0);
+			if (upload_mode == UPLOAD_RING) {
+				upload_ring_fence(&rects_ring);
+				upload_ring_fence(&instr_ring);
+			}
 			
 		report_draw_done();
 			
-			SDL_GL_SwapWindow(args->window);
+			display_present(args->display);
 			
 		report_frame_end();
 	}
@@ -2706,6 +7118,11 @@ void bench_ssbo_fixed_vertex_to_fragment_buffer(scenario_args_t* args, uint32_t
 	glDeleteVertexArrays(1, &vao);
 	glDeleteBuffers(1, &instr_ssbo);
 	glDeleteBuffers(1, &rects_ssbo);
+	if (upload_mode == UPLOAD_RING) {
+		upload_ring_destroy(&rects_ring);
+		upload_ring_destroy(&instr_ring);
+	}
+	free(instr_offsets);
 	free(instr_cpu_buffer);
 	free(rects_cpu_buffer);
 	free(approach_name);
@@ -2713,31 +7130,70 @@ void bench_ssbo_fixed_vertex_to_fragment_buffer(scenario_args_t* args, uint32_t
 
 
 
+typedef struct {
+	uint8_t  flags, layer, tex_unit, tex_array_index;
+	color_t  base_color;
+	uint16_t left, top;
+	uint16_t right, bottom;
+	
+	uint16_t tex_left, tex_top;
+	uint16_t tex_right, tex_bottom;
+	color_t  border_color;
+	uint8_t  border_width, corner_radius, padding1, padding2;
+} one_ssbo_ext_no_sdf_rect_t;
+
+typedef struct {
+	scenario_args_t* args;
+	one_ssbo_ext_no_sdf_rect_t* rects_cpu_buffer;
+} one_ssbo_ext_no_sdf_pack_t;
+
+static void one_ssbo_ext_no_sdf_pack_rects(void* ctx, uint32_t begin, uint32_t end, uint32_t thread_index) {
+	one_ssbo_ext_no_sdf_pack_t* pack = ctx;
+	scenario_args_t* args = pack->args;
+	one_ssbo_ext_no_sdf_rect_t* rects_cpu_buffer = pack->rects_cpu_buffer;
+	
+	enum one_ssbo_flags_t { ONE_SSBO_USE_TEXTURE = (1 << 0), ONE_SSBO_USE_BORDER = (1 << 1), ONE_SSBO_GLYPH = (1 << 2), ONE_SSBO_SDF_FUNCS = (1 << 3) };
+	
+	for (uint32_t i = begin; i < end; i++) {
+		// rectl_t  pos;
+		// color_t  background_color;
+		// bool     has_border, has_rounded_corners, has_texture, has_texture_array, has_glyph;
+		// float    border_width;
+		// color_t  border_color;
+		// uint32_t corner_radius;
+		// GLuint   texture_index;
+		// uint32_t texture_array_index;
+		// rectf_t  texture_coords;
+		// uint32_t random;
+		rect_t* r = &args->rects_ptr[i];
+		rects_cpu_buffer[i] = (one_ssbo_ext_no_sdf_rect_t){
+			.flags = ((r->has_texture || r->has_texture_array) ? ONE_SSBO_USE_TEXTURE : 0) | ((r->has_border || r->has_rounded_corners) ? ONE_SSBO_USE_BORDER : 0) | (r->has_glyph ? ONE_SSBO_GLYPH : 0),
+			.layer = 0, .tex_unit = r->texture_index, .tex_array_index = r->texture_array_index,
+			.base_color = r->background_color,
+			.left = r->pos.l, .top = r->pos.t, .right = r->pos.r, .bottom = r->pos.b,
+			
+			.tex_left = r->texture_coords.l, .tex_top = r->texture_coords.t, .tex_right = r->texture_coords.r, .tex_bottom = r->texture_coords.b,
+			.border_color = r->border_color, .border_width = r->border_width, .corner_radius = r->corner_radius
+		};
+	}
+}
+
 void bench_one_ssbo_ext_no_sdf(scenario_args_t* args) {
 	// Setup
 	int window_width = 0, window_height = 0;
-	SDL_GetWindowSize(args->window, &window_width, &window_height);
+	display_size(args->display, &window_width, &window_height);
 	
-	enum one_ssbo_flags_t { ONE_SSBO_USE_TEXTURE = (1 << 0), ONE_SSBO_USE_BORDER = (1 << 1), ONE_SSBO_GLYPH = (1 << 2), ONE_SSBO_SDF_FUNCS = (1 << 3) };
-	typedef struct {
-		uint8_t  flags, layer, tex_unit, tex_array_index;
-		color_t  base_color;
-		uint16_t left, top;
-		uint16_t right, bottom;
-		
-		uint16_t tex_left, tex_top;
-		uint16_t tex_right, tex_bottom;
-		color_t  border_color;
-		uint8_t  border_width, corner_radius, padding1, padding2;
-	} one_ssbo_rect_t;
-	one_ssbo_rect_t* rects_cpu_buffer = malloc(args->rects_count * sizeof(rects_cpu_buffer[0]));
+	one_ssbo_ext_no_sdf_rect_t* rects_cpu_buffer = malloc(args->rects_count * sizeof(rects_cpu_buffer[0]));
 	
 	// All the data goes into the SSBO and we only use an empty VAO for the draw command. The shader then assembles the
 	// per-vertex data by itself. An empty VAO should work according to spec, see https://community.khronos.org/t/running-a-vertex-shader-without-any-per-vertex-attribute/69568/4.
 	GLuint vao = 0, ssbo = 0;
 	glCreateVertexArrays(1, &vao);
 	glCreateBuffers(1, &ssbo);
-	GLuint program = load_shader_program(2, (shader_type_and_source_t[]){
+	upload_ring_t ring = { 0 };
+	if (upload_mode == UPLOAD_RING)
+		upload_ring_init(&ring, args->rects_count * sizeof(rects_cpu_buffer[0]));
+	GLuint program = load_shader_program_separable(false, 2, (shader_type_and_source_t[]){
 		{ GL_VERTEX_SHADER,
 			"#version 450 core\n"
 			"\n"
@@ -2888,38 +7344,23 @@ void bench_one_ssbo_ext_no_sdf(scenario_args_t* args) {
 	report_approach_start("one_ssbo_ext_no_sdf");
 	
 	for (uint32_t frame_index = 0; frame_index < args->frame_count; frame_index++) {
+		animation_next_frame(args);
 		report_frame_start();
 			
-			// Update SSBO with new data (doesn't change here but would with real usecases)
-			for (uint32_t i = 0; i < args->rects_count; i++) {
-				// rectl_t  pos;
-				// color_t  background_color;
-				// bool     has_border, has_rounded_corners, has_texture, has_texture_array, has_glyph;
-				// float    border_width;
-				// color_t  border_color;
-				// uint32_t corner_radius;
-				// GLuint   texture_index;
-				// uint32_t texture_array_index;
-				// rectf_t  texture_coords;
-				// uint32_t random;
-				rect_t* r = &args->rects_ptr[i];
-				rects_cpu_buffer[i] = (one_ssbo_rect_t){
-					.flags = ((r->has_texture || r->has_texture_array) ? ONE_SSBO_USE_TEXTURE : 0) | ((r->has_border || r->has_rounded_corners) ? ONE_SSBO_USE_BORDER : 0) | (r->has_glyph ? ONE_SSBO_GLYPH : 0),
-					.layer = 0, .tex_unit = r->texture_index, .tex_array_index = r->texture_array_index,
-					.base_color = r->background_color,
-					.left = r->pos.l, .top = r->pos.t, .right = r->pos.r, .bottom = r->pos.b,
-					
-					.tex_left = r->texture_coords.l, .tex_top = r->texture_coords.t, .tex_right = r->texture_coords.r, .tex_bottom = r->texture_coords.b,
-					.border_color = r->border_color, .border_width = r->border_width, .corner_radius = r->corner_radius
-				};
-			}
+			// Update SSBO with new data (only changes between frames with --animate=)
+			jobs_parallel_for(&gen_jobs, args->rects_count, one_ssbo_ext_no_sdf_pack_rects, &(one_ssbo_ext_no_sdf_pack_t){ .args = args, .rects_cpu_buffer = rects_cpu_buffer });
 			
 		report_gen_buffers_done();
 			
 			// Create a new GPU buffer each time so we don't have to wait for the previous draw call to finish.
 			// Instead the old buffer data gets orphaned and freed once the previous frame is done. This prevents a
 			// pipeline stall on continous refresh.
-			glNamedBufferData(ssbo, args->rects_count * sizeof(rects_cpu_buffer[0]), rects_cpu_buffer, GL_STREAM_DRAW);
+			if (upload_mode == UPLOAD_RING) {
+				upload_ring_write(&ring, rects_cpu_buffer, args->rects_count * sizeof(rects_cpu_buffer[0]));
+			} else {
+				glNamedBufferData(ssbo, args->rects_count * sizeof(rects_cpu_buffer[0]), rects_cpu_buffer, GL_STREAM_DRAW);
+				report_upload_bytes(args->rects_count * sizeof(rects_cpu_buffer[0]));
+			}
 			
 		report_upload_done();
 			
@@ -2930,8 +7371,12 @@ void bench_one_ssbo_ext_no_sdf(scenario_args_t* args) {
 			
 			glBindVertexArray(vao);
 				glUseProgram(program);
-					glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo);
-						glProgramUniform2f(program, 0, window_width / 2, window_height / 2);
+					if (upload_mode == UPLOAD_RING) {
+						upload_ring_bind(&ring, GL_SHADER_STORAGE_BUFFER, 0);
+					} else {
+						glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo);
+					}
+						glProgramUniform2f(program, 0, window_width / 2.0f, window_height / 2.0f);
 						
 						glBindTextureUnit(0, args->glyph_texture);
 						glBindTextureUnit(1, args->image_texture);
@@ -2942,10 +7387,12 @@ void bench_one_ssbo_ext_no_sdf(scenario_args_t* args) {
 					glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
 				glUseProgram(0);
 			glBindVertexArray(0);
+			if (upload_mode == UPLOAD_RING)
+				upload_ring_fence(&ring);
 			
 		report_draw_done();
 			
-			SDL_GL_SwapWindow(args->window);
+			display_present(args->display);
 			
 		report_frame_end();
 	}
@@ -2954,30 +7401,37 @@ void bench_one_ssbo_ext_no_sdf(scenario_args_t* args) {
 	unload_shader_program(program);
 	glDeleteVertexArrays(1, &vao);
 	glDeleteBuffers(1, &ssbo);
+	if (upload_mode == UPLOAD_RING)
+		upload_ring_destroy(&ring);
 	free(rects_cpu_buffer);
 }
 
-void bench_one_ssbo_ext_sdf_list(scenario_args_t* args) {
-	// Setup
-	int window_width = 0, window_height = 0;
-	SDL_GetWindowSize(args->window, &window_width, &window_height);
+typedef struct {
+	uint8_t  flags, layer, tex_unit, tex_array_index;
+	color_t  base_color;
+	uint16_t left, top;
+	uint16_t right, bottom;
+	
+	uint16_t tex_left, tex_top;
+	uint16_t tex_right, tex_bottom;
+	color_t  border_color;
+	uint8_t  border_width, corner_radius, padding1, padding2;
+	
+	uint16_t sdf_functions[4];
+	vecs_t   points[6];
+} one_ssbo_ext_sdf_list_rect_t;
+
+typedef struct {
+	scenario_args_t* args;
+	one_ssbo_ext_sdf_list_rect_t* rects_cpu_buffer;
+} one_ssbo_ext_sdf_list_pack_t;
+
+static void one_ssbo_ext_sdf_list_pack_rects(void* ctx, uint32_t begin, uint32_t end, uint32_t thread_index) {
+	one_ssbo_ext_sdf_list_pack_t* pack = ctx;
+	scenario_args_t* args = pack->args;
+	one_ssbo_ext_sdf_list_rect_t* rects_cpu_buffer = pack->rects_cpu_buffer;
 	
 	enum one_ssbo_flags_t { ONE_SSBO_USE_TEXTURE = (1 << 0), ONE_SSBO_USE_BORDER = (1 << 1), ONE_SSBO_GLYPH = (1 << 2), ONE_SSBO_SDF_FUNCS = (1 << 3) };
-	typedef struct {
-		uint8_t  flags, layer, tex_unit, tex_array_index;
-		color_t  base_color;
-		uint16_t left, top;
-		uint16_t right, bottom;
-		
-		uint16_t tex_left, tex_top;
-		uint16_t tex_right, tex_bottom;
-		color_t  border_color;
-		uint8_t  border_width, corner_radius, padding1, padding2;
-		
-		uint16_t sdf_functions[4];
-		vecs_t   points[6];
-	} one_ssbo_rect_t;
-	one_ssbo_rect_t* rects_cpu_buffer = malloc(args->rects_count * sizeof(rects_cpu_buffer[0]));
 	
 	// Moves bits into a specific part of the value. The arguments start_bit_lsb and bit_count are the same as used in
 	// the GLSL function bitfieldExtract() to unpack them (`offset` and `bits`).
@@ -2993,12 +7447,53 @@ void bench_one_ssbo_ext_sdf_list(scenario_args_t* args) {
 		return bits(type, 9, 3) | bits(operation, 6, 3) | bits(a, 3, 3) | bits(b, 0, 3);
 	}
 	
+	for (uint32_t i = begin; i < end; i++) {
+		// rectl_t  pos;
+		// color_t  background_color;
+		// bool     has_border, has_rounded_corners, has_texture, has_texture_array, has_glyph;
+		// float    border_width;
+		// color_t  border_color;
+		// uint32_t corner_radius;
+		// GLuint   texture_index;
+		// uint32_t texture_array_index;
+		// rectf_t  texture_coords;
+		// uint32_t random;
+		rect_t* r = &args->rects_ptr[i];
+		rects_cpu_buffer[i] = (one_ssbo_ext_sdf_list_rect_t){
+			.flags = ((r->has_texture || r->has_texture_array) ? ONE_SSBO_USE_TEXTURE : 0) | ((r->has_border || r->has_rounded_corners) ? ONE_SSBO_USE_BORDER : 0) | (r->has_glyph ? ONE_SSBO_GLYPH : 0),
+			.layer = 0, .tex_unit = r->texture_index, .tex_array_index = r->texture_array_index,
+			.base_color = r->background_color,
+			.left = r->pos.l, .top = r->pos.t, .right = r->pos.r, .bottom = r->pos.b,
+			
+			.tex_left = r->texture_coords.l, .tex_top = r->texture_coords.t, .tex_right = r->texture_coords.r, .tex_bottom = r->texture_coords.b,
+			.border_color = r->border_color, .border_width = r->border_width, .corner_radius = r->corner_radius
+		};
+		
+		if (r->corner_radius > 0) {
+			rects_cpu_buffer[i].points[0] = vecs(r->pos.l, r->pos.t);
+			rects_cpu_buffer[i].points[1] = vecs(r->pos.r, r->pos.b);
+			rects_cpu_buffer[i].sdf_functions[0] = pack_sdf_function(SDF_ROUNDED_RECT, SDF_OP_REPLACE, 0, 1);
+			rects_cpu_buffer[i].flags |= ONE_SSBO_SDF_FUNCS;
+		}
+	}
+}
+
+void bench_one_ssbo_ext_sdf_list(scenario_args_t* args) {
+	// Setup
+	int window_width = 0, window_height = 0;
+	display_size(args->display, &window_width, &window_height);
+	
+	one_ssbo_ext_sdf_list_rect_t* rects_cpu_buffer = malloc(args->rects_count * sizeof(rects_cpu_buffer[0]));
+	
 	// All the data goes into the SSBO and we only use an empty VAO for the draw command. The shader then assembles the
 	// per-vertex data by itself. An empty VAO should work according to spec, see https://community.khronos.org/t/running-a-vertex-shader-without-any-per-vertex-attribute/69568/4.
 	GLuint vao = 0, ssbo = 0;
 	glCreateVertexArrays(1, &vao);
 	glCreateBuffers(1, &ssbo);
-	GLuint program = load_shader_program(2, (shader_type_and_source_t[]){
+	upload_ring_t ring = { 0 };
+	if (upload_mode == UPLOAD_RING)
+		upload_ring_init(&ring, args->rects_count * sizeof(rects_cpu_buffer[0]));
+	GLuint program = load_shader_program_separable(false, 2, (shader_type_and_source_t[]){
 		{ GL_VERTEX_SHADER,
 			"#version 450 core\n"
 			"\n"
@@ -3192,45 +7687,23 @@ void bench_one_ssbo_ext_sdf_list(scenario_args_t* args) {
 	report_approach_start("one_ssbo_ext_sdf_list");
 	
 	for (uint32_t frame_index = 0; frame_index < args->frame_count; frame_index++) {
+		animation_next_frame(args);
 		report_frame_start();
 			
-			// Update SSBO with new data (doesn't change here but would with real usecases)
-			for (uint32_t i = 0; i < args->rects_count; i++) {
-				// rectl_t  pos;
-				// color_t  background_color;
-				// bool     has_border, has_rounded_corners, has_texture, has_texture_array, has_glyph;
-				// float    border_width;
-				// color_t  border_color;
-				// uint32_t corner_radius;
-				// GLuint   texture_index;
-				// uint32_t texture_array_index;
-				// rectf_t  texture_coords;
-				// uint32_t random;
-				rect_t* r = &args->rects_ptr[i];
-				rects_cpu_buffer[i] = (one_ssbo_rect_t){
-					.flags = ((r->has_texture || r->has_texture_array) ? ONE_SSBO_USE_TEXTURE : 0) | ((r->has_border || r->has_rounded_corners) ? ONE_SSBO_USE_BORDER : 0) | (r->has_glyph ? ONE_SSBO_GLYPH : 0),
-					.layer = 0, .tex_unit = r->texture_index, .tex_array_index = r->texture_array_index,
-					.base_color = r->background_color,
-					.left = r->pos.l, .top = r->pos.t, .right = r->pos.r, .bottom = r->pos.b,
-					
-					.tex_left = r->texture_coords.l, .tex_top = r->texture_coords.t, .tex_right = r->texture_coords.r, .tex_bottom = r->texture_coords.b,
-					.border_color = r->border_color, .border_width = r->border_width, .corner_radius = r->corner_radius
-				};
-				
-				if (r->corner_radius > 0) {
-					rects_cpu_buffer[i].points[0] = vecs(r->pos.l, r->pos.t);
-					rects_cpu_buffer[i].points[1] = vecs(r->pos.r, r->pos.b);
-					rects_cpu_buffer[i].sdf_functions[0] = pack_sdf_function(SDF_ROUNDED_RECT, SDF_OP_REPLACE, 0, 1);
-					rects_cpu_buffer[i].flags |= ONE_SSBO_SDF_FUNCS;
-				}
-			}
+			// Update SSBO with new data (only changes between frames with --animate=)
+			jobs_parallel_for(&gen_jobs, args->rects_count, one_ssbo_ext_sdf_list_pack_rects, &(one_ssbo_ext_sdf_list_pack_t){ .args = args, .rects_cpu_buffer = rects_cpu_buffer });
 			
 		report_gen_buffers_done();
 			
 			// Create a new GPU buffer each time so we don't have to wait for the previous draw call to finish.
 			// Instead the old buffer data gets orphaned and freed once the previous frame is done. This prevents a
 			// pipeline stall on continous refresh.
-			glNamedBufferData(ssbo, args->rects_count * sizeof(rects_cpu_buffer[0]), rects_cpu_buffer, GL_STREAM_DRAW);
+			if (upload_mode == UPLOAD_RING) {
+				upload_ring_write(&ring, rects_cpu_buffer, args->rects_count * sizeof(rects_cpu_buffer[0]));
+			} else {
+				glNamedBufferData(ssbo, args->rects_count * sizeof(rects_cpu_buffer[0]), rects_cpu_buffer, GL_STREAM_DRAW);
+				report_upload_bytes(args->rects_count * sizeof(rects_cpu_buffer[0]));
+			}
 			
 		report_upload_done();
 			
@@ -3241,8 +7714,12 @@ void bench_one_ssbo_ext_sdf_list(scenario_args_t* args) {
 			
 			glBindVertexArray(vao);
 				glUseProgram(program);
-					glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo);
-						glProgramUniform2f(program, 0, window_width / 2, window_height / 2);
+					if (upload_mode == UPLOAD_RING) {
+						upload_ring_bind(&ring, GL_SHADER_STORAGE_BUFFER, 0);
+					} else {
+						glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo);
+					}
+						glProgramUniform2f(program, 0, window_width / 2.0f, window_height / 2.0f);
 						
 						glBindTextureUnit(0, args->glyph_texture);
 						glBindTextureUnit(1, args->image_texture);
@@ -3253,10 +7730,12 @@ void bench_one_ssbo_ext_sdf_list(scenario_args_t* args) {
 					glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
 				glUseProgram(0);
 			glBindVertexArray(0);
+			if (upload_mode == UPLOAD_RING)
+				upload_ring_fence(&ring);
 			
 		report_draw_done();
 			
-			SDL_GL_SwapWindow(args->window);
+			display_present(args->display);
 			
 		report_frame_end();
 	}
@@ -3265,38 +7744,91 @@ void bench_one_ssbo_ext_sdf_list(scenario_args_t* args) {
 	unload_shader_program(program);
 	glDeleteVertexArrays(1, &vao);
 	glDeleteBuffers(1, &ssbo);
+	if (upload_mode == UPLOAD_RING)
+		upload_ring_destroy(&ring);
 	free(rects_cpu_buffer);
 }
 
-void bench_one_ssbo_ext_one_sdf(scenario_args_t* args, bool use_builtin_scenario) {
+// Rect format of one_ssbo_ext_one_sdf, one_ssbo_ext_one_sdf_pack and inst_div. sdf_type is one of the SDF_* values, flags
+// uses the ONE_SSBO_* flags of bench_one_ssbo().
+enum { SDF_NONE = 0, SDF_ROUNDED_RECT, SDF_CIRCLE, SDF_INV_CIRCLE, SDF_POLYGON, SDF_TEXTURE, SDF_CIRCLE_SEGMENT, SDF_RECT };
+typedef struct {
+	uint8_t  flags, layer, tex_unit, tex_array_index;
+	color_t  base_color;
+	uint16_t left, top;
+	uint16_t right, bottom;
+	
+	uint16_t tex_left, tex_top;
+	uint16_t tex_right, tex_bottom;
+	color_t  border_color;
+	uint8_t  border_width, corner_radius, sdf_type, point_count;
+	
+	vecs_t   points[8];
+} one_ssbo_ext_one_sdf_rect_t;
+
+typedef struct {
+	scenario_args_t* args;
+	one_ssbo_ext_one_sdf_rect_t* rects_cpu_buffer;
+} one_ssbo_ext_one_sdf_pack_t;
+
+static void one_ssbo_ext_one_sdf_pack_rects(void* ctx, uint32_t begin, uint32_t end, uint32_t thread_index) {
+	one_ssbo_ext_one_sdf_pack_t* pack = ctx;
+	scenario_args_t* args = pack->args;
+	one_ssbo_ext_one_sdf_rect_t* rects_cpu_buffer = pack->rects_cpu_buffer;
+	
+	for (uint32_t i = begin; i < end; i++) {
+		// rectl_t  pos;
+		// color_t  background_color;
+		// bool     has_border, has_rounded_corners, has_texture, has_texture_array, has_glyph;
+		// float    border_width;
+		// color_t  border_color;
+		// uint32_t corner_radius;
+		// GLuint   texture_index;
+		// uint32_t texture_array_index;
+		// rectf_t  texture_coords;
+		// uint32_t random;
+		rect_t* r = &args->rects_ptr[i];
+		rects_cpu_buffer[i] = (one_ssbo_ext_one_sdf_rect_t){
+			.flags = ((r->has_texture || r->has_texture_array) ? ONE_SSBO_USE_TEXTURE : 0) | ((r->has_border || r->has_rounded_corners) ? ONE_SSBO_USE_BORDER : 0) | (r->has_glyph ? ONE_SSBO_GLYPH : 0),
+			.layer = 0, .tex_unit = r->texture_index, .tex_array_index = r->texture_array_index,
+			.base_color = r->background_color,
+			.left = r->pos.l, .top = r->pos.t, .right = r->pos.r, .bottom = r->pos.b,
+			
+			.tex_left = r->texture_coords.l, .tex_top = r->texture_coords.t, .tex_right = r->texture_coords.r, .tex_bottom = r->texture_coords.b,
+			.border_color = r->border_color, .border_width = r->border_width, .corner_radius = r->corner_radius
+		};
+		
+		if (r->corner_radius > 0) {
+			rects_cpu_buffer[i].sdf_type = SDF_ROUNDED_RECT;
+			rects_cpu_buffer[i].points[0] = vecs(r->pos.l, r->pos.t);
+			rects_cpu_buffer[i].points[1] = vecs(r->pos.r, r->pos.b);
+			rects_cpu_buffer[i].point_count = 2;
+		}
+	}
+}
+
+void bench_one_ssbo_ext_one_sdf(scenario_args_t* args, bool use_builtin_scenario, sdf_aa_t sdf_aa) {
 	// Setup
 	int window_width = 0, window_height = 0;
-	SDL_GetWindowSize(args->window, &window_width, &window_height);
+	display_size(args->display, &window_width, &window_height);
 	
-	enum { ONE_SSBO_USE_TEXTURE = (1 << 0), ONE_SSBO_USE_BORDER = (1 << 1), ONE_SSBO_GLYPH = (1 << 2) };
-	enum { SDF_NONE = 0, SDF_ROUNDED_RECT, SDF_CIRCLE, SDF_INV_CIRCLE, SDF_POLYGON, SDF_TEXTURE, SDF_CIRCLE_SEGMENT, SDF_RECT };
-	typedef struct {
-		uint8_t  flags, layer, tex_unit, tex_array_index;
-		color_t  base_color;
-		uint16_t left, top;
-		uint16_t right, bottom;
-		
-		uint16_t tex_left, tex_top;
-		uint16_t tex_right, tex_bottom;
-		color_t  border_color;
-		uint8_t  border_width, corner_radius, sdf_type, point_count;
-		
-		vecs_t   points[8];
-	} one_ssbo_rect_t;
-	one_ssbo_rect_t* rects_cpu_buffer = malloc(args->rects_count * sizeof(rects_cpu_buffer[0]));
+	// The demo writes its own rects, the buffers need room for them even if the scenario has fewer
+	const uint32_t demo_rects_count = 10;
+	uint32_t max_rects_count = (use_builtin_scenario && args->rects_count < demo_rects_count) ? demo_rects_count : args->rects_count;
+	one_ssbo_ext_one_sdf_rect_t* rects_cpu_buffer = malloc(max_rects_count * sizeof(rects_cpu_buffer[0]));
 	
 	// All the data goes into the SSBO and we only use an empty VAO for the draw command. The shader then assembles the
 	// per-vertex data by itself. An empty VAO should work according to spec, see https://community.khronos.org/t/running-a-vertex-shader-without-any-per-vertex-attribute/69568/4.
 	GLuint vao = 0, ssbo = 0;
 	glCreateVertexArrays(1, &vao);
 	glCreateBuffers(1, &ssbo);
-	GLuint program = load_shader_program(2, (shader_type_and_source_t[]){
-		{ GL_VERTEX_SHADER,
+	upload_ring_t ring = { 0 };
+	if (upload_mode == UPLOAD_RING)
+		upload_ring_init(&ring, max_rects_count * sizeof(rects_cpu_buffer[0]));
+	const char* defines = sdf_aa_defines(sdf_aa);
+	char* vertex_shader = NULL, *fragment_shader = NULL;
+	GLuint program = load_shader_program_separable(false, 2, (shader_type_and_source_t[]){
+		{ GL_VERTEX_SHADER, vertex_shader = shader_variant(defines,
 			"#version 450 core\n"
 			"\n"
 			"layout(location = 0) uniform vec2 half_viewport_size;\n"
@@ -3318,7 +7850,11 @@ void bench_one_ssbo_ext_one_sdf(scenario_args_t* args, bool use_builtin_scenario
 			"out uint    vertex_texture_unit;\n"
 			"out uint    vertex_texture_array_index;\n"
 			"out vec4    vertex_base_color;\n"
-			"out vec2    vertex_pos;\n"
+			"#ifdef SDF_PER_SAMPLE\n"
+			"out sample vec2    vertex_pos;\n"
+			"#else\n"
+			"out vec2           vertex_pos;\n"
+			"#endif\n"
 			"out vec2    vertex_tex_coords;\n"
 			"out vec4    vertex_border_color;\n"
 			"out float   vertex_border_width;\n"
@@ -3366,9 +7902,9 @@ void bench_one_ssbo_ext_one_sdf(scenario_args_t* args, bool use_builtin_scenario
 			"	vec2 axes_flip = vec2(1, -1);  // to flip y axis from bottom-up (OpenGL standard) to top-down (normal for UIs)\n"
 			"	vec2 pos_ndc   = (vertex_pos / half_viewport_size - 1.0) * axes_flip;\n"
 			"	gl_Position = vec4(pos_ndc, 0, 1);\n"
-			"	//gl_Layer = int(layer);\n"
-			"}\n"
-		}, { GL_FRAGMENT_SHADER,
+			"	//gl_Layer = int(layer);\n"
+			"}\n")
+		}, { GL_FRAGMENT_SHADER, fragment_shader = shader_variant(defines,
 			"#version 450 core\n"
 			"\n"
 			"// Note: binding is the number of the texture unit, not the uniform location. We don't care about the uniform location\n"
@@ -3395,7 +7931,11 @@ void bench_one_ssbo_ext_one_sdf(scenario_args_t* args, bool use_builtin_scenario
 			"in flat uint    vertex_texture_unit;\n"
 			"in flat uint    vertex_texture_array_index;\n"
 			"in flat vec4    vertex_base_color;\n"
+			"#ifdef SDF_PER_SAMPLE\n"
+			"in sample vec2    vertex_pos;  // The SDF is evaluated for each sample, MSAA anti-aliases its edges\n"
+			"#else\n"
 			"in      vec2    vertex_pos;\n"
+			"#endif\n"
 			"in      vec2    vertex_tex_coords;\n"
 			"in flat vec4    vertex_border_color;\n"
 			"in flat float   vertex_border_width;\n"
@@ -3501,11 +8041,19 @@ void bench_one_ssbo_ext_one_sdf(scenario_args_t* args, bool use_builtin_scenario
 			"				distance = sdAxisAlignedRect(vertex_pos, vertex_points[0], vertex_points[1]);\n"
 			"				break;\n"
 			"		}\n"
+			"		#ifdef NO_SDF_AA\n"
+			"		float coverage = (distance < 0) ? 1 : 0;\n"
+			"		#else\n"
 			"		float pixel_width = dFdx(vertex_pos.x) * 1;  // Use 2.0 for a smoother AA look\n"
 			"		float coverage = 1 - smoothstep(-pixel_width, 0, distance);\n"
+			"		#endif\n"
 			"		\n"
 			"		if ((vertex_flags & RF_USE_BORDER) != 0) {\n"
+			"			#ifdef NO_SDF_AA\n"
+			"			float border_inner_transition = (distance > -vertex_border_width) ? 1 : 0;\n"
+			"			#else\n"
 			"			float border_inner_transition = 1 - smoothstep(-vertex_border_width, -(vertex_border_width + pixel_width), distance);\n"
+			"			#endif\n"
 			"			content_color = vec4(mix(content_color.rgb, vertex_border_color.rgb, border_inner_transition * vertex_border_color.a), content_color.a);\n"
 			"		}\n"
 			"		\n"
@@ -3514,27 +8062,30 @@ void bench_one_ssbo_ext_one_sdf(scenario_args_t* args, bool use_builtin_scenario
 			"		fragment_color = content_color;\n"
 			"	}\n"
 			"}\n"
-		}
+		)}
 	});
+	free(vertex_shader);
+	free(fragment_shader);
 	
-	report_approach_start(use_builtin_scenario ? "one_ssbo_ext_one_sdf_demo" : "one_ssbo_ext_one_sdf");
+	report_approach_start(use_builtin_scenario ? "one_ssbo_ext_one_sdf_demo" : (sdf_aa == SDF_AA_SHADER) ? "one_ssbo_ext_one_sdf" : (sdf_aa == SDF_AA_NONE) ? "one_ssbo_ext_one_sdf_noaa" : "one_ssbo_ext_one_sdf_msaa_persample");
 	
 	for (uint32_t frame_index = 0; frame_index < args->frame_count; frame_index++) {
+		animation_next_frame(args);
 		report_frame_start();
 			
-			// Update SSBO with new data (doesn't change here but would with real usecases)
+			// Update SSBO with new data (only changes between frames with --animate=)
 			uint32_t rects_count = 0;
 			if (use_builtin_scenario) {
-				rects_cpu_buffer[rects_count++] = (one_ssbo_rect_t){
+				rects_cpu_buffer[rects_count++] = (one_ssbo_ext_one_sdf_rect_t){
 					.base_color = (color_t){ 16, 16, 16, 255 },
 					.left = 10, .top = 10, .right = 20, .bottom = 20
 				};
-				rects_cpu_buffer[rects_count++] = (one_ssbo_rect_t){
+				rects_cpu_buffer[rects_count++] = (one_ssbo_ext_one_sdf_rect_t){
 					.base_color = (color_t){ 16, 16, 16, 255 },
 					.left = 30, .top = 10, .right = 40, .bottom = 20,
 					.sdf_type = SDF_RECT, .points[0] = vecs(30, 10), .points[1] = vecs(40, 20)
 				};
-				rects_cpu_buffer[rects_count++] = (one_ssbo_rect_t){
+				rects_cpu_buffer[rects_count++] = (one_ssbo_ext_one_sdf_rect_t){
 					.base_color = (color_t){ 16, 16, 16, 255 },
 					.left = 50, .top = 10, .right = 60, .bottom = 20,
 					.sdf_type = SDF_RECT, .points[0] = vecs(50, 10), .points[1] = vecs(60, 20),
@@ -3542,76 +8093,49 @@ void bench_one_ssbo_ext_one_sdf(scenario_args_t* args, bool use_builtin_scenario
 					.flags = ONE_SSBO_USE_BORDER
 				};
 				
-				rects_cpu_buffer[rects_count++] = (one_ssbo_rect_t){
+				rects_cpu_buffer[rects_count++] = (one_ssbo_ext_one_sdf_rect_t){
 					.base_color = (color_t){ 16, 16, 16, 255 },
 					.left = 100, .top = 100, .right = 200, .bottom = 200,
 					.sdf_type = SDF_ROUNDED_RECT, .points[0] = vecs(100, 100), .points[1] = vecs(200, 200), .corner_radius = 10
 				};
-				rects_cpu_buffer[rects_count++] = (one_ssbo_rect_t){
+				rects_cpu_buffer[rects_count++] = (one_ssbo_ext_one_sdf_rect_t){
 					.base_color = (color_t){ 16, 16, 16, 255 },
 					.left = 300, .top = 100, .right = 400, .bottom = 200,
 					.sdf_type = SDF_CIRCLE, .points[0] = vecs(350, 150), .corner_radius = 50
 				};
-				rects_cpu_buffer[rects_count++] = (one_ssbo_rect_t){
+				rects_cpu_buffer[rects_count++] = (one_ssbo_ext_one_sdf_rect_t){
 					.base_color = (color_t){ 16, 16, 16, 255 },
 					.left = 500, .top = 100, .right = 600, .bottom = 200,
 					.sdf_type = SDF_INV_CIRCLE, .points[0] = vecs(550, 150), .corner_radius = 50
 				};
-				rects_cpu_buffer[rects_count++] = (one_ssbo_rect_t){
+				rects_cpu_buffer[rects_count++] = (one_ssbo_ext_one_sdf_rect_t){
 					.base_color = (color_t){ 16, 16, 16, 255 },
 					.left = 700, .top = 100, .right = 800, .bottom = 200,
 					.sdf_type = SDF_POLYGON, .point_count = 7,
 					.points[0] = vecs(700, 120), .points[1] = vecs(720, 100), .points[2] = vecs(740, 100), .points[3] = vecs(760, 120),
 					.points[4] = vecs(800, 120), .points[5] = vecs(800, 140), .points[6] = vecs(700, 140)
 				};
-				rects_cpu_buffer[rects_count++] = (one_ssbo_rect_t){
+				rects_cpu_buffer[rects_count++] = (one_ssbo_ext_one_sdf_rect_t){
 					.base_color = (color_t){ 16, 16, 16, 255 },
 					.left = 900, .top = 100, .right = 1000, .bottom = 200,
 					.sdf_type = SDF_POLYGON, .point_count = 7, .corner_radius = 8,
 					.points[0] = vecs(900+8, 120+8), .points[1] = vecs(920+8, 100+8), .points[2] = vecs(940-8, 100+8), .points[3] = vecs(960-8, 120+8),
 					.points[4] = vecs(1000-8, 120+8), .points[5] = vecs(1000-8, 140-8), .points[6] = vecs(900+8, 140-8)
 				};
-				rects_cpu_buffer[rects_count++] = (one_ssbo_rect_t){
+				rects_cpu_buffer[rects_count++] = (one_ssbo_ext_one_sdf_rect_t){
 					.base_color = (color_t){ 16, 16, 16, 255 },
 					.left = 1100, .top = 100, .right = 1100+7*4, .bottom = 100+16*4,
 					.sdf_type = SDF_TEXTURE, .flags = ONE_SSBO_USE_TEXTURE, .tex_unit = 0,
 					.tex_left = 168, .tex_top = 0, .tex_right = 168+7, .tex_bottom = 0+16
 				};
-				rects_cpu_buffer[rects_count++] = (one_ssbo_rect_t){
+				rects_cpu_buffer[rects_count++] = (one_ssbo_ext_one_sdf_rect_t){
 					.base_color = (color_t){ 16, 16, 16, 255 },
 					.left = 1300, .top = 100, .right = 1400, .bottom = 200,
 					.sdf_type = SDF_CIRCLE_SEGMENT, .points[0] = vecs(1350, 150), .points[1] = vecs(50, 30), .points[2] = vecs(1300, 130), .points[3] = vecs(1300, 170)
 				};
+				assert(rects_count == demo_rects_count);
 			} else {
-				for (uint32_t i = 0; i < args->rects_count; i++) {
-					// rectl_t  pos;
-					// color_t  background_color;
-					// bool     has_border, has_rounded_corners, has_texture, has_texture_array, has_glyph;
-					// float    border_width;
-					// color_t  border_color;
-					// uint32_t corner_radius;
-					// GLuint   texture_index;
-					// uint32_t texture_array_index;
-					// rectf_t  texture_coords;
-					// uint32_t random;
-					rect_t* r = &args->rects_ptr[i];
-					rects_cpu_buffer[i] = (one_ssbo_rect_t){
-						.flags = ((r->has_texture || r->has_texture_array) ? ONE_SSBO_USE_TEXTURE : 0) | ((r->has_border || r->has_rounded_corners) ? ONE_SSBO_USE_BORDER : 0) | (r->has_glyph ? ONE_SSBO_GLYPH : 0),
-						.layer = 0, .tex_unit = r->texture_index, .tex_array_index = r->texture_array_index,
-						.base_color = r->background_color,
-						.left = r->pos.l, .top = r->pos.t, .right = r->pos.r, .bottom = r->pos.b,
-						
-						.tex_left = r->texture_coords.l, .tex_top = r->texture_coords.t, .tex_right = r->texture_coords.r, .tex_bottom = r->texture_coords.b,
-						.border_color = r->border_color, .border_width = r->border_width, .corner_radius = r->corner_radius
-					};
-					
-					if (r->corner_radius > 0) {
-						rects_cpu_buffer[i].sdf_type = SDF_ROUNDED_RECT;
-						rects_cpu_buffer[i].points[0] = vecs(r->pos.l, r->pos.t);
-						rects_cpu_buffer[i].points[1] = vecs(r->pos.r, r->pos.b);
-						rects_cpu_buffer[i].point_count = 2;
-					}
-				}
+				jobs_parallel_for(&gen_jobs, args->rects_count, one_ssbo_ext_one_sdf_pack_rects, &(one_ssbo_ext_one_sdf_pack_t){ .args = args, .rects_cpu_buffer = rects_cpu_buffer });
 				rects_count = args->rects_count;
 			}
 			
@@ -3620,8 +8144,13 @@ void bench_one_ssbo_ext_one_sdf(scenario_args_t* args, bool use_builtin_scenario
 			// Create a new GPU buffer each time so we don't have to wait for the previous draw call to finish.
 			// Instead the old buffer data gets orphaned and freed once the previous frame is done. This prevents a
 			// pipeline stall on continous refresh.
-			glInvalidateBufferData(ssbo);
-			glNamedBufferData(ssbo, rects_count * sizeof(rects_cpu_buffer[0]), rects_cpu_buffer, GL_STREAM_DRAW);
+			if (upload_mode == UPLOAD_RING) {
+				upload_ring_write(&ring, rects_cpu_buffer, rects_count * sizeof(rects_cpu_buffer[0]));
+			} else {
+				glInvalidateBufferData(ssbo);
+				glNamedBufferData(ssbo, rects_count * sizeof(rects_cpu_buffer[0]), rects_cpu_buffer, GL_STREAM_DRAW);
+				report_upload_bytes(rects_count * sizeof(rects_cpu_buffer[0]));
+			}
 			
 		report_upload_done();
 			
@@ -3632,8 +8161,12 @@ void bench_one_ssbo_ext_one_sdf(scenario_args_t* args, bool use_builtin_scenario
 			
 			glBindVertexArray(vao);
 				glUseProgram(program);
-					glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo);
-						glProgramUniform2f(program, 0, window_width / 2, window_height / 2);
+					if (upload_mode == UPLOAD_RING) {
+						upload_ring_bind(&ring, GL_SHADER_STORAGE_BUFFER, 0);
+					} else {
+						glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo);
+					}
+						glProgramUniform2f(program, 0, window_width / 2.0f, window_height / 2.0f);
 						
 						glBindTextureUnit(0, args->glyph_texture);
 						glBindTextureUnit(1, args->image_texture);
@@ -3644,10 +8177,12 @@ void bench_one_ssbo_ext_one_sdf(scenario_args_t* args, bool use_builtin_scenario
 					glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
 				glUseProgram(0);
 			glBindVertexArray(0);
+			if (upload_mode == UPLOAD_RING)
+				upload_ring_fence(&ring);
 			
 		report_draw_done();
 			
-			SDL_GL_SwapWindow(args->window);
+			display_present(args->display);
 			
 		report_frame_end();
 	}
@@ -3656,37 +8191,27 @@ void bench_one_ssbo_ext_one_sdf(scenario_args_t* args, bool use_builtin_scenario
 	unload_shader_program(program);
 	glDeleteVertexArrays(1, &vao);
 	glDeleteBuffers(1, &ssbo);
+	if (upload_mode == UPLOAD_RING)
+		upload_ring_destroy(&ring);
 	free(rects_cpu_buffer);
 }
 
 void bench_one_ssbo_ext_one_sdf_pack(scenario_args_t* args) {
 	// Setup
 	int window_width = 0, window_height = 0;
-	SDL_GetWindowSize(args->window, &window_width, &window_height);
+	display_size(args->display, &window_width, &window_height);
 	
-	enum { ONE_SSBO_USE_TEXTURE = (1 << 0), ONE_SSBO_USE_BORDER = (1 << 1), ONE_SSBO_GLYPH = (1 << 2) };
-	enum { SDF_NONE = 0, SDF_ROUNDED_RECT, SDF_CIRCLE, SDF_INV_CIRCLE, SDF_POLYGON, SDF_TEXTURE, SDF_CIRCLE_SEGMENT, SDF_RECT };
-	typedef struct {
-		uint8_t  flags, layer, tex_unit, tex_array_index;
-		color_t  base_color;
-		uint16_t left, top;
-		uint16_t right, bottom;
-		
-		uint16_t tex_left, tex_top;
-		uint16_t tex_right, tex_bottom;
-		color_t  border_color;
-		uint8_t  border_width, corner_radius, sdf_type, point_count;
-		
-		vecs_t   points[8];
-	} one_ssbo_rect_t;
-	one_ssbo_rect_t* rects_cpu_buffer = malloc(args->rects_count * sizeof(rects_cpu_buffer[0]));
+	one_ssbo_ext_one_sdf_rect_t* rects_cpu_buffer = malloc(args->rects_count * sizeof(rects_cpu_buffer[0]));
 	
 	// All the data goes into the SSBO and we only use an empty VAO for the draw command. The shader then assembles the
 	// per-vertex data by itself. An empty VAO should work according to spec, see https://community.khronos.org/t/running-a-vertex-shader-without-any-per-vertex-attribute/69568/4.
 	GLuint vao = 0, ssbo = 0;
 	glCreateVertexArrays(1, &vao);
 	glCreateBuffers(1, &ssbo);
-	GLuint program = load_shader_program(2, (shader_type_and_source_t[]){
+	upload_ring_t ring = { 0 };
+	if (upload_mode == UPLOAD_RING)
+		upload_ring_init(&ring, args->rects_count * sizeof(rects_cpu_buffer[0]));
+	GLuint program = load_shader_program_separable(false, 2, (shader_type_and_source_t[]){
 		{ GL_VERTEX_SHADER,
 			"#version 450 core\n"
 			"\n"
@@ -3911,46 +8436,24 @@ void bench_one_ssbo_ext_one_sdf_pack(scenario_args_t* args) {
 	report_approach_start("one_ssbo_ext_one_sdf_pack");
 	
 	for (uint32_t frame_index = 0; frame_index < args->frame_count; frame_index++) {
+		animation_next_frame(args);
 		report_frame_start();
 			
-			// Update SSBO with new data (doesn't change here but would with real usecases)
-			for (uint32_t i = 0; i < args->rects_count; i++) {
-				// rectl_t  pos;
-				// color_t  background_color;
-				// bool     has_border, has_rounded_corners, has_texture, has_texture_array, has_glyph;
-				// float    border_width;
-				// color_t  border_color;
-				// uint32_t corner_radius;
-				// GLuint   texture_index;
-				// uint32_t texture_array_index;
-				// rectf_t  texture_coords;
-				// uint32_t random;
-				rect_t* r = &args->rects_ptr[i];
-				rects_cpu_buffer[i] = (one_ssbo_rect_t){
-					.flags = ((r->has_texture || r->has_texture_array) ? ONE_SSBO_USE_TEXTURE : 0) | ((r->has_border || r->has_rounded_corners) ? ONE_SSBO_USE_BORDER : 0) | (r->has_glyph ? ONE_SSBO_GLYPH : 0),
-					.layer = 0, .tex_unit = r->texture_index, .tex_array_index = r->texture_array_index,
-					.base_color = r->background_color,
-					.left = r->pos.l, .top = r->pos.t, .right = r->pos.r, .bottom = r->pos.b,
-					
-					.tex_left = r->texture_coords.l, .tex_top = r->texture_coords.t, .tex_right = r->texture_coords.r, .tex_bottom = r->texture_coords.b,
-					.border_color = r->border_color, .border_width = r->border_width, .corner_radius = r->corner_radius
-				};
-				
-				if (r->corner_radius > 0) {
-					rects_cpu_buffer[i].sdf_type = SDF_ROUNDED_RECT;
-					rects_cpu_buffer[i].points[0] = vecs(r->pos.l, r->pos.t);
-					rects_cpu_buffer[i].points[1] = vecs(r->pos.r, r->pos.b);
-					rects_cpu_buffer[i].point_count = 2;
-				}
-			}
+			// Update SSBO with new data (only changes between frames with --animate=)
+			jobs_parallel_for(&gen_jobs, args->rects_count, one_ssbo_ext_one_sdf_pack_rects, &(one_ssbo_ext_one_sdf_pack_t){ .args = args, .rects_cpu_buffer = rects_cpu_buffer });
 			
 		report_gen_buffers_done();
 			
 			// Create a new GPU buffer each time so we don't have to wait for the previous draw call to finish.
 			// Instead the old buffer data gets orphaned and freed once the previous frame is done. This prevents a
 			// pipeline stall on continous refresh.
-			glInvalidateBufferData(ssbo);
-			glNamedBufferData(ssbo, args->rects_count * sizeof(rects_cpu_buffer[0]), rects_cpu_buffer, GL_STREAM_DRAW);
+			if (upload_mode == UPLOAD_RING) {
+				upload_ring_write(&ring, rects_cpu_buffer, args->rects_count * sizeof(rects_cpu_buffer[0]));
+			} else {
+				glInvalidateBufferData(ssbo);
+				glNamedBufferData(ssbo, args->rects_count * sizeof(rects_cpu_buffer[0]), rects_cpu_buffer, GL_STREAM_DRAW);
+				report_upload_bytes(args->rects_count * sizeof(rects_cpu_buffer[0]));
+			}
 			
 		report_upload_done();
 			
@@ -3961,8 +8464,12 @@ void bench_one_ssbo_ext_one_sdf_pack(scenario_args_t* args) {
 			
 			glBindVertexArray(vao);
 				glUseProgram(program);
-					glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo);
-						glProgramUniform2f(program, 0, window_width / 2, window_height / 2);
+					if (upload_mode == UPLOAD_RING) {
+						upload_ring_bind(&ring, GL_SHADER_STORAGE_BUFFER, 0);
+					} else {
+						glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo);
+					}
+						glProgramUniform2f(program, 0, window_width / 2.0f, window_height / 2.0f);
 						
 						glBindTextureUnit(0, args->glyph_texture);
 						glBindTextureUnit(1, args->image_texture);
@@ -3973,10 +8480,12 @@ void bench_one_ssbo_ext_one_sdf_pack(scenario_args_t* args) {
 					glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
 				glUseProgram(0);
 			glBindVertexArray(0);
+			if (upload_mode == UPLOAD_RING)
+				upload_ring_fence(&ring);
 			
 		report_draw_done();
 			
-			SDL_GL_SwapWindow(args->window);
+			display_present(args->display);
 			
 		report_frame_end();
 	}
@@ -3985,15 +8494,17 @@ void bench_one_ssbo_ext_one_sdf_pack(scenario_args_t* args) {
 	unload_shader_program(program);
 	glDeleteVertexArrays(1, &vao);
 	glDeleteBuffers(1, &ssbo);
+	if (upload_mode == UPLOAD_RING)
+		upload_ring_destroy(&ring);
 	free(rects_cpu_buffer);
 }
 
 
 
-void bench_instancing_and_divisor(scenario_args_t* args) {
+void bench_instancing_and_divisor(scenario_args_t* args, sdf_aa_t sdf_aa) {
 	// Setup
 	int window_width = 0, window_height = 0;
-	SDL_GetWindowSize(args->window, &window_width, &window_height);
+	display_size(args->display, &window_width, &window_height);
 	
 	// Create a VBO for instanced rect rendering (render that VBO for each rect)
 	GLuint one_rect_vbo = 0;
@@ -4010,21 +8521,7 @@ void bench_instancing_and_divisor(scenario_args_t* args) {
 	
 	// Create the VBO for the individual rect data
 	GLuint rects_vbo = 0;
-	enum { ONE_SSBO_USE_TEXTURE = (1 << 0), ONE_SSBO_USE_BORDER = (1 << 1), ONE_SSBO_GLYPH = (1 << 2) };
-	enum { SDF_NONE = 0, SDF_ROUNDED_RECT, SDF_CIRCLE, SDF_INV_CIRCLE, SDF_POLYGON, SDF_TEXTURE, SDF_CIRCLE_SEGMENT, SDF_RECT };
-	typedef struct {
-		uint8_t  flags, layer, tex_unit, tex_array_index;
-		color_t  base_color;
-		uint16_t left, top;
-		uint16_t right, bottom;
-		
-		uint16_t tex_left, tex_top;
-		uint16_t tex_right, tex_bottom;
-		color_t  border_color;
-		uint8_t  border_width, corner_radius, sdf_type, point_count;
-		
-		vecs_t   points[8];
-	} vbo_rect_t;
+	typedef one_ssbo_ext_one_sdf_rect_t vbo_rect_t;  // Same format and packing as one_ssbo_ext_one_sdf
 	glCreateBuffers(1, &rects_vbo);
 	const uint32_t rects_size = args->rects_count * sizeof(vbo_rect_t);
 	vbo_rect_t* rects_ptr = malloc(rects_size);
@@ -4085,8 +8582,10 @@ void bench_instancing_and_divisor(scenario_args_t* args) {
 			glVertexArrayAttribFormat( vao, 10 + i, 2, GL_UNSIGNED_SHORT, false, offsetof(vbo_rect_t, points) + i*sizeof(vecs_t));
 		}
 	
-	GLuint shader_program = load_shader_program(2, (shader_type_and_source_t[]){
-		{ GL_VERTEX_SHADER,
+	const char* defines = sdf_aa_defines(sdf_aa);
+	char* vertex_shader = NULL, *fragment_shader = NULL;
+	GLuint shader_program = load_shader_program_separable(false, 2, (shader_type_and_source_t[]){
+		{ GL_VERTEX_SHADER, vertex_shader = shader_variant(defines,
 			"#version 450 core\n"
 			"\n"
 			"layout(location = 0) uniform vec2 half_viewport_size;\n"
@@ -4107,7 +8606,11 @@ void bench_instancing_and_divisor(scenario_args_t* args) {
 			"out uint    vertex_texture_unit;\n"
 			"out uint    vertex_texture_array_index;\n"
 			"out vec4    vertex_base_color;\n"
-			"out vec2    vertex_pos;\n"
+			"#ifdef SDF_PER_SAMPLE\n"
+			"out sample vec2    vertex_pos;\n"
+			"#else\n"
+			"out vec2           vertex_pos;\n"
+			"#endif\n"
 			"out vec2    vertex_tex_coords;\n"
 			"out vec4    vertex_border_color;\n"
 			"out float   vertex_border_width;\n"
@@ -4136,8 +8639,8 @@ void bench_instancing_and_divisor(scenario_args_t* args) {
 			"	vec2 pos_ndc   = (vertex_pos / half_viewport_size - 1.0) * axes_flip;\n"
 			"	gl_Position = vec4(pos_ndc, 0, 1);\n"
 			"	//gl_Layer = int(layer);\n"
-			"}\n"
-		}, { GL_FRAGMENT_SHADER,
+			"}\n")
+		}, { GL_FRAGMENT_SHADER, fragment_shader = shader_variant(defines,
 			"#version 450 core\n"
 			"\n"
 			"// Note: binding is the number of the texture unit, not the uniform location. We don't care about the uniform location\n"
@@ -4164,7 +8667,11 @@ void bench_instancing_and_divisor(scenario_args_t* args) {
 			"in flat uint    vertex_texture_unit;\n"
 			"in flat uint    vertex_texture_array_index;\n"
 			"in flat vec4    vertex_base_color;\n"
+			"#ifdef SDF_PER_SAMPLE\n"
+			"in sample vec2    vertex_pos;  // The SDF is evaluated for each sample, MSAA anti-aliases its edges\n"
+			"#else\n"
 			"in      vec2    vertex_pos;\n"
+			"#endif\n"
 			"in      vec2    vertex_tex_coords;\n"
 			"in flat vec4    vertex_border_color;\n"
 			"in flat float   vertex_border_width;\n"
@@ -4270,11 +8777,19 @@ void bench_instancing_and_divisor(scenario_args_t* args) {
 			"				distance = sdAxisAlignedRect(vertex_pos, vertex_points[0], vertex_points[1]);\n"
 			"				break;\n"
 			"		}\n"
+			"		#ifdef NO_SDF_AA\n"
+			"		float coverage = (distance < 0) ? 1 : 0;\n"
+			"		#else\n"
 			"		float pixel_width = dFdx(vertex_pos.x) * 1;  // Use 2.0 for a smoother AA look\n"
 			"		float coverage = 1 - smoothstep(-pixel_width, 0, distance);\n"
+			"		#endif\n"
 			"		\n"
 			"		if ((vertex_flags & RF_USE_BORDER) != 0) {\n"
+			"			#ifdef NO_SDF_AA\n"
+			"			float border_inner_transition = (distance > -vertex_border_width) ? 1 : 0;\n"
+			"			#else\n"
 			"			float border_inner_transition = 1 - smoothstep(-vertex_border_width, -(vertex_border_width + pixel_width), distance);\n"
+			"			#endif\n"
 			"			content_color = vec4(mix(content_color.rgb, vertex_border_color.rgb, border_inner_transition * vertex_border_color.a), content_color.a);\n"
 			"		}\n"
 			"		\n"
@@ -4283,44 +8798,19 @@ void bench_instancing_and_divisor(scenario_args_t* args) {
 			"		fragment_color = content_color;\n"
 			"	}\n"
 			"}\n"
-		}
+		)}
 	});
+	free(vertex_shader);
+	free(fragment_shader);
 	
-	report_approach_start("inst_div");
+	report_approach_start((sdf_aa == SDF_AA_SHADER) ? "inst_div" : (sdf_aa == SDF_AA_NONE) ? "inst_div_noaa" : "inst_div_msaa_persample");
 	
 	for (uint32_t frame_index = 0; frame_index < args->frame_count; frame_index++) {
+		animation_next_frame(args);
 		report_frame_start();
 			
-			// Update VBO with new data (doesn't change here but would with real usecases)
-			for (uint32_t i = 0; i < args->rects_count; i++) {
-				// rectl_t  pos;
-				// color_t  background_color;
-				// bool     has_border, has_rounded_corners, has_texture, has_texture_array, has_glyph;
-				// float    border_width;
-				// color_t  border_color;
-				// uint32_t corner_radius;
-				// GLuint   texture_index;
-				// uint32_t texture_array_index;
-				// rectf_t  texture_coords;
-				// uint32_t random;
-				rect_t* r = &args->rects_ptr[i];
-				rects_ptr[i] = (vbo_rect_t){
-					.flags = ((r->has_texture || r->has_texture_array) ? ONE_SSBO_USE_TEXTURE : 0) | ((r->has_border || r->has_rounded_corners) ? ONE_SSBO_USE_BORDER : 0) | (r->has_glyph ? ONE_SSBO_GLYPH : 0),
-					.layer = 0, .tex_unit = r->texture_index, .tex_array_index = r->texture_array_index,
-					.base_color = r->background_color,
-					.left = r->pos.l, .top = r->pos.t, .right = r->pos.r, .bottom = r->pos.b,
-					
-					.tex_left = r->texture_coords.l, .tex_top = r->texture_coords.t, .tex_right = r->texture_coords.r, .tex_bottom = r->texture_coords.b,
-					.border_color = r->border_color, .border_width = r->border_width, .corner_radius = r->corner_radius
-				};
-				
-				if (r->corner_radius > 0) {
-					rects_ptr[i].sdf_type = SDF_ROUNDED_RECT;
-					rects_ptr[i].points[0] = vecs(r->pos.l, r->pos.t);
-					rects_ptr[i].points[1] = vecs(r->pos.r, r->pos.b);
-					rects_ptr[i].point_count = 2;
-				}
-			}
+			// Update VBO with new data (only changes between frames with --animate=)
+			jobs_parallel_for(&gen_jobs, args->rects_count, one_ssbo_ext_one_sdf_pack_rects, &(one_ssbo_ext_one_sdf_pack_t){ .args = args, .rects_cpu_buffer = rects_ptr });
 			
 		report_gen_buffers_done();
 			
@@ -4328,6 +8818,7 @@ void bench_instancing_and_divisor(scenario_args_t* args) {
 			// Instead the old buffer data gets orphaned and freed once the previous frame is done. This prevents a
 			// pipeline stall on continous refresh.
 			glNamedBufferData(rects_vbo, rects_size, rects_ptr, GL_STREAM_DRAW);
+			report_upload_bytes(rects_size);
 			
 		report_upload_done();
 			
@@ -4338,7 +8829,7 @@ void bench_instancing_and_divisor(scenario_args_t* args) {
 			
 			glBindVertexArray(vao);
 				glUseProgram(shader_program);
-					glProgramUniform2f(shader_program, 0, window_width / 2, window_height / 2);
+					glProgramUniform2f(shader_program, 0, window_width / 2.0f, window_height / 2.0f);
 					
 					glBindTextureUnit(0, args->glyph_texture);
 					glBindTextureUnit(1, args->image_texture);
@@ -4350,7 +8841,7 @@ void bench_instancing_and_divisor(scenario_args_t* args) {
 			
 		report_draw_done();
 			
-			SDL_GL_SwapWindow(args->window);
+			display_present(args->display);
 			
 		report_frame_end();
 	}
@@ -4364,6 +8855,249 @@ void bench_instancing_and_divisor(scenario_args_t* args) {
 }
 
 
+void bench_cpu_raster(scenario_args_t* args) {
+	// Setup
+	int window_width = 0, window_height = 0;
+	display_size(args->display, &window_width, &window_height);
+	
+	cpu_raster_select_spans();
+	cpu_raster_t raster;
+	cpu_raster_init(&raster, window_width, window_height);
+	// Same texture units as the one_ssbo shaders
+	raster.textures[0]  = cpu_texture_from_gl(args->glyph_texture);
+	raster.textures[1]  = cpu_texture_from_gl(args->image_texture);
+	raster.textures[12] = cpu_texture_from_gl(args->texture_array);
+	
+	// The finished image is uploaded into a texture and drawn into the framebuffer with one triangle that covers it,
+	// flipped since its first row is the top row. Drawn instead of blitted since blits into multisampled framebuffers
+	// (--msaa=) aren't allowed.
+	GLuint frame_texture = 0, vao = 0;
+	glCreateTextures(GL_TEXTURE_2D, 1, &frame_texture);
+	glTextureStorage2D(frame_texture, 1, GL_RGBA8, window_width, window_height);
+	glCreateVertexArrays(1, &vao);
+	GLuint program = load_shader_program_separable(false, 2, (shader_type_and_source_t[]){
+		{ GL_VERTEX_SHADER,
+			"#version 450 core\n"
+			"\n"
+			"void main() {\n"
+			"	vec2 pos = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 4.0 - 1.0;\n"
+			"	gl_Position = vec4(pos, 0, 1);\n"
+			"}\n"
+		},
+		{ GL_FRAGMENT_SHADER,
+			"#version 450 core\n"
+			"\n"
+			"layout(binding = 0) uniform sampler2D frame;\n"
+			"out vec4 fragment_color;\n"
+			"\n"
+			"void main() {\n"
+			"	ivec2 size = textureSize(frame, 0);\n"
+			"	fragment_color = texelFetch(frame, ivec2(gl_FragCoord.x, size.y - 1 - int(gl_FragCoord.y)), 0);\n"
+			"}\n"
+		}
+	});
+	
+	report_approach_start("cpu_raster");
+	
+	for (uint32_t frame_index = 0; frame_index < args->frame_count; frame_index++) {
+		animation_next_frame(args);
+		report_frame_start();
+			
+			// Same color as the glClearColor(0.8, 0.8, 1.0, 1.0) of the other approaches
+			cpu_raster_draw(&raster, args->rects_ptr, args->rects_count, (color_t){ 204, 204, 255, 255 });
+		
+		report_gen_buffers_done();
+			
+			glTextureSubImage2D(frame_texture, 0, 0, 0, window_width, window_height, GL_RGBA, GL_UNSIGNED_BYTE, raster.pixels);
+			report_upload_bytes((uint64_t)window_width * window_height * 4);
+		
+		report_upload_done();
+			
+			glClearColor(0.8, 0.8, 1.0, 1.0);
+			glClear(GL_COLOR_BUFFER_BIT);
+		
+		report_clear_done();
+			
+			// The image is already blended, so it replaces the framebuffer contents
+			glDisable(GL_BLEND);
+			glBindVertexArray(vao);
+			glUseProgram(program);
+			glBindTextureUnit(0, frame_texture);
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+			glEnable(GL_BLEND);
+		
+		report_draw_done();
+			
+			display_present(args->display);
+		
+		report_frame_end();
+	}
+	report_approach_end();
+	
+	glDeleteProgram(program);
+	glDeleteVertexArrays(1, &vao);
+	glDeleteTextures(1, &frame_texture);
+	cpu_raster_destroy(&raster);
+}
+
+
+
+//
+// Registry of all scenarios and approaches
+//
+// main() runs every approach in every scenario, filtered by the --scenario= and --approach= command line options. The
+// name of an approach has to be the same one the bench function passes to report_approach_start(). Otherwise the
+// filter wouldn't match what ends up in the CSV files.
+//
+
+typedef struct {
+	const char* name;
+	void (*generate_rects)(uint32_t* rects_count, rect_t** rects_ptr);  // NULL for scenarios built into an approach
+	const char* scene_filename;  // Scenarios of --scene=file options get their rects from that file instead
+	generate_rects_opts_t* synthetic_opts;  // Scenarios of --synthetic= options get their rects from generate_rects_random()
+} scenario_t;
+
+typedef struct {
+	const char* name;
+	void (*bench)(scenario_args_t* args, uint32_t param1, uint32_t param2);
+	uint32_t param1, param2;
+	bool builtin_scenario;  // Approach ignores args->rects_ptr and only runs in scenarios without generate_rects
+	bool msaa_only;         // Only runs with --msaa= or when --approach= names it, see approach_selected()
+} approach_t;
+
+void run_one_rect_per_draw(scenario_args_t* args, uint32_t use_program_pipeline, uint32_t unused) {
+	bench_one_rect_per_draw(args, use_program_pipeline);
+}
+void run_multi_draw_indirect(scenario_args_t* args, uint32_t unused1, uint32_t unused2) {
+	bench_multi_draw_indirect(args);
+}
+void run_simple_vertex_buffer_for_all_rects(scenario_args_t* args, uint32_t use_buffer_storage, uint32_t unused) {
+	bench_simple_vertex_buffer_for_all_rects(args, use_buffer_storage);
+}
+void run_complete_vertex_buffer_for_all_rects(scenario_args_t* args, uint32_t unused1, uint32_t unused2) {
+	bench_complete_vertex_buffer_for_all_rects(args);
+}
+void run_one_ssbo(scenario_args_t* args, uint32_t sdf_aa, uint32_t use_batch_packer) {
+	bench_one_ssbo(args, sdf_aa, use_batch_packer, ONE_SSBO_UPLOAD_ALL);
+}
+void run_one_ssbo_upload(scenario_args_t* args, uint32_t use_batch_packer, uint32_t upload) {
+	bench_one_ssbo(args, SDF_AA_SHADER, use_batch_packer, upload);
+}
+void run_ssbo_instruction_list(scenario_args_t* args, uint32_t use_batch_packer, uint32_t unused) {
+	bench_ssbo_instruction_list(args, use_batch_packer);
+}
+void run_ssbo_inlined_instr_6(scenario_args_t* args, uint32_t use_batch_packer, uint32_t unused) {
+	bench_ssbo_inlined_instr_6(args, use_batch_packer);
+}
+void run_ssbo_inlined_instr(scenario_args_t* args, uint32_t rect_instr_count, uint32_t vertex_instr_count) {
+	bench_ssbo_inlined_instr(args, rect_instr_count, vertex_instr_count);
+}
+void run_ssbo_fixed_vertex_to_fragment_buffer(scenario_args_t* args, uint32_t vertex_instr_count, uint32_t unused) {
+	bench_ssbo_fixed_vertex_to_fragment_buffer(args, vertex_instr_count);
+}
+void run_one_ssbo_ext_no_sdf(scenario_args_t* args, uint32_t unused1, uint32_t unused2) {
+	bench_one_ssbo_ext_no_sdf(args);
+}
+void run_one_ssbo_ext_sdf_list(scenario_args_t* args, uint32_t unused1, uint32_t unused2) {
+	bench_one_ssbo_ext_sdf_list(args);
+}
+void run_one_ssbo_ext_one_sdf(scenario_args_t* args, uint32_t use_builtin_scenario, uint32_t sdf_aa) {
+	bench_one_ssbo_ext_one_sdf(args, use_builtin_scenario, sdf_aa);
+}
+void run_one_ssbo_ext_one_sdf_pack(scenario_args_t* args, uint32_t unused1, uint32_t unused2) {
+	bench_one_ssbo_ext_one_sdf_pack(args);
+}
+void run_instancing_and_divisor(scenario_args_t* args, uint32_t sdf_aa, uint32_t unused) {
+	bench_instancing_and_divisor(args, sdf_aa);
+}
+void run_cpu_raster(scenario_args_t* args, uint32_t unused1, uint32_t unused2) {
+	bench_cpu_raster(args);
+}
+
+const scenario_t scenarios[] = {
+	{ "sublime",     generate_rects_sublime_sample,     NULL, NULL },
+	{ "mediaplayer", generate_rects_mediaplayer_sample, NULL, NULL },
+	{ "demo",        NULL,                              NULL, NULL },
+};
+
+const approach_t approaches[] = {
+	// name, bench function, param1, param2, builtin_scenario, msaa_only
+	{ "1rect_1draw",                         run_one_rect_per_draw,                      0,  0, false, false },
+	{ "mdi_runs",                            run_multi_draw_indirect,                    0,  0, false, false },
+	{ "simple_vbo",                          run_simple_vertex_buffer_for_all_rects,     0,  0, false, false },
+	{ "simple_vbo_stor",                     run_simple_vertex_buffer_for_all_rects,     1,  0, false, false },
+	{ "complete_vbo",                        run_complete_vertex_buffer_for_all_rects,   0,  0, false, false },
+	{ "one_ssbo",                            run_one_ssbo,                               0,  0, false, false },
+	{ "one_ssbo_simd",                       run_one_ssbo,                               0,  1, false, false },  // *_simd: batch packers, see --gen-simd=
+	{ "one_ssbo_dirty",                      run_one_ssbo_upload,                        0,  1, false, false },  // *_dirty: only changed rects, see --animate=
+	{ "one_ssbo_simd_dirty",                 run_one_ssbo_upload,                        1,  1, false, false },
+	{ "one_ssbo_fused",                      run_one_ssbo_upload,                        0,  2, false, false },  // *_fused: packed right into mapped memory
+	{ "one_ssbo_simd_fused",                 run_one_ssbo_upload,                        1,  2, false, false },
+	{ "ssbo_instr_list",                     run_ssbo_instruction_list,                  0,  0, false, false },
+	{ "ssbo_instr_list_simd",                run_ssbo_instruction_list,                  1,  0, false, false },
+	{ "ssbo_inlined_instr_6",                run_ssbo_inlined_instr_6,                   0,  0, false, false },
+	{ "ssbo_inlined_instr_6_simd",           run_ssbo_inlined_instr_6,                   1,  0, false, false },
+	{ "ssbo_inlined_instr_4_4",              run_ssbo_inlined_instr,                     4,  4, false, false },
+	{ "ssbo_inlined_instr_6_6",              run_ssbo_inlined_instr,                     6,  6, false, false },
+	{ "ssbo_inlined_instr_8_8",              run_ssbo_inlined_instr,                     8,  8, false, false },
+	{ "ssbo_inlined_instr_10_10",            run_ssbo_inlined_instr,                    10, 10, false, false },
+	{ "ssbo_inlined_instr_20_20",            run_ssbo_inlined_instr,                    20, 20, false, false },
+	{ "ssbo_inlined_instr_4_6",              run_ssbo_inlined_instr,                     4,  6, false, false },
+	{ "ssbo_inlined_instr_4_8",              run_ssbo_inlined_instr,                     4,  8, false, false },
+	{ "ssbo_inlined_instr_4_10",             run_ssbo_inlined_instr,                     4, 10, false, false },
+	{ "ssbo_inlined_instr_4_20",             run_ssbo_inlined_instr,                     4, 20, false, false },
+	{ "ssbo_inlined_instr_6_4",              run_ssbo_inlined_instr,                     6,  4, false, false },
+	{ "ssbo_inlined_instr_8_4",              run_ssbo_inlined_instr,                     8,  4, false, false },
+	{ "ssbo_inlined_instr_10_4",             run_ssbo_inlined_instr,                    10,  4, false, false },
+	{ "ssbo_inlined_instr_20_4",             run_ssbo_inlined_instr,                    20,  4, false, false },
+	{ "ssbo_instr_combo_4",                  run_ssbo_fixed_vertex_to_fragment_buffer,   4,  0, false, false },
+	{ "ssbo_instr_combo_6",                  run_ssbo_fixed_vertex_to_fragment_buffer,   6,  0, false, false },
+	{ "ssbo_instr_combo_8",                  run_ssbo_fixed_vertex_to_fragment_buffer,   8,  0, false, false },
+	{ "ssbo_instr_combo_10",                 run_ssbo_fixed_vertex_to_fragment_buffer,  10,  0, false, false },
+	{ "ssbo_instr_combo_20",                 run_ssbo_fixed_vertex_to_fragment_buffer,  20,  0, false, false },
+	{ "one_ssbo_ext_no_sdf",                 run_one_ssbo_ext_no_sdf,                    0,  0, false, false },
+	{ "one_ssbo_ext_sdf_list",               run_one_ssbo_ext_sdf_list,                  0,  0, false, false },
+	{ "one_ssbo_ext_one_sdf",                run_one_ssbo_ext_one_sdf,                   0,  0, false, false },
+	{ "one_ssbo_ext_one_sdf_pack",           run_one_ssbo_ext_one_sdf_pack,              0,  0, false, false },
+	{ "inst_div",                            run_instancing_and_divisor,                 0,  0, false, false },
+	{ "cpu_raster",                          run_cpu_raster,                             0,  0, false, false },
+	// Variants with hard edges instead of the SDF anti-aliasing, they only run with --msaa= (or when named explicitly).
+	// *_noaa evaluate the SDF once per pixel, *_msaa_persample once per sample (sdf_aa_t).
+	{ "one_ssbo_noaa",                       run_one_ssbo,                               1,  0, false, true  },
+	{ "one_ssbo_ext_one_sdf_noaa",           run_one_ssbo_ext_one_sdf,                   0,  1, false, true  },
+	{ "inst_div_noaa",                       run_instancing_and_divisor,                 1,  0, false, true  },
+	{ "one_ssbo_msaa_persample",             run_one_ssbo,                               2,  0, false, true  },
+	{ "one_ssbo_ext_one_sdf_msaa_persample", run_one_ssbo_ext_one_sdf,                   0,  2, false, true  },
+	{ "inst_div_msaa_persample",             run_instancing_and_divisor,                 2,  0, false, true  },
+	{ "one_ssbo_ext_one_sdf_demo",           run_one_ssbo_ext_one_sdf,                   1,  0, true,  false },
+};
+
+bool approach_runs_in_scenario(const approach_t* approach, const scenario_t* scenario) {
+	return approach->builtin_scenario == (scenario->generate_rects == NULL && scenario->scene_filename == NULL && scenario->synthetic_opts == NULL);
+}
+
+/**
+ * Checks an approach against the --approach= filter. The msaa_only approaches are left out without MSAA, they don't
+ * measure anything useful then. Naming one in the filter (not just matching a pattern) runs it anyway.
+ */
+bool approach_selected(const approach_t* approach, const char* approach_filter, uint32_t msaa_samples) {
+	if ( !glob_list_match(approach_filter, approach->name) )
+		return false;
+	if (!approach->msaa_only || msaa_samples > 1)
+		return true;
+	if (approach_filter == NULL)
+		return false;
+	
+	char* names = strdup(approach_filter);
+	bool named = false;
+	for (char* name = strtok(names, ","); name != NULL && !named; name = strtok(NULL, ","))
+		named = (strcmp(name, approach->name) == 0);
+	free(names);
+	
+	return named;
+}
+
+
 
 //
 // Main program that starts all benchmarks in various configurations
@@ -4373,6 +9107,38 @@ int main(int argc, char** argv) {
 	// Process command line arguments
 	bool use_gl_debug_log = false, write_gl_info = false, print_scenario_stats = false;
 	uint32_t frame_count = 100;
+	display_backend_t display_backend = DISPLAY_SDL;
+	int window_width = 1600, window_height = 1000;
+	bool offscreen = false;
+	GLenum offscreen_format = GL_RGBA8;
+	uint32_t msaa_samples = 0;  // Multisampled offscreen framebuffer with --msaa=
+	uint32_t warmup_frames = 0;
+	const char* stats_filename = NULL;
+	const char* frame_log_filename = NULL;
+	const char* perf_filename = NULL;
+	const char* verify_filename = "bench-verify.csv";
+	const char* scenario_filter = NULL;
+	const char* approach_filter = NULL;
+	bool list_approaches = false;
+	// --scene=file and --synthetic= options replace the built-in scenarios. The scenario name of a scene is the filename
+	// without directory and extension.
+	scenario_t* option_scenarios = NULL;
+	size_t option_scenarios_count = 0;
+	animation_opts_t animation_opts = { 0 };
+	bool animate = false;
+	// --sweep-rects= and --sweep-sizes= run all scenarios with each rect count at each render size
+	typedef struct { int width, height; } sweep_size_t;
+	uint32_t* sweep_rects_counts = NULL;
+	size_t sweep_rects_counts_count = 0;
+	sweep_size_t* sweep_sizes = NULL;
+	size_t sweep_sizes_count = 0;
+	const char* sweep_filename = NULL;
+	// --gen-threads= runs the approaches with each thread count for the gen buffers phase
+	uint32_t* gen_threads_counts = NULL;
+	size_t gen_threads_counts_count = 0;
+	const char* programs_filename = NULL;
+	const char* texture_bundle_filename = NULL;
+	const char* write_texture_bundle_filename = NULL;
 	for (int i = 1; i < argc; i++) {
 		if ( strcmp(argv[i], "--gl-debug-log") == 0 )
 			use_gl_debug_log = true;
@@ -4384,33 +9150,254 @@ int main(int argc, char** argv) {
 			write_gl_info = true;
 		else if ( strcmp(argv[i], "--disable-timer-queries") == 0 )
 			reporting_query_timers = false;
+		else if ( strcmp(argv[i], "--tsc-clock") == 0 )
+			reporting_use_tsc = true;
+		else if ( strncmp(argv[i], "--timer-query-latency=", 22) == 0 ) {
+			reporting_query_latency = strtoul(argv[i] + 22, NULL, 10);
+			if (reporting_query_latency < 1 || reporting_query_latency > REPORT_MAX_QUERY_LATENCY) {
+				fprintf(stderr, "Timer query latency has to be between 1 and %d frames: %s\n", REPORT_MAX_QUERY_LATENCY, argv[i]);
+				return 1;
+			}
+		}
 		else if ( strcmp(argv[i], "--disable-per-frame-data") == 0 )
 			reporting_output_per_frame_data = false;
 		else if ( strcmp(argv[i], "--only-one-frame") == 0 )
 			frame_count = 1;
 		else if ( strcmp(argv[i], "--print-scenario-stats") == 0 )
 			print_scenario_stats = true;
+		else if ( strcmp(argv[i], "--backend=sdl") == 0 )
+			display_backend = DISPLAY_SDL;
+		else if ( strcmp(argv[i], "--backend=egl") == 0 )
+			display_backend = DISPLAY_EGL;
+		else if ( strcmp(argv[i], "--offscreen") == 0 )
+			offscreen = true;
+		else if ( strncmp(argv[i], "--offscreen-format=", 19) == 0 ) {
+			offscreen = true;
+			offscreen_format = display_parse_offscreen_format(argv[i] + 19);
+			if (offscreen_format == 0) {
+				fprintf(stderr, "Unknown offscreen format, expected rgba8, srgb8_alpha8, rgba16f or rgb10_a2: %s\n", argv[i]);
+				return 1;
+			}
+		}
+		else if ( strncmp(argv[i], "--texture-threads=", 18) == 0 )
+			texture_decoder_threads = strtoul(argv[i] + 18, NULL, 10);
+		else if ( strncmp(argv[i], "--texture-bundle=", 17) == 0 )
+			texture_bundle_filename = argv[i] + 17;
+		else if ( strncmp(argv[i], "--write-texture-bundle=", 23) == 0 )
+			write_texture_bundle_filename = argv[i] + 23;
+		else if ( strncmp(argv[i], "--program-cache=", 16) == 0 )
+			program_cache_dir = argv[i] + 16;
+		else if ( strncmp(argv[i], "--program-csv=", 14) == 0 )
+			programs_filename = argv[i] + 14;
+		else if ( strcmp(argv[i], "--upload=orphan") == 0 )
+			upload_mode = UPLOAD_ORPHAN;
+		else if ( strcmp(argv[i], "--upload=ring") == 0 )
+			upload_mode = UPLOAD_RING;
+		else if ( strncmp(argv[i], "--msaa=", 7) == 0 ) {
+			offscreen = true;
+			msaa_samples = strtoul(argv[i] + 7, NULL, 10);
+		}
+		else if ( strncmp(argv[i], "--warmup-frames=", 16) == 0 )
+			warmup_frames = strtoul(argv[i] + 16, NULL, 10);
+		else if ( strncmp(argv[i], "--stats-csv=", 12) == 0 )
+			stats_filename = argv[i] + 12;
+		else if ( strncmp(argv[i], "--frame-log=", 12) == 0 )
+			frame_log_filename = argv[i] + 12;
+		else if ( strncmp(argv[i], "--perf-csv=", 11) == 0 )
+			perf_filename = argv[i] + 11;
+		else if ( strncmp(argv[i], "--scenario=", 11) == 0 )
+			scenario_filter = argv[i] + 11;
+		else if ( strncmp(argv[i], "--approach=", 11) == 0 )
+			approach_filter = argv[i] + 11;
+		else if ( strcmp(argv[i], "--list-approaches") == 0 )
+			list_approaches = true;
+		else if ( strncmp(argv[i], "--scene=", 8) == 0 ) {
+			const char* filename = argv[i] + 8;
+			const char* basename = filename;
+			for (const char* c = filename; *c != '\0'; c++) {
+				if (*c == '/' || *c == '\\')
+					basename = c + 1;
+			}
+			char* name = NULL;
+			asprintf(&name, "%.*s", strrchr(basename, '.') ? (int)(strrchr(basename, '.') - basename) : (int)strlen(basename), basename);
+			option_scenarios = realloc(option_scenarios, (option_scenarios_count + 1) * sizeof(option_scenarios[0]));
+			option_scenarios[option_scenarios_count++] = (scenario_t){ .name = name, .scene_filename = filename };
+		}
+		else if ( strncmp(argv[i], "--synthetic=", 12) == 0 ) {
+			char* name = strdup("synthetic");
+			generate_rects_opts_t* opts = calloc(1, sizeof(generate_rects_opts_t));
+			if ( !generate_rects_parse_opts(argv[i] + 12, opts, &name) ) {
+				fprintf(stderr, "Invalid synthetic scenario, expected e.g. --synthetic=name=text,count=100000,glyphs=0.8,sizes=log:8-200: %s\n", argv[i]);
+				return 1;
+			}
+			option_scenarios = realloc(option_scenarios, (option_scenarios_count + 1) * sizeof(option_scenarios[0]));
+			option_scenarios[option_scenarios_count++] = (scenario_t){ .name = name, .synthetic_opts = opts };
+		}
+		else if ( strncmp(argv[i], "--animate=", 10) == 0 ) {
+			animate = true;
+			if ( !animation_parse_opts(argv[i] + 10, &animation_opts) ) {
+				fprintf(stderr, "Invalid animation, expected e.g. --animate=scroll=2,edits=0.5,colors=0.01,locality=0.1: %s\n", argv[i]);
+				return 1;
+			}
+		}
+		else if ( strncmp(argv[i], "--sweep-rects=", 14) == 0 ) {
+			// Geometric range, e.g. 1000-1024000 (doubles each step) or 1000-1000000x10
+			uint32_t min = 0, max = 0;
+			float factor = 2;
+			if ( sscanf(argv[i], "--sweep-rects=%u-%ux%f", &min, &max, &factor) < 2 || min == 0 || max < min || factor <= 1 ) {
+				fprintf(stderr, "Invalid rect count sweep, expected e.g. --sweep-rects=1000-1024000 or --sweep-rects=1000-1000000x10: %s\n", argv[i]);
+				return 1;
+			}
+			sweep_rects_counts_count = 0;
+			for (double count = min; count <= max * 1.001; count *= factor) {
+				sweep_rects_counts = realloc(sweep_rects_counts, (sweep_rects_counts_count + 1) * sizeof(sweep_rects_counts[0]));
+				sweep_rects_counts[sweep_rects_counts_count++] = count + 0.5;
+			}
+		}
+		else if ( strncmp(argv[i], "--sweep-sizes=", 14) == 0 ) {
+			// List of sizes, e.g. 800x500,1600x1000,3200x2000
+			sweep_sizes_count = 0;
+			for (const char* list = argv[i] + 14; *list != '\0'; list += (*list == ',') ? 1 : 0) {
+				sweep_size_t size = { 0, 0 };
+				int length = 0;
+				if ( sscanf(list, "%dx%d%n", &size.width, &size.height, &length) != 2 || size.width <= 0 || size.height <= 0 || (list[length] != ',' && list[length] != '\0') ) {
+					fprintf(stderr, "Invalid render size sweep, expected e.g. --sweep-sizes=800x500,1600x1000,3200x2000: %s\n", argv[i]);
+					return 1;
+				}
+				sweep_sizes = realloc(sweep_sizes, (sweep_sizes_count + 1) * sizeof(sweep_sizes[0]));
+				sweep_sizes[sweep_sizes_count++] = size;
+				list += length;
+			}
+		}
+		else if ( strncmp(argv[i], "--sweep-csv=", 12) == 0 )
+			sweep_filename = argv[i] + 12;
+		else if ( strncmp(argv[i], "--gen-threads=", 14) == 0 ) {
+			// List of thread counts, e.g. 1,2,4,8 (0 is one thread per CPU)
+			gen_threads_counts_count = 0;
+			for (const char* list = argv[i] + 14; *list != '\0'; list += (*list == ',') ? 1 : 0) {
+				uint32_t thread_count = 0;
+				int length = 0;
+				if ( sscanf(list, "%u%n", &thread_count, &length) != 1 || thread_count > JOBS_MAX_THREADS || (list[length] != ',' && list[length] != '\0') ) {
+					fprintf(stderr, "Invalid gen threads, expected e.g. --gen-threads=1,2,4,8 (at most %d): %s\n", JOBS_MAX_THREADS, argv[i]);
+					return 1;
+				}
+				gen_threads_counts = realloc(gen_threads_counts, (gen_threads_counts_count + 1) * sizeof(gen_threads_counts[0]));
+				gen_threads_counts[gen_threads_counts_count++] = thread_count;
+				list += length;
+			}
+		}
+		else if ( strncmp(argv[i], "--verify=", 9) == 0 )
+			verify_reference_approach = argv[i] + 9;
+		else if ( strncmp(argv[i], "--verify-golden=", 16) == 0 )
+			verify_golden_dir = argv[i] + 16;
+		else if ( strncmp(argv[i], "--write-golden=", 15) == 0 )
+			verify_write_golden_dir = argv[i] + 15;
+		else if ( strncmp(argv[i], "--verify-csv=", 13) == 0 )
+			verify_filename = argv[i] + 13;
+		else if ( strncmp(argv[i], "--verify-min-psnr=", 18) == 0 )
+			verify_min_psnr = strtod(argv[i] + 18, NULL);
+		else if ( strncmp(argv[i], "--cpu-raster-threads=", 21) == 0 )
+			cpu_raster_threads = strtoul(argv[i] + 21, NULL, 10);
+		else if ( strncmp(argv[i], "--cpu-raster-simd=", 18) == 0 )
+			cpu_raster_simd = argv[i] + 18;
+		else if ( strncmp(argv[i], "--gen-simd=", 11) == 0 )
+			gen_simd = argv[i] + 11;
+		else if ( strncmp(argv[i], "--render-size=", 14) == 0 ) {
+			if ( sscanf(argv[i], "--render-size=%dx%d", &window_width, &window_height) != 2 || window_width <= 0 || window_height <= 0 ) {
+				fprintf(stderr, "Invalid render size, expected e.g. --render-size=1600x1000: %s\n", argv[i]);
+				return 1;
+			}
+		}
 		else {
 			fprintf(stderr, "Unknown command line option: %s\n", argv[i]);
 			return 1;
 		}
 	}
 	
-	// Open window
-	SDL_Init(SDL_INIT_VIDEO);
-	atexit(SDL_Quit);
+	const scenario_t* scenario_list = (option_scenarios_count > 0) ? option_scenarios : scenarios;
+	size_t scenario_list_count = (option_scenarios_count > 0) ? option_scenarios_count : sizeof(scenarios) / sizeof(scenarios[0]);
+	
+	// Print what would run with the given filters without opening a window
+	if (list_approaches) {
+		for (size_t i = 0; i < scenario_list_count; i++) {
+			if ( !glob_list_match(scenario_filter, scenario_list[i].name) )
+				continue;
+			for (size_t j = 0; j < sizeof(approaches) / sizeof(approaches[0]); j++) {
+				if ( approach_runs_in_scenario(&approaches[j], &scenario_list[i]) && approach_selected(&approaches[j], approach_filter, msaa_samples) )
+					printf("%s %s\n", scenario_list[i].name, approaches[j].name);
+			}
+		}
+		return 0;
+	}
+	
+	if (verify_reference_approach && verify_golden_dir) {
+		fprintf(stderr, "Use either --verify= or --verify-golden=, not both\n");
+		return 1;
+	}
+	if (verify_reference_approach) {
+		bool known = false;
+		for (size_t j = 0; j < sizeof(approaches) / sizeof(approaches[0]); j++)
+			known = known || strcmp(approaches[j].name, verify_reference_approach) == 0;
+		if (!known) {
+			fprintf(stderr, "Unknown reference approach --verify=%s, see --list-approaches\n", verify_reference_approach);
+			return 1;
+		}
+	}
+	bool verify = (verify_reference_approach != NULL || verify_golden_dir != NULL);
 	
-	int window_width = 1600, window_height = 1000;
-	SDL_Window* window = SDL_CreateWindow("Rectangle rendering micro-benchmark", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, window_width, window_height, SDL_WINDOW_OPENGL);
+	// The golden images are per scenario, not per sweep point
+	bool sweep = (sweep_rects_counts_count > 0 || sweep_sizes_count > 0);
+	if (sweep && (verify_golden_dir || verify_write_golden_dir)) {
+		fprintf(stderr, "--verify-golden= and --write-golden= don't work together with sweeps, use --verify= instead\n");
+		return 1;
+	}
+	if ( (sweep || gen_threads_counts_count > 1) && !sweep_filename )
+		sweep_filename = "bench-sweep.csv";
+	// Without sweeps there is just one point: the rects of the scenario at the window size
+	bool sweep_sizes_given = (sweep_sizes_count > 0);
+	if (sweep_rects_counts_count == 0) {
+		sweep_rects_counts = calloc(1, sizeof(sweep_rects_counts[0]));
+		sweep_rects_counts_count = 1;
+	}
+	if (sweep_sizes_count == 0) {
+		sweep_sizes = malloc(sizeof(sweep_sizes[0]));
+		sweep_sizes[0] = (sweep_size_t){ window_width, window_height };
+		sweep_sizes_count = 1;
+	}
+	// By default the gen buffers phase runs on the main thread only, like it always did
+	if (gen_threads_counts_count == 0) {
+		gen_threads_counts = malloc(sizeof(gen_threads_counts[0]));
+		gen_threads_counts[0] = 1;
+		gen_threads_counts_count = 1;
+	}
+	
+	// Start decoding the images of the textures, that runs on worker threads while the display is opened. The big image
+	// comes first since it takes the longest. A new bundle is always written from the image files.
+	const char* glyph_atlas_filename = "26-glyph-atlas.png";
+	const char* image_filename = "images/Clouds Battle by arsenixc.jpg";
+	const char* icons_filename_format = "icons/%02d.png";
+	bool use_texture_bundle = (texture_bundle_filename != NULL && write_texture_bundle_filename == NULL);
+	texture_decoder_t texture_decoder;
+	if (!use_texture_bundle) {
+		char icon_filenames[10][32];
+		const char* image_filenames[12] = { image_filename, glyph_atlas_filename };
+		for (uint32_t i = 0; i < 10; i++) {
+			snprintf(icon_filenames[i], sizeof(icon_filenames[i]), icons_filename_format, i + 1);
+			image_filenames[2 + i] = icon_filenames[i];
+		}
+		if ( !texture_decoder_start(&texture_decoder, 12, image_filenames) )
+			return 1;
+	}
 	
-	// Init OpenGL context (with vsync disabled)
-	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
-	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 5);
-	SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
-	SDL_GLContext gl_ctx = SDL_GL_CreateContext(window);
-	SDL_GL_SetSwapInterval(0);
+	// Open window (or offscreen framebuffer for the EGL backend) and init the OpenGL context. Verification needs the
+	// images of the approaches and render size sweeps can go beyond the screen size, so then we always render into an
+	// offscreen framebuffer.
+	display_t display;
+	offscreen = offscreen || verify || verify_write_golden_dir || sweep_sizes_given;
+	if ( !display_open(&display, display_backend, window_width, window_height, offscreen ? offscreen_format : 0, msaa_samples) )
+		return 1;
+	reporting_capture_buffer = display_presented_buffer(&display);
 	
-	gladLoadGL((GLADloadfunc)SDL_GL_GetProcAddress); // Expects a function that returns a function pointer, but SDL_GL_GetProcAddress() just returns a void pointer. Hence the cast.
 	if (use_gl_debug_log)
 		gl_init_debug_log();
 	
@@ -4436,22 +9423,105 @@ int main(int argc, char** argv) {
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	
-	// Load the test textures
-	GLuint glyph_atlas_texture = load_gl_texture("26-glyph-atlas.png");
-	GLuint image_texture = load_gl_texture("images/Clouds Battle by arsenixc.jpg");
-	GLuint texture_array = load_gl_texture_array(48, 48, 10, "icons/%02d.png", 1, 10);
+	// Load the test textures, either from the image files or a texture bundle. The time includes the upload (glFinish())
+	// so it's the startup time the textures cost on the main thread after the display is open.
+	GLuint glyph_atlas_texture = 0, image_texture = 0, texture_array = 0;
+	nsec_t textures_start = time_now_ns();
+	if (use_texture_bundle) {
+		texture_bundle_t bundle;
+		if ( !texture_bundle_open(&bundle, texture_bundle_filename) )
+			return 1;
+		glyph_atlas_texture = texture_bundle_load(&bundle, glyph_atlas_filename);
+		image_texture = texture_bundle_load(&bundle, image_filename);
+		texture_array = texture_bundle_load(&bundle, icons_filename_format);
+		glFinish();
+		texture_bundle_close(&bundle);
+		if (glyph_atlas_texture == 0 || image_texture == 0 || texture_array == 0)
+			return 1;
+	} else {
+		if ( !texture_decoder_upload(&texture_decoder) )
+			return 1;
+		image_texture = texture_decoder_texture_2d(&texture_decoder, 0, 4);
+		glyph_atlas_texture = texture_decoder_texture_2d(&texture_decoder, 1, 4);
+		texture_array = texture_decoder_texture_array(&texture_decoder, 2, 10);
+		texture_decoder_finish(&texture_decoder);
+		if (texture_array == 0)
+			return 1;
+	}
+	fprintf(stderr, "Textures loaded from %s in %.1lfms\n", use_texture_bundle ? texture_bundle_filename : "the image files",
+		(time_now_ns() - textures_start) / 1000000.0);
+	
+	if (write_texture_bundle_filename) {
+		bool written = texture_bundle_write(write_texture_bundle_filename, 3,
+			(const char*[]){ glyph_atlas_filename, image_filename, icons_filename_format },
+			(GLuint[]){ glyph_atlas_texture, image_texture, texture_array }
+		);
+		display_close(&display);
+		return written ? 0 : 1;
+	}
 	
-	// Setup
+	// Setup (warm-up frames are rendered by the benchmarks like all other frames, only the reporting ignores them)
+	if (stats_filename) {
+		reporting_stats_file = fopen(stats_filename, reporting_output_csv_headers ? "wb" : "ab");
+		if (!reporting_stats_file) {
+			perror("Failed to open stats file");
+			return 1;
+		}
+	}
+	if (frame_log_filename) {
+		reporting_frame_log_file = fopen(frame_log_filename, "wb");
+		if (!reporting_frame_log_file) {
+			perror("Failed to open frame log file");
+			return 1;
+		}
+	}
+	if (perf_filename) {
+		reporting_perf_file = fopen(perf_filename, reporting_output_csv_headers ? "wb" : "ab");
+		if (!reporting_perf_file) {
+			perror("Failed to open perf counter file");
+			return 1;
+		}
+	}
+	if (sweep_filename) {
+		reporting_sweep_file = fopen(sweep_filename, reporting_output_csv_headers ? "wb" : "ab");
+		if (!reporting_sweep_file) {
+			perror("Failed to open sweep file");
+			return 1;
+		}
+	}
+	if (programs_filename) {
+		reporting_programs_file = fopen(programs_filename, reporting_output_csv_headers ? "wb" : "ab");
+		if (!reporting_programs_file) {
+			perror("Failed to open program file");
+			return 1;
+		}
+	}
+	if (verify) {
+		verify_file = fopen(verify_filename, reporting_output_csv_headers ? "wb" : "ab");
+		if (!verify_file) {
+			perror("Failed to open verify file");
+			return 1;
+		}
+		verify_write_header();
+	}
+	reporting_warmup_frames = warmup_frames;
+	if ( reporting_use_tsc && !time_tsc_calibrate(100 * 1000000) ) {
+		fprintf(stderr, "No invariant TSC available, --tsc-clock ignored\n");
+		reporting_use_tsc = false;
+	}
 	scenario_args_t scenario_args = (scenario_args_t){
-		.rects_count = 1000, .rects_ptr = NULL, .frame_count = frame_count,
+		.rects_count = 1000, .rects_ptr = NULL, .frame_count = warmup_frames + frame_count,
 		.glyph_texture = glyph_atlas_texture, .image_texture = image_texture, .texture_array = texture_array,
-		.window = window
+		.display = &display
 	};
 	reporting_setup();
+	jobs_init(&gen_jobs, gen_threads_counts[0]);
 	
 	// Process initial SDL events
-	SDL_Event event;
-	while( SDL_PollEvent(&event) ) {
+	if (display_backend == DISPLAY_SDL) {
+		SDL_Event event;
+		while( SDL_PollEvent(&event) ) {
+		}
 	}
 	
 	
@@ -4460,7 +9530,7 @@ int main(int argc, char** argv) {
 	// Old unused scenarios
 	/*
 	report_scenario("opaque");
-	generate_rects_random(scenario_args.rects_count, &scenario_args.rects_count, &scenario_args.rects_ptr, (generate_rects_opts_t){ });
+	generate_rects_random(&scenario_args.rects_count, &scenario_args.rects_ptr, (generate_rects_opts_t){ .rects_count = scenario_args.rects_count });
 	if (print_scenario_stats) scenario_dump_stats("opaque", &scenario_args);
 	
 	bench_one_rect_per_draw(&scenario_args, false);
@@ -4468,120 +9538,199 @@ int main(int argc, char** argv) {
 	bench_simple_vertex_buffer_for_all_rects(&scenario_args, false);
 	bench_simple_vertex_buffer_for_all_rects(&scenario_args, true);
 	bench_complete_vertex_buffer_for_all_rects(&scenario_args);
-	bench_one_ssbo(&scenario_args);
-	bench_ssbo_instruction_list(&scenario_args);
-	bench_ssbo_inlined_instr_6(&scenario_args);
+	bench_one_ssbo(&scenario_args, true, false);
+	bench_ssbo_instruction_list(&scenario_args, false);
+	bench_ssbo_inlined_instr_6(&scenario_args, false);
 	bench_ssbo_fixed_vertex_to_fragment_buffer(&scenario_args, 6);
 	
 	report_scenario("transparent");
-	generate_rects_random(scenario_args.rects_count, &scenario_args.rects_count, &scenario_args.rects_ptr, (generate_rects_opts_t){ .transparent_bg_color = true });
+	generate_rects_random(&scenario_args.rects_count, &scenario_args.rects_ptr, (generate_rects_opts_t){ .rects_count = scenario_args.rects_count, .transparent_bg_color = true });
 	if (print_scenario_stats) scenario_dump_stats("transparent", &scenario_args);
 	
 	bench_one_rect_per_draw(&scenario_args, false);
 	bench_simple_vertex_buffer_for_all_rects(&scenario_args, false);
 	bench_simple_vertex_buffer_for_all_rects(&scenario_args, true);
 	bench_complete_vertex_buffer_for_all_rects(&scenario_args);
-	bench_one_ssbo(&scenario_args);
-	bench_ssbo_instruction_list(&scenario_args);
-	bench_ssbo_inlined_instr_6(&scenario_args);
+	bench_one_ssbo(&scenario_args, true, false);
+	bench_ssbo_instruction_list(&scenario_args, false);
+	bench_ssbo_inlined_instr_6(&scenario_args, false);
 	bench_ssbo_fixed_vertex_to_fragment_buffer(&scenario_args, 6);
 	*/
 	
-	#define RUN_ALL_BENCHS
-	
-	report_scenario("sublime");
-	generate_rects_sublime_sample(&scenario_args.rects_count, &scenario_args.rects_ptr);
-	if (print_scenario_stats) scenario_dump_stats("sublime", &scenario_args);
-	
-	bench_one_rect_per_draw(&scenario_args, false);
-	bench_simple_vertex_buffer_for_all_rects(&scenario_args, false);
-	bench_simple_vertex_buffer_for_all_rects(&scenario_args, true);
-	bench_complete_vertex_buffer_for_all_rects(&scenario_args);
-	bench_one_ssbo(&scenario_args);
-	bench_ssbo_instruction_list(&scenario_args);
-	bench_ssbo_inlined_instr_6(&scenario_args);
-	#ifdef RUN_ALL_BENCHS
-	bench_ssbo_inlined_instr(&scenario_args,  4,  4);
-	bench_ssbo_inlined_instr(&scenario_args,  6,  6);
-	bench_ssbo_inlined_instr(&scenario_args,  8,  8);
-	bench_ssbo_inlined_instr(&scenario_args, 10, 10);
-	bench_ssbo_inlined_instr(&scenario_args, 20, 20);
-	bench_ssbo_inlined_instr(&scenario_args,  4,  6);
-	bench_ssbo_inlined_instr(&scenario_args,  4,  8);
-	bench_ssbo_inlined_instr(&scenario_args,  4, 10);
-	bench_ssbo_inlined_instr(&scenario_args,  4, 20);
-	bench_ssbo_inlined_instr(&scenario_args,  6,  4);
-	bench_ssbo_inlined_instr(&scenario_args,  8,  4);
-	bench_ssbo_inlined_instr(&scenario_args, 10,  4);
-	bench_ssbo_inlined_instr(&scenario_args, 20,  4);
-	bench_ssbo_fixed_vertex_to_fragment_buffer(&scenario_args, 4);
-	#endif
-	bench_ssbo_fixed_vertex_to_fragment_buffer(&scenario_args, 6);
-	#ifdef RUN_ALL_BENCHS
-	bench_ssbo_fixed_vertex_to_fragment_buffer(&scenario_args, 8);
-	bench_ssbo_fixed_vertex_to_fragment_buffer(&scenario_args, 10);
-	bench_ssbo_fixed_vertex_to_fragment_buffer(&scenario_args, 20);
-	#endif
-	bench_one_ssbo_ext_no_sdf(&scenario_args);
-	bench_one_ssbo_ext_sdf_list(&scenario_args);
-	bench_one_ssbo_ext_one_sdf(&scenario_args, false);
-	bench_one_ssbo_ext_one_sdf_pack(&scenario_args);
-	bench_instancing_and_divisor(&scenario_args);
-	
-	report_scenario("mediaplayer");
-	generate_rects_mediaplayer_sample(&scenario_args.rects_count, &scenario_args.rects_ptr);
-	if (print_scenario_stats) scenario_dump_stats("mediaplayer", &scenario_args);
-	
-	bench_one_rect_per_draw(&scenario_args, false);
-	bench_simple_vertex_buffer_for_all_rects(&scenario_args, false);
-	bench_simple_vertex_buffer_for_all_rects(&scenario_args, true);
-	bench_complete_vertex_buffer_for_all_rects(&scenario_args);
-	bench_one_ssbo(&scenario_args);
-	bench_ssbo_instruction_list(&scenario_args);
-	bench_ssbo_inlined_instr_6(&scenario_args);
-	#ifdef RUN_ALL_BENCHS
-	bench_ssbo_inlined_instr(&scenario_args,  4,  4);
-	bench_ssbo_inlined_instr(&scenario_args,  6,  6);
-	bench_ssbo_inlined_instr(&scenario_args,  8,  8);
-	bench_ssbo_inlined_instr(&scenario_args, 10, 10);
-	bench_ssbo_inlined_instr(&scenario_args, 20, 20);
-	bench_ssbo_inlined_instr(&scenario_args,  4,  6);
-	bench_ssbo_inlined_instr(&scenario_args,  4,  8);
-	bench_ssbo_inlined_instr(&scenario_args,  4, 10);
-	bench_ssbo_inlined_instr(&scenario_args,  4, 20);
-	bench_ssbo_inlined_instr(&scenario_args,  6,  4);
-	bench_ssbo_inlined_instr(&scenario_args,  8,  4);
-	bench_ssbo_inlined_instr(&scenario_args, 10,  4);
-	bench_ssbo_inlined_instr(&scenario_args, 20,  4);
-	bench_ssbo_fixed_vertex_to_fragment_buffer(&scenario_args, 4);
-	#endif
-	bench_ssbo_fixed_vertex_to_fragment_buffer(&scenario_args, 6);
-	#ifdef RUN_ALL_BENCHS
-	bench_ssbo_fixed_vertex_to_fragment_buffer(&scenario_args, 8);
-	bench_ssbo_fixed_vertex_to_fragment_buffer(&scenario_args, 10);
-	bench_ssbo_fixed_vertex_to_fragment_buffer(&scenario_args, 20);
-	#endif
-	bench_one_ssbo_ext_no_sdf(&scenario_args);
-	bench_one_ssbo_ext_sdf_list(&scenario_args);
-	bench_one_ssbo_ext_one_sdf(&scenario_args, false);
-	bench_one_ssbo_ext_one_sdf_pack(&scenario_args);
-	bench_instancing_and_divisor(&scenario_args);
+	uint32_t approaches_run = 0;
+	rect_t* generated_rects = NULL;
+	rect_t* replicated_rects = NULL;
+	for (size_t i = 0; i < scenario_list_count; i++) {
+		const scenario_t* scenario = &scenario_list[i];
+		if ( !glob_list_match(scenario_filter, scenario->name) )
+			continue;
+		
+		// Scene files are used right from the mapping, generated rects go into a buffer that is reused for every
+		// scenario. Synthetic scenarios are generated for each sweep point below.
+		scene_t scene = { 0 };
+		if (scenario->scene_filename) {
+			if ( !scene_open(&scene, scenario->scene_filename) )
+				continue;
+			if ( scene.recorded_width && (scene.recorded_width != (uint32_t)window_width || scene.recorded_height != (uint32_t)window_height) )
+				fprintf(stderr, "Scene %s was recorded at %ux%u, use --render-size=%ux%u to get the same image\n", scenario->scene_filename,
+					scene.recorded_width, scene.recorded_height, scene.recorded_width, scene.recorded_height);
+			scenario_args.rects_count = scene.rects_count;
+			scenario_args.rects_ptr = scene.rects;
+		} else if (scenario->generate_rects) {
+			scenario->generate_rects(&scenario_args.rects_count, &generated_rects);
+			scenario_args.rects_ptr = generated_rects;
+		}
+		rect_t* scenario_rects = scenario_args.rects_ptr;
+		uint32_t scenario_rects_count = scenario_args.rects_count;
+		bool has_rects = (scenario->generate_rects || scenario->scene_filename || scenario->synthetic_opts);
+		
+		report_scenario(scenario->name);
+		
+		// Every render size of --sweep-sizes= with every rect count of --sweep-rects=. Without sweeps that's just the
+		// window size and the rects of the scenario.
+		for (size_t point = 0; point < sweep_sizes_count * sweep_rects_counts_count; point++) {
+			int width = sweep_sizes[point / sweep_rects_counts_count].width, height = sweep_sizes[point / sweep_rects_counts_count].height;
+			uint32_t sweep_rects_count = sweep_rects_counts[point % sweep_rects_counts_count];
+			if ( (width != display.width || height != display.height) && !display_resize(&display, width, height) )
+				break;
+			
+			// Start from the rects of the scenario, the previous point might have left the animated copy in the args
+			scenario_args.rects_ptr = scenario_rects;
+			scenario_args.rects_count = scenario_rects_count;
+			if (scenario->synthetic_opts) {
+				generate_rects_opts_t opts = *scenario->synthetic_opts;
+				if (opts.area_width == 0 || opts.area_height == 0) {
+					opts.area_width = width;
+					opts.area_height = height;
+				}
+				if (sweep_rects_count)
+					opts.rects_count = sweep_rects_count;
+				generate_rects_random(&scenario_args.rects_count, &generated_rects, opts);
+				scenario_args.rects_ptr = generated_rects;
+			} else if (has_rects && sweep_rects_count) {
+				generate_rects_replicated(sweep_rects_count, &replicated_rects, scenario_rects, scenario_rects_count, width, height);
+				scenario_args.rects_count = sweep_rects_count;
+				scenario_args.rects_ptr = replicated_rects;
+			}
+			
+			report_sweep_point(has_rects ? scenario_args.rects_count : 0, width, height, gen_jobs.thread_count);
+			if (print_scenario_stats && has_rects)
+				scenario_dump_stats(scenario->name, &scenario_args);
+			
+			// With --animate= each approach gets a fresh copy of the rects that changes from frame to frame
+			animation_t animation = { 0 };
+			if (animate && has_rects) {
+				animation_init(&animation, &animation_opts, scenario_args.rects_ptr, scenario_args.rects_count);
+				scenario_args.animation = &animation;
+			}
+			
+			// Get the reference image first: the golden image or the image of the reference approach (even if the
+			// --approach= filter doesn't include it)
+			uint8_t* reference_image = NULL;
+			char* reference_name = NULL;
+			if (verify_golden_dir) {
+				asprintf(&reference_name, "%s/%s.ppm", verify_golden_dir, scenario->name);
+				reference_image = verify_load_ppm(reference_name, width, height);
+			} else if (verify_reference_approach) {
+				reference_name = strdup(verify_reference_approach);
+				for (size_t j = 0; j < sizeof(approaches) / sizeof(approaches[0]); j++) {
+					const approach_t* approach = &approaches[j];
+					if ( strcmp(approach->name, verify_reference_approach) == 0 && approach_runs_in_scenario(approach, scenario) ) {
+						if (scenario_args.animation)
+							animation_reset(scenario_args.animation, &scenario_args);
+						approach->bench(&scenario_args, approach->param1, approach->param2);
+						reference_image = verify_read_framebuffer(&display, width, height);
+						// It's skipped below, so count it here when the --approach= filter includes it
+						if ( approach_selected(approach, approach_filter, msaa_samples) )
+							approaches_run++;
+					}
+				}
+			}
+			if (verify && !reference_image)
+				fprintf(stderr, "Verify: no reference image for scenario %s, its approaches aren't verified\n", scenario->name);
+			bool golden_written = false;
+			
+			// Each approach with each --gen-threads= count
+			for (size_t t = 0; t < gen_threads_counts_count; t++) {
+				jobs_set_thread_count(&gen_jobs, gen_threads_counts[t]);
+				report_sweep_point(has_rects ? scenario_args.rects_count : 0, width, height, gen_jobs.thread_count);
+				
+				for (size_t j = 0; j < sizeof(approaches) / sizeof(approaches[0]); j++) {
+					const approach_t* approach = &approaches[j];
+					if ( !approach_runs_in_scenario(approach, scenario) || !approach_selected(approach, approach_filter, msaa_samples) )
+						continue;
+					if ( verify_reference_approach && strcmp(approach->name, verify_reference_approach) == 0 )
+						continue;
+					
+					if (scenario_args.animation)
+						animation_reset(scenario_args.animation, &scenario_args);
+					approach->bench(&scenario_args, approach->param1, approach->param2);
+					approaches_run++;
+					
+					if (reference_image || (verify_write_golden_dir && !golden_written)) {
+						uint8_t* image = verify_read_framebuffer(&display, width, height);
+						if (reference_image)
+							verify_write_result(scenario->name, approach->name, reference_name, verify_compare(image, reference_image, width, height), width, height);
+						if (verify_write_golden_dir && !golden_written) {
+							char* golden_filename = NULL;
+							asprintf(&golden_filename, "%s/%s.ppm", verify_write_golden_dir, scenario->name);
+							golden_written = verify_write_ppm(golden_filename, image, width, height);
+							free(golden_filename);
+						}
+						free(image);
+					}
+				}
+			}
+			
+			free(reference_image);
+			free(reference_name);
+			if (scenario_args.animation) {
+				animation_destroy(&animation);
+				scenario_args.animation = NULL;
+			}
+		}
+		
+		scene_close(&scene);
+	}
 	
-	report_scenario("demo");
-	bench_one_ssbo_ext_one_sdf(&scenario_args, true);
+	if (approaches_run == 0)
+		fprintf(stderr, "No approach matched --scenario=%s --approach=%s, see --list-approaches\n", scenario_filter ? scenario_filter : "*", approach_filter ? approach_filter : "*");
 	
 	
 	// Cleanup
-	free(scenario_args.rects_ptr);
+	free(generated_rects);
+	free(replicated_rects);
+	free(sweep_rects_counts);
+	free(sweep_sizes);
+	free(gen_threads_counts);
+	for (size_t i = 0; i < option_scenarios_count; i++) {
+		free((char*)option_scenarios[i].name);
+		free(option_scenarios[i].synthetic_opts);
+	}
+	free(option_scenarios);
 	
+	jobs_destroy(&gen_jobs);
 	reporting_cleanup();
+	if (reporting_stats_file)
+		fclose(reporting_stats_file);
+	if (reporting_frame_log_file)
+		fclose(reporting_frame_log_file);
+	if (reporting_perf_file)
+		fclose(reporting_perf_file);
+	if (reporting_sweep_file)
+		fclose(reporting_sweep_file);
+	if (reporting_programs_file)
+		fclose(reporting_programs_file);
+	if (verify_file)
+		fclose(verify_file);
 	
 	glDeleteTextures(1, &texture_array);
 	glDeleteTextures(1, &image_texture);
 	glDeleteTextures(1, &glyph_atlas_texture);
 	
-	SDL_GL_DeleteContext(gl_ctx);
-	SDL_DestroyWindow(window);
+	display_close(&display);
 	
-	return 0;
+	if (approaches_run == 0)
+		return 1;
+	return (verify_mismatches > 0) ? 2 : 0;
 }
\ No newline at end of file
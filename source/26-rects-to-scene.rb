@@ -0,0 +1,67 @@
+#!/usr/bin/ruby
+# Converts rect dumps like 26-rects.c (one "(rect_t){ .pos = ..., .has_glyph = 1 }," initializer per line) into a scene
+# file for `26-bench-rect-drawing --scene=file`. The file layout is described above scene_file_header_t in
+# 26-bench-rect-drawing.c.
+#
+# 26-rects.c contains several scenarios in "#if SCENARIO == n" blocks, --scenario=n picks the rects of one of them
+# (1 is sublime, 2 is mediaplayer). Without it all rects in the file are used. --recorded-size=WxH stores the window
+# size the rects were dumped at.
+#
+# Usage: ruby 26-rects-to-scene.rb [--scenario=1] [--recorded-size=1600x1000] 26-rects.c sublime.scene
+
+SCENE_VERSION = 1
+HEADER_SIZE = 64
+RECT_SIZE = 88
+
+scenario, recorded_width, recorded_height = nil, 0, 0
+files = []
+ARGV.each do |arg|
+	case arg
+	when /\A--scenario=(\d+)\z/              then scenario = $1.to_i
+	when /\A--recorded-size=(\d+)x(\d+)\z/   then recorded_width, recorded_height = $1.to_i, $2.to_i
+	when /\A--/                              then abort "unknown option: #{arg}"
+	else files << arg
+	end
+end
+abort "usage: #{$0} [--scenario=n] [--recorded-size=WxH] rects-dump.c output.scene" unless files.size == 2
+input, output = files
+
+# Values of the fields in one initializer line. Compound literals like (rectl_t){ 63, 6, 79, 17 } become arrays.
+def parse_rect(line)
+	fields = {}
+	line.scan(/\.(\w+)\s*=\s*(\([a-z_]+\)\{([^}]*)\}|[-\d.]+)/) do |name, value, compound|
+		fields[name.to_sym] = compound ? compound.split(",").map(&:strip) : value
+	end
+	fields
+end
+
+rects = []
+current_scenario = nil
+File.foreach(input) do |line|
+	case line
+	when /\A\s*#if\s+SCENARIO\s*==\s*(\d+)/ then current_scenario = $1.to_i
+	when /\A\s*#endif/                      then current_scenario = nil
+	when /\(rect_t\)\{/
+		next if scenario and current_scenario != scenario
+		rects << parse_rect(line)
+	end
+end
+abort "#{input}: no rects found" if rects.empty?
+
+File.open(output, "wb") do |file|
+	file.write ["26SC", SCENE_VERSION, HEADER_SIZE, RECT_SIZE, rects.size, recorded_width, recorded_height].pack("a4L<L<L<L<L<L<x36")
+	rects.each do |rect|
+		pos = rect.fetch(:pos).map(&:to_i)
+		flags = [:has_border, :has_rounded_corners, :has_texture, :has_texture_array, :has_glyph].map{|name| rect[name].to_i != 0 ? 1 : 0}
+		record = [
+			*pos, *rect.fetch(:background_color).map(&:to_i), *flags,
+			rect[:border_width].to_f, *(rect[:border_color] || [0, 0, 0, 0]).map(&:to_i),
+			rect[:corner_radius].to_i, rect[:texture_index].to_i, rect[:texture_array_index].to_i,
+			*(rect[:texture_coords] || [0, 0, 0, 0]).map(&:to_f), rect[:random].to_i
+		].pack("q<4C4C5x3eC4L<L<L<e4L<x4")
+		abort "internal error: rect record is #{record.bytesize} bytes" unless record.bytesize == RECT_SIZE
+		file.write record
+	end
+end
+
+puts "#{output}: #{rects.size} rects"
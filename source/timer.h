@@ -3,6 +3,10 @@
  * 
  * VERSION HISTORY
  * 
+ * 2026-10-17 Added nsec_t based time_now_ns() (CLOCK_MONOTONIC_RAW, QueryPerformanceCounter() on Windows) and
+ *            time_process_cpu_time_ns(). gettimeofday() only has microseconds and jumps when NTP adjusts the clock.
+ *            Added time_tsc_calibrate() and time_tsc_now_ns() to read the clock via RDTSC on x86 CPUs with an
+ *            invariant TSC.
  * 2023-06-20 Removed unused commented out code (timeval_t definition and timeval_t based functions).
  *            Removed usec_p definition (only used by time_mark_ms()), usec_t* is enough.
  *            Added time_between_ms() function.
@@ -18,12 +22,18 @@
 #include <stdint.h>
 #include <time.h>
 #include <sys/time.h>
+#include <stdbool.h>
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 #endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#include <cpuid.h>
+#endif
 
 typedef int64_t usec_t;
+typedef int64_t nsec_t;
 
 
 static inline usec_t timeval_to_usec(struct timeval time) {
@@ -59,6 +69,78 @@ static inline double time_between_ms(usec_t a, usec_t b) {
 }
 
 
+// 
+// Monotonic clock with nanosecond resolution (the actual resolution depends on the system)
+// 
+
+#ifdef _WIN32
+
+static inline nsec_t time_now_ns() {
+	LARGE_INTEGER frequency, counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	// Split into seconds and remainder, otherwise counter * 1e9 overflows after a few days of uptime
+	return (counter.QuadPart / frequency.QuadPart) * 1000000000LL + (counter.QuadPart % frequency.QuadPart) * 1000000000LL / frequency.QuadPart;
+}
+
+#else
+
+/**
+ * CLOCK_MONOTONIC_RAW isn't slewed by NTP, so short intervals aren't stretched or shrunk while NTP adjusts the clock.
+ */
+static inline nsec_t time_now_ns() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+	return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+#endif
+
+
+// 
+// Reading the clock via RDTSC is cheaper than a clock_gettime() call (a few ns instead of ~20ns). Only used when
+// time_tsc_calibrate() was successful, e.g. for sub 100ns measurements. The TSC ticks are converted to ns with a
+// factor measured against time_now_ns().
+// 
+
+static nsec_t time_tsc_base_ns;
+static uint64_t time_tsc_base_ticks;
+static double time_tsc_ns_per_tick;
+
+/**
+ * Measures the TSC frequency by busy waiting for calibration_duration_ns. Returns false if the CPU has no TSC that
+ * ticks at a constant rate independent of the CPU clock (invariant TSC) or if this isn't an x86 CPU.
+ */
+static inline bool time_tsc_calibrate(nsec_t calibration_duration_ns) {
+#if defined(__x86_64__) || defined(__i386__)
+	unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+	if ( !__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1 << 8)) )
+		return false;
+	
+	nsec_t start_ns = time_now_ns(), end_ns = start_ns;
+	uint64_t start_ticks = __rdtsc();
+	while (end_ns - start_ns < calibration_duration_ns)
+		end_ns = time_now_ns();
+	uint64_t end_ticks = __rdtsc();
+	
+	time_tsc_ns_per_tick = (double)(end_ns - start_ns) / (end_ticks - start_ticks);
+	time_tsc_base_ns = end_ns;
+	time_tsc_base_ticks = end_ticks;
+	return true;
+#else
+	return false;
+#endif
+}
+
+static inline nsec_t time_tsc_now_ns() {
+#if defined(__x86_64__) || defined(__i386__)
+	return time_tsc_base_ns + (nsec_t)((int64_t)(__rdtsc() - time_tsc_base_ticks) * time_tsc_ns_per_tick);
+#else
+	return time_now_ns();
+#endif
+}
+
+
 // 
 // Functions to query used CPU time on Linux and Windows (sum of kernel and user time)
 // Based on Mysticial answer on https://stackoverflow.com/questions/17432502/how-can-i-measure-cpu-time-and-wall-clock-time-on-both-linux-windows#answer-17440673
@@ -74,6 +156,13 @@ usec_t time_process_cpu_time() {
 	return cpu_time_in_100ns_units / 10;
 }
 
+nsec_t time_process_cpu_time_ns() {
+	FILETIME creation_time, exit_time, kernel_time, user_time;
+	GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time, &kernel_time, &user_time);
+	uint64_t cpu_time_in_100ns_units = (kernel_time.dwLowDateTime | (uint64_t)kernel_time.dwHighDateTime << 32) + (user_time.dwLowDateTime | (uint64_t)user_time.dwHighDateTime << 32);
+	return cpu_time_in_100ns_units * 100;
+}
+
 #else
 
 // Linux version
@@ -101,4 +190,10 @@ usec_t time_process_cpu_time() {
 	return process_cpu_time.tv_sec * 1000000ul + process_cpu_time.tv_nsec / 1000ul;
 }
 
+nsec_t time_process_cpu_time_ns() {
+	struct timespec process_cpu_time;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &process_cpu_time);
+	return process_cpu_time.tv_sec * 1000000000LL + process_cpu_time.tv_nsec;
+}
+
 #endif
\ No newline at end of file